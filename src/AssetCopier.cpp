@@ -0,0 +1,371 @@
+#include "pch.h"
+#include "AssetCopier.h"
+
+#include <charconv>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <process.h>
+#else //_WIN32
+#include <unistd.h>
+#endif //_WIN32
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif //__linux__
+
+using namespace zax;
+
+namespace
+{
+
+#ifdef __linux__
+
+//-----------------------------------------------------------------------------
+struct FileDescriptor
+{
+  int fd_{ -1 };
+
+  FileDescriptor(int fd) noexcept : fd_{ fd } {}
+  FileDescriptor(const FileDescriptor&) noexcept = delete;
+  ~FileDescriptor() noexcept { if (fd_ >= 0) ::close(fd_); }
+
+  FileDescriptor& operator=(const FileDescriptor&) noexcept = delete;
+};
+
+//-----------------------------------------------------------------------------
+bool copyFileInKernel(const Path& source, const Path& destination, std::uintmax_t size) noexcept
+{
+  FileDescriptor in{ ::open(source.c_str(), O_RDONLY | O_CLOEXEC) };
+  if (in.fd_ < 0)
+    return false;
+
+  struct stat info {};
+  if (0 != ::fstat(in.fd_, &info))
+    return false;
+
+  FileDescriptor out{ ::open(destination.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, info.st_mode & 0777) };
+  if (out.fd_ < 0)
+    return false;
+
+  // share the source blocks outright on filesystems with reflinks
+#ifdef FICLONE
+  if (0 == ::ioctl(out.fd_, FICLONE, in.fd_))
+    return true;
+#endif //FICLONE
+
+  std::uintmax_t remaining{ size };
+  while (remaining > 0) {
+    auto copied{ ::copy_file_range(in.fd_, nullptr, out.fd_, nullptr, static_cast<size_t>(std::min<std::uintmax_t>(remaining, 1 << 30)), 0) };
+    if (copied < 0)
+      copied = ::sendfile(out.fd_, in.fd_, nullptr, static_cast<size_t>(std::min<std::uintmax_t>(remaining, 1 << 30)));
+    if (copied <= 0)
+      return false;
+    remaining -= static_cast<std::uintmax_t>(copied);
+  }
+  return true;
+}
+
+#endif //__linux__
+
+//-----------------------------------------------------------------------------
+void copyFile(const Path& source, const Path& destination, std::uintmax_t size, std::error_code& ec) noexcept
+{
+#ifdef __linux__
+  if (copyFileInKernel(source, destination, size))
+    return;
+#else //__linux__
+  (void)size;
+#endif //__linux__
+
+  // the standard library already uses the platform's native copy elsewhere
+  std::filesystem::copy_file(source, destination, std::filesystem::copy_options::overwrite_existing, ec);
+}
+
+//-----------------------------------------------------------------------------
+Path temporaryPath(const Path& path) noexcept
+{
+  // unique across the threads of this process and every other process
+  // sharing the same store
+#ifdef _WIN32
+  auto pid{ ::_getpid() };
+#else //_WIN32
+  auto pid{ ::getpid() };
+#endif //_WIN32
+  auto result{ path };
+  result += ".tmp" + std::to_string(pid) + "-" + std::to_string(puid());
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+template <typename TValue>
+bool parseNumber(StringView value, TValue& outValue) noexcept
+{
+  auto [ptr, ec] { std::from_chars(value.data(), value.data() + value.size(), outValue) };
+  return (std::errc{} == ec) && (ptr == value.data() + value.size());
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+void AssetCopier::Statistics::add(const Statistics& other) noexcept
+{
+  copiedFiles_ += other.copiedFiles_;
+  skippedFiles_ += other.skippedFiles_;
+  linkedFiles_ += other.linkedFiles_;
+  copiedBytes_ += other.copiedBytes_;
+  skippedBytes_ += other.skippedBytes_;
+}
+
+//-----------------------------------------------------------------------------
+void AssetCopier::loadManifest(const Path& manifestPath) noexcept
+{
+  if ((manifestLoaded_) && (manifestPath == manifestPath_))
+    return;
+
+  manifestPath_ = manifestPath;
+  manifestLoaded_ = true;
+  manifestChanged_ = false;
+  manifest_.clear();
+
+  auto [contents, length] { readBinaryFile(manifestPath_.string()) };
+  if (!contents)
+    return;
+
+  // one asset per line: digest, size, modified, source and destination
+  StringView remaining{ reinterpret_cast<const char*>(contents.get()), length };
+  while (!remaining.empty()) {
+    auto endOfLine{ remaining.find('\n') };
+    auto line{ remaining.substr(0, endOfLine) };
+    remaining = (StringView::npos == endOfLine) ? StringView{} : remaining.substr(endOfLine + 1);
+
+    std::array<StringView, 5> fields;
+    size_t count{};
+    for (; (count < fields.size()) && (!line.empty()); ++count) {
+      auto tab{ (count + 1 < fields.size()) ? line.find('\t') : StringView::npos };
+      fields[count] = line.substr(0, tab);
+      line = (StringView::npos == tab) ? StringView{} : line.substr(tab + 1);
+    }
+    if (count != fields.size())
+      continue;
+
+    ManifestEntry entry;
+    if (auto digest{ Sha256::fromHex(fields[0]) }; digest)
+      entry.digest_ = *digest;
+    else
+      continue;
+    if (!parseNumber(fields[1], entry.size_))
+      continue;
+    if (!parseNumber(fields[2], entry.modified_))
+      continue;
+    entry.source_ = fields[3];
+    manifest_[String{ fields[4] }] = std::move(entry);
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool AssetCopier::saveManifest() noexcept
+{
+  if ((!manifestLoaded_) || (!manifestChanged_))
+    return true;
+
+  std::stringstream ss;
+  for (auto& [destination, entry] : manifest_)
+    ss << Sha256::toHex(entry.digest_) << '\t' << entry.size_ << '\t' << entry.modified_ << '\t' << entry.source_ << '\t' << destination << '\n';
+
+  if (!writeBinaryFile(manifestPath_.string(), ss.str()))
+    return false;
+  manifestChanged_ = false;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void AssetCopier::run(JobList& jobs, int workers) noexcept
+{
+  // the manifest is only read while copying so the workers share it freely
+  auto copyJob{ [&](Job& job) noexcept {
+    auto found{ manifest_.find(job.destination_.string()) };
+    copy(job, manifest_.end() == found ? nullptr : &(found->second));
+  } };
+
+  auto totalThreads{ std::min(static_cast<size_t>(std::max(workers, 1)), jobs.size()) };
+  if (totalThreads > 1) {
+    std::atomic<size_t> next{};
+    std::vector<std::thread> threads;
+    try {
+      for (size_t loop{}; loop < totalThreads; ++loop) {
+        threads.emplace_back([&]() noexcept {
+          for (auto index{ next++ }; index < jobs.size(); index = next++)
+            copyJob(jobs[index]);
+        });
+      }
+    }
+    catch (const std::system_error&) {
+      // whatever is not picked up by a thread is copied below
+    }
+    for (auto& thread : threads)
+      thread.join();
+    for (auto index{ next++ }; index < jobs.size(); index = next++)
+      copyJob(jobs[index]);
+  }
+  else {
+    for (auto& job : jobs)
+      copyJob(job);
+  }
+
+  for (auto& job : jobs)
+    record(job);
+}
+
+//-----------------------------------------------------------------------------
+void AssetCopier::copy(Job& job, const ManifestEntry* previous) const noexcept
+{
+  auto size{ std::filesystem::file_size(job.source_, job.ec_) };
+  if (job.ec_)
+    return;
+  auto modified{ std::filesystem::last_write_time(job.source_, job.ec_).time_since_epoch().count() };
+  if (job.ec_)
+    return;
+
+  job.bytes_ = size;
+
+  ManifestEntry entry{ .source_ = job.source_.string(), .size_ = size, .modified_ = static_cast<std::int64_t>(modified) };
+
+  std::error_code ec;
+  auto destinationSize{ std::filesystem::file_size(job.destination_, ec) };
+  bool destinationIntact{ (!ec) && (destinationSize == size) };
+
+  if ((destinationIntact) && (previous) && (previous->source_ == entry.source_) && (previous->size_ == size)) {
+    if (previous->modified_ == entry.modified_) {
+      job.entry_ = *previous;
+      return;
+    }
+
+    // touched but possibly unchanged
+    auto digest{ Sha256::hashFile(job.source_) };
+    if ((digest) && (*digest == previous->digest_)) {
+      entry.digest_ = *digest;
+      job.entry_ = entry;
+      return;
+    }
+  }
+
+  auto digest{ Sha256::hashFile(job.source_) };
+  if (!digest) {
+    job.ec_ = std::make_error_code(std::errc::io_error);
+    return;
+  }
+  entry.digest_ = *digest;
+
+  if ((destinationIntact) && (!previous)) {
+    // an output left behind without a manifest is kept when it is identical
+    auto destinationDigest{ Sha256::hashFile(job.destination_) };
+    if ((destinationDigest) && (*destinationDigest == *digest)) {
+      job.entry_ = entry;
+      return;
+    }
+  }
+
+  if (!storePath_.empty()) {
+    materialize(job, entry);
+    if (!job.ec_)
+      job.entry_ = entry;
+    return;
+  }
+
+  // never write through an output that may be linked into the store
+  std::filesystem::remove(job.destination_, ec);
+
+  copyFile(job.source_, job.destination_, size, job.ec_);
+  if (job.ec_)
+    return;
+
+  job.copied_ = true;
+  job.entry_ = entry;
+}
+
+//-----------------------------------------------------------------------------
+void AssetCopier::materialize(Job& job, const ManifestEntry& entry) const noexcept
+{
+  std::stringstream ss;
+  ss << Sha256::toHex(entry.digest_) << '-' << entry.size_;
+  auto object{ storePath_ / ss.str() };
+
+  // an object is only trusted when its bytes still carry the name's digest
+  std::error_code ec;
+  auto objectSize{ std::filesystem::file_size(object, ec) };
+  bool reuse{ (!ec) && (objectSize == entry.size_) };
+  if (reuse) {
+    auto objectDigest{ Sha256::hashFile(object) };
+    reuse = (objectDigest) && (*objectDigest == entry.digest_);
+  }
+
+  if (!reuse) {
+    // jobs sharing content race to publish the same object so each writes
+    // its own temporary and renames it into place
+    auto temporary{ temporaryPath(object) };
+
+    copyFile(job.source_, temporary, entry.size_, job.ec_);
+    if (job.ec_) {
+      std::filesystem::remove(temporary, ec);
+      return;
+    }
+
+    std::filesystem::rename(temporary, object, job.ec_);
+    if (job.ec_) {
+      std::filesystem::remove(temporary, ec);
+      if (!std::filesystem::is_regular_file(object, ec))
+        return;
+      job.ec_ = {};
+    }
+    job.copied_ = true;
+  }
+
+  std::filesystem::remove(job.destination_, ec);
+  std::filesystem::create_hard_link(object, job.destination_, ec);
+  if (!ec) {
+    job.linked_ = true;
+    return;
+  }
+
+  // no hard links across devices, a reflink (or plain copy) still works
+  copyFile(object, job.destination_, entry.size_, job.ec_);
+  if (!job.ec_)
+    job.copied_ = true;
+}
+
+//-----------------------------------------------------------------------------
+void AssetCopier::record(const Job& job) noexcept
+{
+  if (job.ec_)
+    return;
+
+  if (job.copied_) {
+    ++statistics_.copiedFiles_;
+    statistics_.copiedBytes_ += job.bytes_;
+  }
+  else if (!job.linked_) {
+    ++statistics_.skippedFiles_;
+    statistics_.skippedBytes_ += job.bytes_;
+  }
+  if (job.linked_)
+    ++statistics_.linkedFiles_;
+
+  if ((!manifestLoaded_) || (!job.entry_))
+    return;
+
+  auto& entry{ manifest_[job.destination_.string()] };
+  if ((entry.source_ == job.entry_->source_) &&
+      (entry.size_ == job.entry_->size_) &&
+      (entry.modified_ == job.entry_->modified_) &&
+      (entry.digest_ == job.entry_->digest_))
+    return;
+
+  entry = *job.entry_;
+  manifestChanged_ = true;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "types.h"
+#include "helpers.h"
+#include "Sha256.h"
+
+namespace zax
+{
+
+// Copies assets into the output directory on a small pool of threads. A
+// manifest kept beside the copied assets remembers the size, modification
+// time and content hash of every source so unchanged assets are skipped on
+// the next build. With a store path set, each distinct content is written
+// once into a content addressed store and outputs become hard links to it.
+struct AssetCopier
+{
+  constexpr static StringView ManifestFileName{ ".zax-assets" };
+  constexpr static StringView StoreDirectoryName{ ".zax-store" };
+
+  struct ManifestEntry
+  {
+    String source_;
+    std::uintmax_t size_{};
+    std::int64_t modified_{};
+    Sha256::Digest digest_{};
+  };
+
+  using Manifest = std::map<String, ManifestEntry>;   // keyed by destination
+
+  struct Job
+  {
+    Path source_;
+    Path destination_;
+
+    std::error_code ec_;
+    bool copied_{};
+    bool linked_{};
+    std::uintmax_t bytes_{};
+    std::optional<ManifestEntry> entry_;
+  };
+
+  using JobList = std::vector<Job>;
+
+  struct Statistics
+  {
+    size_t copiedFiles_{};
+    size_t skippedFiles_{};
+    size_t linkedFiles_{};
+    std::uintmax_t copiedBytes_{};
+    std::uintmax_t skippedBytes_{};
+
+    void add(const Statistics& other) noexcept;
+    [[nodiscard]] bool empty() const noexcept { return 0 == copiedFiles_ + skippedFiles_ + linkedFiles_; }
+  };
+
+  Path manifestPath_;
+  Manifest manifest_;
+  bool manifestLoaded_{};
+  bool manifestChanged_{};
+  Path storePath_;
+  Statistics statistics_;
+
+  void loadManifest(const Path& manifestPath) noexcept;
+  [[nodiscard]] bool saveManifest() noexcept;
+
+  void run(JobList& jobs, int workers) noexcept;
+
+protected:
+  void copy(Job& job, const ManifestEntry* previous) const noexcept;
+  void materialize(Job& job, const ManifestEntry& entry) const noexcept;
+  void record(const Job& job) noexcept;
+};
+
+} // namespace zax
@@ -0,0 +1,93 @@
+#include "pch.h"
+#include "BufferedOutput.h"
+
+#include <filesystem>
+
+using namespace zax;
+
+//-----------------------------------------------------------------------------
+BufferedOutput::BufferedOutput(String filePath) noexcept :
+  filePath_{ std::move(filePath) }
+{
+  std::error_code ec;
+  auto parent{ Path{ filePath_ }.parent_path() };
+  if (!parent.empty())
+    std::filesystem::create_directories(parent, ec);
+
+  stream_.open(filePath_, std::ios::out | std::ios::binary | std::ios::trunc);
+  failed_ = !stream_.is_open();
+  buffer_.reserve(BufferSize);
+}
+
+//-----------------------------------------------------------------------------
+void BufferedOutput::append(StringView value) noexcept
+{
+  if (buffer_.size() + value.size() > BufferSize)
+    flush();
+  if (value.size() >= BufferSize) {
+    write(value);
+    return;
+  }
+  buffer_ += value;
+}
+
+//-----------------------------------------------------------------------------
+void BufferedOutput::appendBigEndian(uint64_t value, size_t bytes) noexcept
+{
+  for (auto shift{ bytes * 8 }; shift > 0; shift -= 8)
+    append(static_cast<char>((value >> (shift - 8)) & 0xFF));
+}
+
+//-----------------------------------------------------------------------------
+void BufferedOutput::appendLittleEndian(uint64_t value, size_t bytes) noexcept
+{
+  for (size_t index{}; index < bytes; ++index)
+    append(static_cast<char>((value >> (index * 8)) & 0xFF));
+}
+
+//-----------------------------------------------------------------------------
+void BufferedOutput::patchLittleEndian(uint64_t at, uint32_t value) noexcept
+{
+  std::array<char, sizeof(value)> bytes{};
+  for (size_t index{}; index < bytes.size(); ++index)
+    bytes[index] = static_cast<char>((value >> (index * 8)) & 0xFF);
+
+  if (at >= flushed_) {
+    std::copy(bytes.begin(), bytes.end(), buffer_.begin() + static_cast<ptrdiff_t>(at - flushed_));
+    return;
+  }
+
+  // the bytes already left the buffer so rewrite them in place on disk
+  flush();
+  stream_.seekp(static_cast<std::streamoff>(at));
+  stream_.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  stream_.seekp(0, std::ios::end);
+  failed_ = failed_ || stream_.fail();
+}
+
+//-----------------------------------------------------------------------------
+void BufferedOutput::flush() noexcept
+{
+  if (buffer_.empty())
+    return;
+  write(buffer_);
+  buffer_.clear();
+}
+
+//-----------------------------------------------------------------------------
+bool BufferedOutput::close() noexcept
+{
+  flush();
+  if (stream_.is_open())
+    stream_.close();
+  return (!failed_) && (!stream_.fail());
+}
+
+//-----------------------------------------------------------------------------
+void BufferedOutput::write(StringView value) noexcept
+{
+  if (!failed_)
+    stream_.write(value.data(), static_cast<std::streamsize>(value.size()));
+  flushed_ += value.size();
+  failed_ = failed_ || stream_.fail();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "types.h"
+
+namespace zax
+{
+
+// A binary file written through one large in memory buffer. Writers that
+// must fix up a length prefix after the fact can patch bytes they already
+// wrote, whether they are still buffered or already on disk.
+struct BufferedOutput
+{
+  constexpr static size_t BufferSize{ 1024 * 1024 };
+
+  String filePath_;
+  std::ofstream stream_;
+  String buffer_;
+  uint64_t flushed_{};
+  bool failed_{};
+
+  BufferedOutput(String filePath) noexcept;
+
+  BufferedOutput(const BufferedOutput&) noexcept = delete;
+  BufferedOutput(BufferedOutput&&) noexcept = delete;
+
+  BufferedOutput& operator=(const BufferedOutput&) noexcept = delete;
+  BufferedOutput& operator=(BufferedOutput&&) noexcept = delete;
+
+  [[nodiscard]] uint64_t offset() const noexcept { return flushed_ + buffer_.size(); }
+
+  void append(char value) noexcept
+  {
+    if (buffer_.size() >= BufferSize)
+      flush();
+    buffer_ += value;
+  }
+
+  void append(StringView value) noexcept;
+  void appendBigEndian(uint64_t value, size_t bytes) noexcept;
+  void appendLittleEndian(uint64_t value, size_t bytes) noexcept;
+  void patchLittleEndian(uint64_t at, uint32_t value) noexcept;
+
+  void flush() noexcept;
+  [[nodiscard]] bool close() noexcept;
+
+protected:
+  void write(StringView value) noexcept;
+};
+
+} // namespace zax
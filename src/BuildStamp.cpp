@@ -0,0 +1,252 @@
+#include "pch.h"
+#include "BuildStamp.h"
+#include "helpers.h"
+#include "version.h"
+
+#include <charconv>
+
+using namespace zax;
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+template <typename TValue>
+bool parseNumber(StringView value, TValue& outValue) noexcept
+{
+  auto [ptr, ec] { std::from_chars(value.data(), value.data() + value.size(), outValue) };
+  return (std::errc{} == ec) && (ptr == value.data() + value.size());
+}
+
+//-----------------------------------------------------------------------------
+Path normalize(const Path& path) noexcept
+{
+  std::error_code ec;
+  auto result{ std::filesystem::absolute(path, ec) };
+  return ec ? path.lexically_normal() : result.lexically_normal();
+}
+
+//-----------------------------------------------------------------------------
+String escapeMake(const String& path) noexcept
+{
+  String result;
+  for (auto ch : path) {
+    switch (ch) {
+      case ' ':
+      case '#':   result += '\\'; break;
+      case '$':   result += '$'; break;
+      default:    break;
+    }
+    result += ch;
+  }
+  return result;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+Sha256::Digest BuildStamp::fingerprint(const Config& config) noexcept
+{
+  // everything that changes what a run reads or writes
+  std::stringstream ss;
+  ss << Version::version() << '\n';
+  for (auto& input : config.inputFilePaths_)
+    ss << "in\t" << input << '\n';
+  ss << "out\t" << config.outputPath_ << '\n';
+  ss << "listing\t" << config.listingFilePath_ << '\n';
+  ss << "module-interface\t" << config.moduleInterfacePath_ << '\n';
+  ss << "depfile\t" << config.dependencyFilePath_ << '\n';
+  ss << "tab\t" << config.tabStopWidth_ << '\n';
+  ss << "asset-store\t" << config.assetStore_ << '\n';
+  ss << "dedupe-sources\t" << config.deduplicateSourcesByContent_ << '\n';
+  ss << "metadata\t" << config.metaData_.outputPath_ << '\t' << config.metaData_.json_ << config.metaData_.bson_ << config.metaData_.cbor_ << config.metaData_.msgPack_ << config.metaData_.ubjson_ << '\n';
+  return Sha256::hash(ss.str());
+}
+
+//-----------------------------------------------------------------------------
+BuildStamp::Entry BuildStamp::probe(const Path& path, Kind kind) noexcept
+{
+  std::error_code ec;
+  switch (kind) {
+    case Kind::File:
+    case Kind::Missing: {
+      auto [contents, length] { readBinaryFile(path.string()) };
+      if (!contents)
+        return Entry{ .kind_ = Kind::Missing };
+      return Entry{ .kind_ = Kind::File, .digest_ = Sha256::hash(contents.get(), length), .size_ = length };
+    }
+    case Kind::Directory: {
+      // a wild card only depends on the names a directory holds
+      std::vector<String> names;
+      for (auto& entry : std::filesystem::directory_iterator(path, ec))
+        names.push_back(entry.path().filename().string());
+      if (ec)
+        return Entry{ .kind_ = Kind::Missing };
+      std::sort(names.begin(), names.end());
+
+      String listing;
+      for (auto& name : names) {
+        listing += name;
+        listing += '\n';
+      }
+      return Entry{ .kind_ = Kind::Directory, .digest_ = Sha256::hash(listing), .size_ = names.size() };
+    }
+    case Kind::Output: {
+      if (!std::filesystem::exists(path, ec))
+        return Entry{ .kind_ = Kind::Missing };
+      return Entry{ .kind_ = Kind::Output };
+    }
+  }
+  return {};
+}
+
+//-----------------------------------------------------------------------------
+BuildStamp BuildStamp::make(const Config& config, const SourceDependencies& dependencies) noexcept
+{
+  BuildStamp result;
+  result.fingerprint_ = fingerprint(config);
+
+  auto add{ [&](const String& filePath, Kind kind) noexcept {
+    if (filePath.empty())
+      return;
+    auto path{ normalize(Path{ filePath }) };
+    auto [iter, added] { result.entries_.try_emplace(path.string()) };
+    if (added)
+      iter->second = probe(path, kind);
+  } };
+
+  // the files written go first so an output that was also read is checked
+  // for existence only
+  for (auto& output : dependencies.outputs_)
+    add(output, Kind::Output);
+  add(config.listingFilePath_, Kind::Output);
+  add(config.moduleInterfacePath_, Kind::Output);
+  add(config.dependencyFilePath_, Kind::Output);
+
+  for (auto& [filePath, requesters] : dependencies.requestedBy_)
+    add(filePath, Kind::File);
+  for (auto& filePath : dependencies.probedFiles_)
+    add(filePath, Kind::File);
+  for (auto& directory : dependencies.listedDirectories_)
+    add(directory, Kind::Directory);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+std::optional<BuildStamp> BuildStamp::load(StringView filePath) noexcept
+{
+  auto [contents, length] { readBinaryFile(filePath) };
+  if (!contents)
+    return {};
+
+  // a header line then one entry per line: kind, digest, size and path
+  BuildStamp result;
+  bool header{ true };
+  StringView remaining{ reinterpret_cast<const char*>(contents.get()), length };
+  while (!remaining.empty()) {
+    auto endOfLine{ remaining.find('\n') };
+    auto line{ remaining.substr(0, endOfLine) };
+    remaining = (StringView::npos == endOfLine) ? StringView{} : remaining.substr(endOfLine + 1);
+
+    std::array<StringView, 4> fields;
+    size_t count{};
+    for (; (count < fields.size()) && (!line.empty()); ++count) {
+      auto tab{ (count + 1 < fields.size()) ? line.find('\t') : StringView::npos };
+      fields[count] = line.substr(0, tab);
+      line = (StringView::npos == tab) ? StringView{} : line.substr(tab + 1);
+    }
+
+    if (header) {
+      int version{};
+      if ((3 != count) || (Header != fields[0]) || (!parseNumber(fields[1], version)) || (FormatVersion != version))
+        return {};
+      auto fingerprint{ Sha256::fromHex(fields[2]) };
+      if (!fingerprint)
+        return {};
+      result.fingerprint_ = *fingerprint;
+      header = false;
+      continue;
+    }
+
+    if (count != fields.size())
+      return {};
+
+    auto kind{ KindTraits::toEnum(fields[0]) };
+    if (!kind)
+      return {};
+    auto digest{ Sha256::fromHex(fields[1]) };
+    Entry entry{ .kind_ = *kind };
+    if ((!digest) || (!parseNumber(fields[2], entry.size_)))
+      return {};
+    entry.digest_ = *digest;
+    result.entries_[String{ fields[3] }] = entry;
+  }
+  if (header)
+    return {};
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+bool BuildStamp::save(StringView filePath) const noexcept
+{
+  std::stringstream ss;
+  ss << Header << '\t' << FormatVersion << '\t' << Sha256::toHex(fingerprint_) << '\n';
+  for (auto& [path, entry] : entries_)
+    ss << KindTraits::toString(entry.kind_) << '\t' << Sha256::toHex(entry.digest_) << '\t' << entry.size_ << '\t' << path << '\n';
+  return writeBinaryFile(filePath, ss.str());
+}
+
+//-----------------------------------------------------------------------------
+bool BuildStamp::upToDate(const Config& config) const noexcept
+{
+  if (fingerprint(config) != fingerprint_)
+    return false;
+
+  for (auto& [path, entry] : entries_) {
+    if (probe(Path{ path }, entry.kind_) != entry)
+      return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool BuildStamp::writeDependencyFile(StringView filePath, StringView target, const SourceDependencies& dependencies) noexcept
+{
+  std::set<String> files;
+  std::set<String> directories;
+
+  for (auto& [file, requesters] : dependencies.requestedBy_) {
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(Path{ file }, ec))
+      files.insert(normalize(Path{ file }).generic_string());
+  }
+
+  // a file that was looked for but not found appears by changing the
+  // directory it would be created in
+  for (auto& file : dependencies.probedFiles_) {
+    std::error_code ec;
+    auto path{ normalize(Path{ file }) };
+    if (std::filesystem::is_regular_file(path, ec))
+      files.insert(path.generic_string());
+    else if (std::filesystem::is_directory(path.parent_path(), ec))
+      directories.insert(path.parent_path().generic_string());
+  }
+  for (auto& directory : dependencies.listedDirectories_)
+    directories.insert(normalize(Path{ directory }).generic_string());
+
+  for (auto& output : dependencies.outputs_)
+    files.erase(normalize(Path{ output }).generic_string());
+
+  std::stringstream ss;
+  ss << escapeMake(String{ target }) << ':';
+  for (auto& file : files)
+    ss << " \\\n  " << escapeMake(file);
+  for (auto& directory : directories)
+    ss << " \\\n  " << escapeMake(directory);
+  ss << '\n';
+
+  // an empty rule per file keeps make going when a dependency is deleted
+  for (auto& file : files)
+    ss << '\n' << escapeMake(file) << ":\n";
+  return writeBinaryFile(filePath, ss.str());
+}
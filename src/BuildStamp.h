@@ -0,0 +1,68 @@
+#pragma once
+
+#include "types.h"
+#include "Config.h"
+#include "Sha256.h"
+#include "SourceDependencies.h"
+
+namespace zax
+{
+
+// What a run depended on and produced: every file read, every file probed
+// for whether it was found or not, every directory listed to match a wild
+// card and every file written. Saved with content hashes next to a
+// fingerprint of the configuration, a later run with the same configuration
+// can prove nothing changed and finish without parsing anything. The same
+// dependencies are also written as a Makefile depfile for make and ninja.
+struct BuildStamp
+{
+  enum class Kind
+  {
+    File,
+    Missing,
+    Directory,
+    Output
+  };
+
+  struct KindDeclare final : public zs::EnumDeclare<Kind, 4>
+  {
+    constexpr const Entries operator()() const noexcept
+    {
+      return { {
+        {Kind::File, "file"},
+        {Kind::Missing, "missing"},
+        {Kind::Directory, "directory"},
+        {Kind::Output, "output"}
+      } };
+    }
+  };
+
+  using KindTraits = zs::EnumTraits<Kind, KindDeclare>;
+
+  struct Entry
+  {
+    Kind kind_{};
+    Sha256::Digest digest_{};
+    size_t size_{};
+
+    bool operator==(const Entry& rhs) const noexcept = default;
+  };
+
+  constexpr static StringView Header{ "zax-stamp" };
+  constexpr static int FormatVersion{ 2 };
+
+  Sha256::Digest fingerprint_{};
+  std::map<String, Entry> entries_;   // normalized absolute path -> entry
+
+  [[nodiscard]] static Sha256::Digest fingerprint(const Config& config) noexcept;
+  [[nodiscard]] static BuildStamp make(const Config& config, const SourceDependencies& dependencies) noexcept;
+  [[nodiscard]] static std::optional<BuildStamp> load(StringView filePath) noexcept;
+  [[nodiscard]] static Entry probe(const Path& path, Kind kind) noexcept;
+
+  [[nodiscard]] bool save(StringView filePath) const noexcept;
+  [[nodiscard]] bool upToDate(const Config& config) const noexcept;
+
+  [[nodiscard]] static bool writeDependencyFile(StringView filePath, StringView target, const SourceDependencies& dependencies) noexcept;
+};
+
+} // namespace zax
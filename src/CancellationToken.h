@@ -0,0 +1,67 @@
+#pragma once
+
+#include "types.h"
+
+namespace zax
+{
+
+// Shared by every parser and worker of a compile so the work stops at the
+// next poll once anyone decides it should. The first reason given is kept
+// and polling is a single relaxed load.
+struct CancellationToken
+{
+  enum class Reason
+  {
+    None,
+    Requested,
+    Fatal,
+    TooManyErrors,
+    TooManyWarnings
+  };
+
+  struct ReasonDeclare final : public zs::EnumDeclare<Reason, 5>
+  {
+    constexpr const Entries operator()() const noexcept
+    {
+      return { {
+        {Reason::None, "none"},
+        {Reason::Requested, "requested"},
+        {Reason::Fatal, "fatal"},
+        {Reason::TooManyErrors, "too-many-errors"},
+        {Reason::TooManyWarnings, "too-many-warnings"}
+      } };
+    }
+  };
+
+  using ReasonTraits = zs::EnumTraits<Reason, ReasonDeclare>;
+
+  std::atomic<bool> cancelled_{};
+  std::atomic<Reason> reason_{};
+
+  CancellationToken() noexcept = default;
+  CancellationToken(const CancellationToken&) noexcept = delete;
+  CancellationToken(CancellationToken&&) noexcept = delete;
+
+  CancellationToken& operator=(const CancellationToken&) noexcept = delete;
+  CancellationToken& operator=(CancellationToken&&) noexcept = delete;
+
+  [[nodiscard]] bool cancelled() const noexcept { return cancelled_.load(std::memory_order_relaxed); }
+  [[nodiscard]] Reason reason() const noexcept { return reason_.load(std::memory_order_acquire); }
+
+  bool cancel(Reason reason) noexcept
+  {
+    auto expected{ Reason::None };
+    if (!reason_.compare_exchange_strong(expected, reason, std::memory_order_acq_rel))
+      return false;
+    cancelled_.store(true, std::memory_order_release);
+    return true;
+  }
+
+  void reset() noexcept
+  {
+    cancelled_.store(false, std::memory_order_relaxed);
+    reason_.store(Reason::None, std::memory_order_release);
+  }
+};
+
+} // namespace zax
@@ -0,0 +1,350 @@
+#include "pch.h"
+#include "CompileServer.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif //_WIN32
+
+using namespace zax;
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+String absoluteSocketPath(StringView socketPath) noexcept
+{
+  std::error_code ec;
+  auto result{ std::filesystem::absolute(Path{ socketPath }, ec) };
+  return ec ? String{ socketPath } : result.lexically_normal().string();
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+CompileServer::CompileServer(StringView socketPath) noexcept :
+  socketPath_{ absoluteSocketPath(socketPath) }
+{
+}
+
+#ifdef _WIN32
+
+//-----------------------------------------------------------------------------
+CompileServer::~CompileServer() noexcept
+{
+}
+
+//-----------------------------------------------------------------------------
+bool CompileServer::listen() noexcept
+{
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+void CompileServer::serve(const Handler&) noexcept
+{
+}
+
+//-----------------------------------------------------------------------------
+void CompileServer::stop() noexcept
+{
+  stop_ = true;
+}
+
+//-----------------------------------------------------------------------------
+void CompileServer::respond(int, const Handler&) noexcept
+{
+}
+
+//-----------------------------------------------------------------------------
+std::optional<int> CompileServer::forward(StringView, const StringList&, std::ostream&) noexcept
+{
+  return {};
+}
+
+#else //_WIN32
+
+namespace
+{
+
+using Frame = CompileServer::Frame;
+
+constexpr size_t FrameHeaderSize{ 5 };
+constexpr size_t MaxFrameSize{ 64 * 1024 * 1024 };
+
+//-----------------------------------------------------------------------------
+void unlinkSocket(const String& socketPath) noexcept
+{
+  // whatever else sits at the path belongs to someone else
+  struct stat info {};
+  if ((0 == ::lstat(socketPath.c_str(), &info)) && (S_ISSOCK(info.st_mode)))
+    (void)::unlink(socketPath.c_str());
+}
+
+//-----------------------------------------------------------------------------
+bool sendAll(int socket, const char* data, size_t length) noexcept
+{
+  while (length > 0) {
+    auto sent{ ::send(socket, data, length, MSG_NOSIGNAL) };
+    if (sent < 0) {
+      if (EINTR == errno)
+        continue;
+      return false;
+    }
+    data += sent;
+    length -= static_cast<size_t>(sent);
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool receiveAll(int socket, char* data, size_t length) noexcept
+{
+  while (length > 0) {
+    auto received{ ::recv(socket, data, length, 0) };
+    if (received < 0) {
+      if (EINTR == errno)
+        continue;
+      return false;
+    }
+    if (0 == received)
+      return false;
+    data += received;
+    length -= static_cast<size_t>(received);
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool sendFrame(int socket, Frame frame, StringView payload) noexcept
+{
+  std::array<char, FrameHeaderSize> header{};
+  header[0] = static_cast<char>(frame);
+  for (size_t index{}; index < 4; ++index)
+    header[1 + index] = static_cast<char>((payload.size() >> (index * 8)) & 0xFF);
+  if (!sendAll(socket, header.data(), header.size()))
+    return false;
+  return sendAll(socket, payload.data(), payload.size());
+}
+
+//-----------------------------------------------------------------------------
+bool receiveFrame(int socket, Frame& frame, String& payload) noexcept
+{
+  std::array<char, FrameHeaderSize> header{};
+  if (!receiveAll(socket, header.data(), header.size()))
+    return false;
+
+  size_t length{};
+  for (size_t index{}; index < 4; ++index)
+    length |= static_cast<size_t>(static_cast<unsigned char>(header[1 + index])) << (index * 8);
+  if (length > MaxFrameSize)
+    return false;
+
+  frame = static_cast<Frame>(header[0]);
+  payload.resize(length);
+  return receiveAll(socket, payload.data(), length);
+}
+
+//-----------------------------------------------------------------------------
+bool sendExit(int socket, int result) noexcept
+{
+  std::array<char, 4> payload{};
+  for (size_t index{}; index < payload.size(); ++index)
+    payload[index] = static_cast<char>((static_cast<uint32_t>(result) >> (index * 8)) & 0xFF);
+  return sendFrame(socket, Frame::Exit, StringView{ payload.data(), payload.size() });
+}
+
+//-----------------------------------------------------------------------------
+std::optional<sockaddr_un> makeAddress(StringView socketPath) noexcept
+{
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path))
+    return {};
+  std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+  return address;
+}
+
+// Sends everything written to it as output frames, at the latest whenever
+// the stream is flushed so a client sees diagnostics as they are produced.
+struct FrameBuffer final : public std::streambuf
+{
+  int socket_{};
+  std::array<char, 64 * 1024> buffer_{};
+  bool failed_{};
+
+  FrameBuffer(int socket) noexcept : socket_{ socket } { setp(buffer_.data(), buffer_.data() + buffer_.size()); }
+
+  bool send() noexcept
+  {
+    auto length{ static_cast<size_t>(pptr() - pbase()) };
+    if ((length > 0) && (!failed_))
+      failed_ = !sendFrame(socket_, Frame::Output, StringView{ pbase(), length });
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    return !failed_;
+  }
+
+  int_type overflow(int_type ch) final
+  {
+    if (!send())
+      return traits_type::eof();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(ch);
+      pbump(1);
+    }
+    return traits_type::not_eof(ch);
+  }
+
+  int sync() final { return send() ? 0 : -1; }
+};
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+CompileServer::~CompileServer() noexcept
+{
+  auto listener{ listener_.exchange(-1) };
+  if (listener < 0)
+    return;
+  ::close(listener);
+  unlinkSocket(socketPath_);
+}
+
+//-----------------------------------------------------------------------------
+bool CompileServer::listen() noexcept
+{
+  auto address{ makeAddress(socketPath_) };
+  if (!address)
+    return false;
+
+  auto listener{ ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0) };
+  if (listener < 0)
+    return false;
+
+  // a socket left behind by a server that did not shut down cleanly
+  unlinkSocket(socketPath_);
+  if ((0 != ::bind(listener, reinterpret_cast<const sockaddr*>(&(*address)), sizeof(*address))) ||
+      (0 != ::listen(listener, SOMAXCONN))) {
+    ::close(listener);
+    return false;
+  }
+  listener_ = listener;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void CompileServer::serve(const Handler& handler) noexcept
+{
+  while (!stop_.load(std::memory_order_acquire)) {
+    auto listener{ listener_.load() };
+    if (listener < 0)
+      return;
+
+    auto connection{ ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC) };
+    if (connection < 0) {
+      if (EINTR == errno)
+        continue;
+      return;
+    }
+    respond(connection, handler);
+    ::close(connection);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void CompileServer::stop() noexcept
+{
+  stop_.store(true, std::memory_order_release);
+  if (auto listener{ listener_.load() }; listener >= 0)
+    ::shutdown(listener, SHUT_RDWR);
+}
+
+//-----------------------------------------------------------------------------
+void CompileServer::respond(int connection, const Handler& handler) noexcept
+{
+  Frame frame{};
+  String payload;
+  if ((!receiveFrame(connection, frame, payload)) || (Frame::Request != frame))
+    return;
+
+  // the payload is the working directory followed by the arguments
+  StringList arguments;
+  for (size_t start{}; start < payload.size();) {
+    auto end{ payload.find('\0', start) };
+    if (String::npos == end)
+      end = payload.size();
+    arguments.emplace_back(payload.substr(start, end - start));
+    start = end + 1;
+  }
+  if (arguments.empty())
+    return;
+
+  std::error_code ec;
+  std::filesystem::current_path(Path{ arguments.front() }, ec);
+  arguments.pop_front();
+  if (ec) {
+    (void)sendFrame(connection, Frame::Output, "[ERROR] the compile server cannot enter the client working directory\n");
+    (void)sendExit(connection, -3);
+    return;
+  }
+
+  FrameBuffer buffer{ connection };
+  std::cout.flush();
+  auto original{ std::cout.rdbuf(&buffer) };
+  auto result{ handler(arguments) };
+  std::cout.flush();
+  std::cout.rdbuf(original);
+  ++served_;
+
+  (void)sendExit(connection, result);
+}
+
+//-----------------------------------------------------------------------------
+std::optional<int> CompileServer::forward(StringView socketPath, const StringList& arguments, std::ostream& output) noexcept
+{
+  auto address{ makeAddress(socketPath) };
+  if (!address)
+    return {};
+
+  auto connection{ ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0) };
+  if (connection < 0)
+    return {};
+  zs::AutoScope closeScope{ [&]() noexcept { ::close(connection); } };
+
+  if (0 != ::connect(connection, reinterpret_cast<const sockaddr*>(&(*address)), sizeof(*address)))
+    return {};
+
+  std::error_code ec;
+  String payload{ std::filesystem::current_path(ec).string() };
+  for (auto& argument : arguments) {
+    payload += '\0';
+    payload += argument;
+  }
+  if (!sendFrame(connection, Frame::Request, payload))
+    return {};
+
+  Frame frame{};
+  while (receiveFrame(connection, frame, payload)) {
+    switch (frame) {
+      case Frame::Output: {
+        output.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        output.flush();
+        break;
+      }
+      case Frame::Exit: {
+        if (payload.size() != 4)
+          return {};
+        uint32_t result{};
+        for (size_t index{}; index < 4; ++index)
+          result |= static_cast<uint32_t>(static_cast<unsigned char>(payload[index])) << (index * 8);
+        return static_cast<int>(result);
+      }
+      case Frame::Request:  return {};
+    }
+  }
+  return {};
+}
+
+#endif //_WIN32
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "types.h"
+
+namespace zax
+{
+
+// Serves compile requests over a Unix domain socket from one long lived
+// process so every request after the first finds the shared caches warm.
+// A client sends its working directory and arguments; everything the run
+// writes to standard output streams back as it is produced, followed by
+// the exit code. Requests are handled one at a time since a run owns the
+// process wide diagnostic state.
+struct CompileServer
+{
+  using Handler = std::function<int(const StringList& arguments)>;
+
+  enum class Frame : uint8_t
+  {
+    Request,
+    Output,
+    Exit
+  };
+
+  const String socketPath_;     // absolute since requests change directory
+  std::atomic<int> listener_{ -1 };
+  std::atomic<bool> stop_{};
+  size_t served_{};
+
+  CompileServer(StringView socketPath) noexcept;
+  ~CompileServer() noexcept;
+
+  CompileServer(const CompileServer&) noexcept = delete;
+  CompileServer(CompileServer&&) noexcept = delete;
+
+  CompileServer& operator=(const CompileServer&) noexcept = delete;
+  CompileServer& operator=(CompileServer&&) noexcept = delete;
+
+  [[nodiscard]] bool listen() noexcept;
+  void serve(const Handler& handler) noexcept;
+  void stop() noexcept;
+
+  [[nodiscard]] static std::optional<int> forward(StringView socketPath, const StringList& arguments, std::ostream& output) noexcept;
+
+protected:
+  void respond(int connection, const Handler& handler) noexcept;
+};
+
+} // namespace zax
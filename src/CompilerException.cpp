@@ -8,6 +8,10 @@
 
 using namespace zax;
 
+static_assert(messageTemplatesFit<InformationalTypes::Informational, InformationalTypes::InformationalHumanReadableTraits>());
+static_assert(messageTemplatesFit<WarningTypes::Warning, WarningTypes::WarningHumanReadableTraits>());
+static_assert(messageTemplatesFit<ErrorTypes::Error, ErrorTypes::ErrorHumanReadableTraits>());
+
 //-----------------------------------------------------------------------------
 TokenPtr zax::makeInternalToken(CompileStatePtr state) noexcept
 {
@@ -25,8 +29,104 @@ TokenPtr zax::makeInternalToken(CompileStatePtr state) noexcept
   return result;
 }
 
+namespace
+{
+
+//-----------------------------------------------------------------------------
+Diagnostic& withActualOrigin(Diagnostic& diagnostic, const TokenConstPtr& token) noexcept
+{
+  if ((token->origin_.filePath_ == token->actualOrigin_.filePath_) &&
+      (token->origin_.location_ == token->actualOrigin_.location_))
+    return diagnostic;
+  if (!token->actualOrigin_.filePath_)
+    return diagnostic;
+
+  diagnostic.actualOrigin_ = true;
+  diagnostic.actualFileName_ = token->actualOrigin_.filePath_->filePath_;
+  diagnostic.actualLine_ = token->actualOrigin_.location_.line_;
+  diagnostic.actualColumn_ = token->actualOrigin_.location_.column_;
+  return diagnostic;
+}
+
+//-----------------------------------------------------------------------------
+void outputActualOrigin(const TokenConstPtr& token) noexcept
+{
+  if ((token->origin_.filePath_ == token->actualOrigin_.filePath_) &&
+      (token->origin_.location_ == token->actualOrigin_.location_))
+    return;
+  assert(token->actualOrigin_.filePath_);
+
+  using Informational = InformationalTypes::Informational;
+  zax::output(
+    Diagnostic{
+      .type_ = CompilerException::ErrorType::Informational,
+      .fileName_ = token->actualOrigin_.filePath_->filePath_,
+      .line_ = token->actualOrigin_.location_.line_,
+      .column_ = token->actualOrigin_.location_.column_,
+      .iana_ = InformationalTypes::InformationalTraits::toString(Informational::ActualOrigin),
+      .message_ = &messageTemplate<Informational, InformationalTypes::InformationalHumanReadableTraits>(Informational::ActualOrigin),
+      .continuation_ = true
+    }
+  );
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+String CompilerException::format(
+  ErrorType type,
+  StringView fileName,
+  int line,
+  int column,
+  StringView iana,
+  StringView message) noexcept
+{
+  StringStream ss;
+
+  bool added{};
+  bool addedBracket{};
+
+  ss << fileName;
+  if (fileName.size() > 0) {
+    added = true;
+  }
+
+  if (0 != line) {
+    ss << "(";
+    ss << line;
+    addedBracket = true;
+  }
+  if (0 != column) {
+    if (!addedBracket)
+      ss << "(";
+    else
+      ss << ",";
+    ss << column;
+    addedBracket = true;
+  }
+
+  if (addedBracket)
+    ss << ")";
+
+  if (added || addedBracket)
+    ss << ": ";
+
+  ss << ErrorTypeTraits::toString(type) << " " << iana << ": " << message;
+
+  return ss.str();
+}
+
+//-----------------------------------------------------------------------------
+String Diagnostic::render() const noexcept
+{
+  String message{ text_ };
+  if (message_)
+    message_->render(message, arguments_ ? *arguments_ : DiagnosticArguments{});
+  return CompilerException::format(type_, fileName_, line_, column_, iana_, message);
+}
+
 //-----------------------------------------------------------------------------
-void zax::output(InformationalTypes::Informational informational, const TokenConstPtr& token, const StringMap& params) noexcept
+void zax::output(InformationalTypes::Informational informational, const TokenConstPtr& token, const DiagnosticArguments& params) noexcept
 {
   assert(token);
 
@@ -41,78 +141,79 @@ void zax::output(InformationalTypes::Informational informational, const TokenCon
   assert(useOrigin->filePath_);
 
   zax::output(
-    CompilerException{
+    Diagnostic{
       CompilerException::ErrorType::Informational,
       useOrigin->filePath_->filePath_,
       useOrigin->location_.line_,
       useOrigin->location_.column_,
-      String{ InformationalTypes::InformationalTraits::toString(informational) },
-      stringReplace(InformationalTypes::InformationalHumanReadableTraits::toString(informational), params)
+      InformationalTypes::InformationalTraits::toString(informational),
+      &messageTemplate<InformationalTypes::Informational, InformationalTypes::InformationalHumanReadableTraits>(informational),
+      &params
     }
   );
 }
 
 //-----------------------------------------------------------------------------
-void zax::output(WarningTypes::Warning warning, const TokenConstPtr& token, const StringMap& params) noexcept
+void zax::output(WarningTypes::Warning warning, const TokenConstPtr& token, const DiagnosticArguments& params) noexcept
 {
   assert(token);
   assert(token->origin_.filePath_);
   assert(token->compileState_);
   bool treatAsError{ token->compileState_->isWarningAnError(warning) };
 
-  zax::output(
-    CompilerException{
-      treatAsError ? CompilerException::ErrorType::Error : CompilerException::ErrorType::Warning,
-      token->origin_.filePath_->filePath_,
-      token->origin_.location_.line_,
-      token->origin_.location_.column_,
-      String{ WarningTypes::WarningTraits::toString(warning) },
-      stringReplace(WarningTypes::WarningHumanReadableTraits::toString(warning), params)
-    }
-  );
-  output(InformationalTypes::Informational::ActualOrigin, token);
+  Diagnostic diagnostic{
+    treatAsError ? CompilerException::ErrorType::Error : CompilerException::ErrorType::Warning,
+    token->origin_.filePath_->filePath_,
+    token->origin_.location_.line_,
+    token->origin_.location_.column_,
+    WarningTypes::WarningTraits::toString(warning),
+    &messageTemplate<WarningTypes::Warning, WarningTypes::WarningHumanReadableTraits>(warning),
+    &params
+  };
+  zax::output(withActualOrigin(diagnostic, token));
+  outputActualOrigin(token);
 }
 
 //-----------------------------------------------------------------------------
-void zax::output(ErrorTypes::Error error, const TokenConstPtr& token, const StringMap& params) noexcept
+void zax::output(ErrorTypes::Error error, const TokenConstPtr& token, const DiagnosticArguments& params) noexcept
 {
   assert(token);
   assert(token->origin_.filePath_);
 
-  zax::output(
-    CompilerException{
-      CompilerException::ErrorType::Error,
-      token->origin_.filePath_->filePath_,
-      token->origin_.location_.line_,
-      token->origin_.location_.column_,
-      String{ ErrorTypes::ErrorTraits::toString(error) },
-      stringReplace(ErrorTypes::ErrorHumanReadableTraits::toString(error), params)
-    }
-  );
-  output(InformationalTypes::Informational::ActualOrigin, token);
+  Diagnostic diagnostic{
+    CompilerException::ErrorType::Error,
+    token->origin_.filePath_->filePath_,
+    token->origin_.location_.line_,
+    token->origin_.location_.column_,
+    ErrorTypes::ErrorTraits::toString(error),
+    &messageTemplate<ErrorTypes::Error, ErrorTypes::ErrorHumanReadableTraits>(error),
+    &params
+  };
+  zax::output(withActualOrigin(diagnostic, token));
+  outputActualOrigin(token);
 }
 
 //-----------------------------------------------------------------------------
-void zax::fatal(ErrorTypes::Error error, const TokenConstPtr& token, const StringMap& params) noexcept
+void zax::fatal(ErrorTypes::Error error, const TokenConstPtr& token, const DiagnosticArguments& params) noexcept
 {
   assert(token);
   assert(token->origin_.filePath_);
 
-  zax::output(
-    CompilerException{
-      CompilerException::ErrorType::Fatal,
-      token->origin_.filePath_->filePath_,
-      token->origin_.location_.line_,
-      token->origin_.location_.column_,
-      String{ ErrorTypes::ErrorTraits::toString(error) },
-      stringReplace(ErrorTypes::ErrorHumanReadableTraits::toString(error), params)
-    }
-  );
-  output(InformationalTypes::Informational::ActualOrigin, token);
+  Diagnostic diagnostic{
+    CompilerException::ErrorType::Fatal,
+    token->origin_.filePath_->filePath_,
+    token->origin_.location_.line_,
+    token->origin_.location_.column_,
+    ErrorTypes::ErrorTraits::toString(error),
+    &messageTemplate<ErrorTypes::Error, ErrorTypes::ErrorHumanReadableTraits>(error),
+    &params
+  };
+  zax::output(withActualOrigin(diagnostic, token));
+  outputActualOrigin(token);
 }
 
 //-----------------------------------------------------------------------------
-void zax::throwException(ErrorTypes::Error error, const TokenConstPtr& token, const StringMap& params) noexcept(false)
+void zax::throwException(ErrorTypes::Error error, const TokenConstPtr& token, const DiagnosticArguments& params) noexcept(false)
 {
   assert(token);
   assert(token->origin_.filePath_);
@@ -124,7 +225,7 @@ void zax::throwException(ErrorTypes::Error error, const TokenConstPtr& token, co
       token->origin_.location_.line_,
       token->origin_.location_.column_,
       String{ ErrorTypes::ErrorTraits::toString(error) },
-      stringReplace(ErrorTypes::ErrorHumanReadableTraits::toString(error), params)
+      messageTemplate<ErrorTypes::Error, ErrorTypes::ErrorHumanReadableTraits>(error).render(params)
     }
   );
 }
@@ -4,6 +4,7 @@
 #include "Informationals.h"
 #include "Warnings.h"
 #include "Errors.h"
+#include "MessageTemplate.h"
 
 namespace zax
 {
@@ -40,7 +41,7 @@ struct CompilerException final : public std::exception
   String iana_;
   String message_;
 
-  String what_;
+  mutable String what_;
 
   CompilerException(
     ErrorType type,
@@ -50,80 +51,85 @@ struct CompilerException final : public std::exception
     const String& iana,
     const String& message
   ) noexcept :
+    type_{ type },
     fileName_{ fileName },
     line_{ line },
     column_{ column },
     iana_{ iana },
     message_{ message }
   {
-    StringStream ss;
-
-    bool added{};
-    bool addedBracket{};
-
-    ss << fileName;
-    if (fileName.size() > 0) {
-      added = true;
-    }
- 
-   if (0 != line_) {
-      ss << "(";
-      ss << line_;
-      addedBracket = true;
-    }
-    if (0 != column_) {
-      if (!addedBracket)
-        ss << "(";
-      else
-        ss << ",";
-      ss << column_;
-      addedBracket = true;
-    }
-
-    if (addedBracket)
-      ss << ")";
-
-    if (added || addedBracket)
-      ss << ": ";
-
-    ss << ErrorTypeTraits::toString(type_) << " " << iana_ << ": " << message_;
-
-    what_ = ss.str();
   }
 
+  [[nodiscard]] static String format(
+    ErrorType type,
+    StringView fileName,
+    int line,
+    int column,
+    StringView iana,
+    StringView message) noexcept;
+
   const char* what() const noexcept final
   {
+    if (what_.empty())
+      what_ = format(type_, fileName_, line_, column_, iana_, message_);
     return what_.c_str();
   }
 };
 
+// A diagnostic as reported, before any text is produced. The views and
+// arguments belong to the reporter and only have to outlive the output call
+// since the message is rendered only when it will be displayed.
+struct Diagnostic
+{
+  CompilerException::ErrorType type_{};
+  StringView fileName_;
+  int line_{};
+  int column_{};
+  StringView iana_;
+  const MessageTemplate* message_{};
+  const DiagnosticArguments* arguments_{};
+
+  bool actualOrigin_{};         // set when the token was produced elsewhere
+  StringView actualFileName_;
+  int actualLine_{};
+  int actualColumn_{};
+  bool continuation_{};         // repeats the actual origin of the previous diagnostic
+  StringView text_;             // literal message used when there is no template
+
+  [[nodiscard]] String render() const noexcept;
+};
+
 int totalErrors() noexcept;
 int totalWarnings() noexcept;
+int maxErrors() noexcept;
+std::optional<int> maxWarnings() noexcept;
 bool shouldAbort() noexcept;
+CancellationTokenPtr cancellation() noexcept;
 
 TokenPtr makeInternalToken(CompileStatePtr state) noexcept;
 
 void output(const CompilerException& exception) noexcept;
+void output(const Diagnostic& diagnostic) noexcept;
 inline void throwException(const CompilerException& exception) noexcept(false) { throw exception; }
 
 void output(
   InformationalTypes::Informational informational,
   const TokenConstPtr &token,
-  const StringMap& params = {}) noexcept;
+  const DiagnosticArguments& params = {}) noexcept;
 void output(
   WarningTypes::Warning warning,
   const TokenConstPtr& token,
-  const StringMap& params = {}) noexcept;
+  const DiagnosticArguments& params = {}) noexcept;
 void output(ErrorTypes::Error error,
   const TokenConstPtr& token,
-  const StringMap& params = {}) noexcept;
+  const DiagnosticArguments& params = {}) noexcept;
 void fatal(ErrorTypes::Error error,
   const TokenConstPtr& token,
-  const StringMap& params = {}) noexcept;
+  const DiagnosticArguments& params = {}) noexcept;
 
 void throwException(
   ErrorTypes::Error error,
   const TokenConstPtr& token,
-  const StringMap& params = {}) noexcept(false);
+  const DiagnosticArguments& params = {}) noexcept(false);
 
 } // namespace zax
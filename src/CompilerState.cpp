@@ -21,6 +21,8 @@ CompileStatePtr CompileState::fork(const CompileStateConstPtr& original) noexcep
   result->variableDefaults_ = original->variableDefaults_;
   result->typeDefaults_ = original->typeDefaults_;
   result->functionDefaults_ = original->functionDefaults_;
+  result->deprecate_ = original->deprecate_;
+  result->export_ = original->export_;
 
   result->variableDefaultsStack_ = original->variableDefaultsStack_;
   result->typeDefaultsStack_ = original->typeDefaultsStack_;
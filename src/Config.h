@@ -8,11 +8,43 @@ namespace zax
 
 struct Config
 {
+  enum class DiagnosticsFormat
+  {
+    Text,
+    JsonLines,
+    Sarif
+  };
+
+  struct DiagnosticsFormatDeclare final : public zs::EnumDeclare<DiagnosticsFormat, 3>
+  {
+    constexpr const Entries operator()() const noexcept
+    {
+      return { {
+        {DiagnosticsFormat::Text, "text"},
+        {DiagnosticsFormat::JsonLines, "jsonl"},
+        {DiagnosticsFormat::Sarif, "sarif"}
+      } };
+    }
+  };
+
+  using DiagnosticsFormatTraits = zs::EnumTraits<DiagnosticsFormat, DiagnosticsFormatDeclare>;
+
   bool quiet_{};
+  bool watch_{};
   std::list<String> inputFilePaths_;
   String outputPath_;
   String listingFilePath_;
+  String parseCachePath_;
+  String moduleInterfacePath_;
+  String dependencyFilePath_;
+  String stampFilePath_;
   int tabStopWidth_{ 8 };
+  int sourceWorkers_{ 1 };
+  int assetWorkers_{ 4 };
+  bool assetStore_{};
+  bool deduplicateSourcesByContent_{};
+  DiagnosticsFormat diagnosticsFormat_{};
+  SourceCachePtr sourceCache_;   // shared by the requests of a compile server
 
   struct MetaData final
   {
@@ -5,14 +5,73 @@
 
 using namespace zax;
 
+//-----------------------------------------------------------------------------
+ContextPool::~ContextPool() noexcept
+{
+  destroying_ = true;
+  for (uint32_t index{}; index < slots_.size(); ++index) {
+    if (!isLiveGeneration(slots_[index].generation_))
+      continue;
+    contexts_[index]->~Context();
+    ++(slots_[index].generation_);
+  }
+}
+
+//-----------------------------------------------------------------------------
+ContextPtr ContextPool::create() noexcept
+{
+  static_assert(alignof(Context) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+  uint32_t index{ freeSlot_ };
+  if (NoSlot != index) {
+    freeSlot_ = slots_[index].nextFree_;
+  }
+  else {
+    index = static_cast<uint32_t>(slots_.size());
+    if (0 == (index % ChunkSize))
+      chunks_.push_back(std::make_unique<std::byte[]>(sizeof(Context) * ChunkSize));
+    slots_.emplace_back();
+    contexts_.push_back(reinterpret_cast<Context*>(chunks_.back().get() + (sizeof(Context) * (index % ChunkSize))));
+  }
+
+  auto& slot{ slots_[index] };
+  assert(!isLiveGeneration(slot.generation_));
+  ++slot.generation_;
+  slot.references_ = 0;
+  slot.nextFree_ = NoSlot;
+
+  auto context{ new (contexts_[index]) Context() };
+  context->pool_ = this;
+  context->index_ = index;
+  context->generation_ = slot.generation_;
+  return ContextPtr{ *this, index, slot.generation_ };
+}
+
+//-----------------------------------------------------------------------------
+void ContextPool::destroy(uint32_t index) noexcept
+{
+  auto& slot{ slots_[index] };
+  assert(isLiveGeneration(slot.generation_));
+  assert(0 == slot.references_);
+
+  // the destructor may release other handles into this pool (which could
+  // in turn grow the slot list) so the slot is only recycled afterwards
+  contexts_[index]->~Context();
+
+  auto& released{ slots_[index] };
+  ++released.generation_;
+  released.nextFree_ = freeSlot_;
+  freeSlot_ = index;
+}
+
 //-----------------------------------------------------------------------------
 ContextPtr Context::forkChild(const Type type) noexcept
 {
-  alive_();
-  auto result{ std::make_shared<Context>() };
-  result->thisWeak_ = result;
+  alive();
+  auto result{ pool_->create() };
   result->type_ = type;
-  result->parent_ = this;
+  result->parentIndex_ = index_;
+  result->parentGeneration_ = generation_;
   result->parser_ = parser_;
   result->module_ = module_;
   result->tokenizer_ = tokenizer_;
@@ -32,7 +91,7 @@ Context* Context::findParent(Type type) noexcept
   if (type_ == type)
     return this;
 
-  for (auto parent{ parent_ }; parent; parent = parent->parent()) {
+  for (auto parent{ this->parent() }; parent; parent = parent->parent()) {
     if (parent->type_ == type)
       return parent;
   }
@@ -53,7 +112,7 @@ CompileStatePtr Context::state() noexcept
   if (state_)
     return state_;
 
-  for (auto parent{ parent_ }; parent; parent = parent->parent()) {
+  for (auto parent{ this->parent() }; parent; parent = parent->parent()) {
     if (parent->singleLineState_)
       return parent->singleLineState_;
     if (parent->state_)
@@ -68,16 +127,37 @@ CompileStateConstPtr Context::state() const noexcept
   return const_cast<Context*>(this)->state();
 }
 
+//-----------------------------------------------------------------------------
+void Context::aliasAdded() noexcept
+{
+  auto& parser{ this->parser() };
+  ++parser.aliasGeneration_;
+}
+
 //-----------------------------------------------------------------------------
 void Context::aliasLookup(const Token& token) const noexcept
 {
-  if (token.aliasSearched_)
+  auto& parser{ this->parser() };
+  if (parser.aliasGeneration_ == token.aliasGeneration_)
     return;
-  token.aliasSearched_ = true;
+  token.aliasGeneration_ = parser.aliasGeneration_;
+  token.alias_.reset();
 
   if (TokenTypes::Type::Literal != token.type_)
     return;
 
+  auto& cache{ parser.aliasCache_ };
+  if (cache.generation_ != parser.aliasGeneration_) {
+    cache.resolved_.clear();
+    cache.generation_ = parser.aliasGeneration_;
+  }
+
+  ParserTypes::AliasCacheKeyView key{ token.token_, index_, generation_ };
+  if (auto found{ cache.resolved_.find(key) }; found != cache.resolved_.end()) {
+    token.alias_ = found->second;
+    return;
+  }
+
   String literal{ token.token_ };
 
   for (const Context* current{ this }; current; current = current->parent()) {
@@ -90,4 +170,6 @@ void Context::aliasLookup(const Token& token) const noexcept
       break;
     }
   }
+
+  cache.resolved_.emplace(ParserTypes::AliasCacheKey{ std::move(literal), index_, generation_ }, token.alias_);
 }
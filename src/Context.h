@@ -3,6 +3,7 @@
 
 #include "types.h"
 #include "helpers.h"
+#include "ContextPool.h"
 
 #include "Token.h"
 
@@ -40,10 +41,11 @@ struct Context : public ContextTypes
   Puid owner_{};
   Type type_{};
 
-  Alive alive_;
-
-  ContextWeakPtr thisWeak_;
-  Context* parent_{};
+  ContextPool* pool_{};
+  uint32_t index_{};
+  uint32_t generation_{};
+  uint32_t parentIndex_{ ContextPool::NoSlot };
+  uint32_t parentGeneration_{};
 
   Parser* parser_{};
   Module* module_{};
@@ -59,6 +61,9 @@ struct Context : public ContextTypes
   Context& operator=(const Context&) noexcept = delete;
   Context& operator=(Context&&) noexcept = delete;
 
+  ContextPtr handle() noexcept { alive(); return ContextPtr{ *pool_, index_, generation_ }; }
+  ContextConstPtr handle() const noexcept { alive(); return ContextConstPtr{ *pool_, index_, generation_ }; }
+
   ContextPtr forkChild(const Type type) noexcept;
   ContextPtr forkChild(const Type type) const noexcept;
   ContextPtr forkChild(Puid owner, const Type type) const noexcept {
@@ -79,13 +84,15 @@ struct Context : public ContextTypes
   Context* findParent(Type type) noexcept;
   const Context* findParent(Type type) const noexcept;
 
-  Context* parent() noexcept { alive_();  return parent_; }
-  const Context* parent() const noexcept { alive_();  return parent_; }
+  void alive() const noexcept { assert(pool_); assert(pool_->live(index_, generation_)); }
+
+  Context* parent() noexcept { alive(); return ContextPool::NoSlot == parentIndex_ ? nullptr : &(pool_->at(parentIndex_, parentGeneration_)); }
+  const Context* parent() const noexcept { alive(); return ContextPool::NoSlot == parentIndex_ ? nullptr : &(pool_->at(parentIndex_, parentGeneration_)); }
 
-  Parser& parser() noexcept { alive_(); assert(parser_); return *parser_; }
-  const Parser& parser() const noexcept { alive_(); assert(parser_); return *parser_; }
-  Module& module() noexcept { alive_(); assert(module_); return *module_; }
-  const Module& module() const noexcept { alive_(); assert(module_); return *module_; }
+  Parser& parser() noexcept { alive(); assert(parser_); return *parser_; }
+  const Parser& parser() const noexcept { alive(); assert(parser_); return *parser_; }
+  Module& module() noexcept { alive(); assert(module_); return *module_; }
+  const Module& module() const noexcept { alive(); assert(module_); return *module_; }
 
   struct Aliasing
   {
@@ -97,6 +104,7 @@ struct Context : public ContextTypes
     std::map<String, TypePtr> types_;
   } types_;
 
+  void aliasAdded() noexcept;
   void aliasLookup(const Token& token) const noexcept;
   void aliasLookup(const TokenConstPtr token) const noexcept { if (!token) return; aliasLookup(*token); }
 };
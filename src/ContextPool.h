@@ -0,0 +1,147 @@
+#pragma once
+
+#include "types.h"
+
+namespace zax
+{
+
+struct ContextPool;
+
+// Contexts live inside their parser's pool and are referenced through a
+// non-atomic intrusive handle. A pool slot's generation is odd while a context
+// lives in the slot and is bumped whenever the slot is created or released so
+// a handle (or parent index) into a recycled slot is caught in debug builds.
+template <typename TContext>
+struct ContextHandle
+{
+  ContextPool* pool_{};
+  uint32_t index_{};
+  uint32_t generation_{};
+
+  ContextHandle() noexcept = default;
+  ContextHandle(std::nullptr_t) noexcept {}
+  ContextHandle(ContextPool& pool, uint32_t index, uint32_t generation) noexcept;
+  ContextHandle(const ContextHandle& rhs) noexcept : ContextHandle(rhs.pool_, rhs.index_, rhs.generation_) {}
+  ContextHandle(ContextHandle&& rhs) noexcept : pool_{ rhs.pool_ }, index_{ rhs.index_ }, generation_{ rhs.generation_ } { rhs.pool_ = {}; }
+
+  template <typename TOther>
+    requires (std::is_const_v<TContext> && (!std::is_const_v<TOther>))
+  ContextHandle(const ContextHandle<TOther>& rhs) noexcept : ContextHandle(rhs.pool_, rhs.index_, rhs.generation_) {}
+
+  ~ContextHandle() noexcept { reset(); }
+
+  ContextHandle& operator=(const ContextHandle& rhs) noexcept { ContextHandle temp{ rhs }; swap(temp); return *this; }
+  ContextHandle& operator=(ContextHandle&& rhs) noexcept { ContextHandle temp{ std::move(rhs) }; swap(temp); return *this; }
+  ContextHandle& operator=(std::nullptr_t) noexcept { reset(); return *this; }
+
+  void reset() noexcept;
+  void swap(ContextHandle& rhs) noexcept { std::swap(pool_, rhs.pool_); std::swap(index_, rhs.index_); std::swap(generation_, rhs.generation_); }
+
+  [[nodiscard]] TContext* get() const noexcept;
+  [[nodiscard]] TContext& operator*() const noexcept { assert(pool_); return *get(); }
+  [[nodiscard]] TContext* operator->() const noexcept { assert(pool_); return get(); }
+
+  [[nodiscard]] explicit operator bool() const noexcept { return static_cast<bool>(pool_); }
+
+  [[nodiscard]] bool operator==(const ContextHandle& rhs) const noexcept { return (pool_ == rhs.pool_) && (index_ == rhs.index_); }
+  [[nodiscard]] bool operator!=(const ContextHandle& rhs) const noexcept { return !(*this == rhs); }
+
+private:
+  ContextHandle(ContextPool* pool, uint32_t index, uint32_t generation) noexcept;
+};
+
+using ContextPtr = ContextHandle<Context>;
+using ContextConstPtr = ContextHandle<const Context>;
+
+// The pool owns every context of a single parse. Storage is handed out in
+// fixed chunks so a context never moves and released slots are recycled
+// through a free list; the pool must outlive every handle into it.
+struct ContextPool
+{
+  constexpr static uint32_t ChunkSize{ 64 };
+  constexpr static uint32_t NoSlot{ std::numeric_limits<uint32_t>::max() };
+
+  struct Slot
+  {
+    uint32_t generation_{};
+    uint32_t references_{};
+    uint32_t nextFree_{ NoSlot };
+  };
+
+  std::vector<Slot> slots_;
+  std::vector<Context*> contexts_;
+  std::vector<std::unique_ptr<std::byte[]>> chunks_;
+  uint32_t freeSlot_{ NoSlot };
+  bool destroying_{};
+
+  ContextPool() noexcept = default;
+  ContextPool(const ContextPool&) noexcept = delete;
+  ContextPool(ContextPool&&) noexcept = delete;
+  ~ContextPool() noexcept;
+
+  ContextPool& operator=(const ContextPool&) noexcept = delete;
+  ContextPool& operator=(ContextPool&&) noexcept = delete;
+
+  [[nodiscard]] ContextPtr create() noexcept;
+
+  [[nodiscard]] static bool isLiveGeneration(uint32_t generation) noexcept { return 0 != (generation & 1); }
+  [[nodiscard]] bool live(uint32_t index, uint32_t generation) const noexcept { return (index < slots_.size()) && (isLiveGeneration(generation)) && (slots_[index].generation_ == generation); }
+
+  [[nodiscard]] Context& at(uint32_t index, [[maybe_unused]] uint32_t generation) noexcept { assert(live(index, generation)); return *contexts_[index]; }
+  [[nodiscard]] const Context& at(uint32_t index, [[maybe_unused]] uint32_t generation) const noexcept { assert(live(index, generation)); return *contexts_[index]; }
+
+  void addReference(uint32_t index) noexcept { ++slots_[index].references_; }
+  void release(uint32_t index) noexcept
+  {
+    if (destroying_)
+      return;
+    assert(slots_[index].references_ > 0);
+    if (0 == --slots_[index].references_)
+      destroy(index);
+  }
+
+protected:
+  void destroy(uint32_t index) noexcept;
+};
+
+//-----------------------------------------------------------------------------
+template <typename TContext>
+inline ContextHandle<TContext>::ContextHandle(ContextPool& pool, uint32_t index, uint32_t generation) noexcept :
+  ContextHandle(&pool, index, generation)
+{
+}
+
+//-----------------------------------------------------------------------------
+template <typename TContext>
+inline ContextHandle<TContext>::ContextHandle(ContextPool* pool, uint32_t index, uint32_t generation) noexcept :
+  pool_{ pool },
+  index_{ index },
+  generation_{ generation }
+{
+  if (!pool_)
+    return;
+  assert(pool_->live(index_, generation_));
+  pool_->addReference(index_);
+}
+
+//-----------------------------------------------------------------------------
+template <typename TContext>
+inline void ContextHandle<TContext>::reset() noexcept
+{
+  if (!pool_)
+    return;
+  auto pool{ pool_ };
+  pool_ = {};
+  pool->release(index_);
+}
+
+//-----------------------------------------------------------------------------
+template <typename TContext>
+inline TContext* ContextHandle<TContext>::get() const noexcept
+{
+  if (!pool_)
+    return nullptr;
+  return &(pool_->at(index_, generation_));
+}
+
+} // namespace zax
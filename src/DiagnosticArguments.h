@@ -0,0 +1,78 @@
+#pragma once
+
+#include "types.h"
+
+namespace zax
+{
+
+// The named values substituted into the $name$ placeholders of a message.
+// Messages have a placeholder or two so the entries live inline and a
+// diagnostic only reaches the heap for values too long for the strings
+// themselves; a directive naming more than fit moves them all to a vector.
+struct DiagnosticArguments
+{
+  using Entry = std::pair<String, String>;
+
+  constexpr static size_t InlineCapacity{ 2 };
+
+  std::array<Entry, InlineCapacity> inline_;
+  std::vector<Entry> spilled_;
+  size_t total_{};
+
+  DiagnosticArguments() noexcept = default;
+  DiagnosticArguments(std::initializer_list<Entry> entries) noexcept
+  {
+    for (auto& entry : entries)
+      (*this)[entry.first] = entry.second;
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return total_; }
+  [[nodiscard]] bool empty() const noexcept { return 0 == total_; }
+
+  [[nodiscard]] Entry* begin() noexcept { return spilled_.empty() ? inline_.data() : spilled_.data(); }
+  [[nodiscard]] Entry* end() noexcept { return begin() + total_; }
+  [[nodiscard]] const Entry* begin() const noexcept { return spilled_.empty() ? inline_.data() : spilled_.data(); }
+  [[nodiscard]] const Entry* end() const noexcept { return begin() + total_; }
+
+  [[nodiscard]] Entry* find(StringView name) noexcept
+  {
+    auto found{ std::find_if(begin(), end(), [&](const Entry& entry) noexcept { return entry.first == name; }) };
+    return end() == found ? nullptr : found;
+  }
+  [[nodiscard]] const Entry* find(StringView name) const noexcept
+  {
+    auto found{ std::find_if(begin(), end(), [&](const Entry& entry) noexcept { return entry.first == name; }) };
+    return end() == found ? nullptr : found;
+  }
+
+  String& operator[](StringView name) noexcept
+  {
+    if (auto found{ find(name) }; found)
+      return found->second;
+
+    if ((spilled_.empty()) && (total_ < InlineCapacity)) {
+      inline_[total_].first = name;
+      return inline_[total_++].second;
+    }
+    if (spilled_.empty())
+      spilled_.assign(std::make_move_iterator(inline_.begin()), std::make_move_iterator(inline_.end()));
+    spilled_.emplace_back(String{ name }, String{});
+    ++total_;
+    return spilled_.back().second;
+  }
+
+  // the order the arguments were given in never matters
+  [[nodiscard]] bool operator==(const DiagnosticArguments& rhs) const noexcept
+  {
+    if (total_ != rhs.total_)
+      return false;
+    for (auto& [name, value] : *this) {
+      auto found{ rhs.find(name) };
+      if ((!found) || (found->second != value))
+        return false;
+    }
+    return true;
+  }
+};
+
+} // namespace zax
@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "DiagnosticSink.h"
+
+using namespace zax;
+
+//-----------------------------------------------------------------------------
+DiagnosticSink::~DiagnosticSink() noexcept
+{
+  stop_.store(true, std::memory_order_release);
+  wake_.fetch_add(1, std::memory_order_release);
+  wake_.notify_one();
+
+  if (writer_.joinable())
+    writer_.join();
+  drain();
+}
+
+//-----------------------------------------------------------------------------
+void DiagnosticSink::write(String&& text) noexcept
+{
+  auto message{ new Message{ std::move(text) } };
+  message->next_ = head_.load(std::memory_order_relaxed);
+  while (!head_.compare_exchange_weak(message->next_, message, std::memory_order_release, std::memory_order_relaxed))
+    ;
+  queued_.fetch_add(1, std::memory_order_release);
+
+  start();
+  if (!threaded_.load(std::memory_order_acquire)) {
+    drain();
+    return;
+  }
+
+  wake_.fetch_add(1, std::memory_order_release);
+  wake_.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+void DiagnosticSink::flush() noexcept
+{
+  auto target{ queued_.load(std::memory_order_acquire) };
+  if (!threaded_.load(std::memory_order_acquire)) {
+    drain();
+    return;
+  }
+
+  for (auto written{ written_.load(std::memory_order_acquire) }; written < target; written = written_.load(std::memory_order_acquire))
+    written_.wait(written, std::memory_order_acquire);
+}
+
+//-----------------------------------------------------------------------------
+void DiagnosticSink::start() noexcept
+{
+  std::call_once(started_, [&]() noexcept {
+    try {
+      writer_ = std::thread{ [this]() noexcept { run(); } };
+      threaded_.store(true, std::memory_order_release);
+    }
+    catch (const std::system_error&) {
+      // every write drains on the calling thread instead
+    }
+  });
+}
+
+//-----------------------------------------------------------------------------
+void DiagnosticSink::run() noexcept
+{
+  while (true) {
+    auto seen{ wake_.load(std::memory_order_acquire) };
+    drain();
+    if (stop_.load(std::memory_order_acquire))
+      return;
+    wake_.wait(seen, std::memory_order_acquire);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void DiagnosticSink::drain() noexcept
+{
+  std::scoped_lock lock{ drainMutex_ };
+
+  auto taken{ head_.exchange(nullptr, std::memory_order_acquire) };
+  if (!taken)
+    return;
+
+  // the list is newest first so reverse it back into production order
+  Message* ordered{};
+  while (taken) {
+    auto next{ taken->next_ };
+    taken->next_ = ordered;
+    ordered = taken;
+    taken = next;
+  }
+
+  uint64_t count{};
+  buffer_.clear();
+  while (ordered) {
+    std::unique_ptr<Message> message{ ordered };
+    ordered = message->next_;
+    buffer_ += message->text_;
+    ++count;
+  }
+
+  stream_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  stream_.flush();
+
+  written_.fetch_add(count, std::memory_order_release);
+  written_.notify_all();
+}
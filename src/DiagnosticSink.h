@@ -0,0 +1,52 @@
+#pragma once
+
+#include "types.h"
+
+namespace zax
+{
+
+// Collects diagnostic text from any thread and writes it to a stream from a
+// single writer thread in large batches. Producers never block: a message is
+// pushed onto a lock free list which the writer takes whole and writes in
+// the order each thread produced it.
+struct DiagnosticSink
+{
+  struct Message
+  {
+    String text_;
+    Message* next_{};
+  };
+
+  std::ostream& stream_;
+
+  std::atomic<Message*> head_{};
+  std::atomic<uint32_t> wake_{};
+  std::atomic<uint64_t> queued_{};
+  std::atomic<uint64_t> written_{};
+  std::atomic<bool> stop_{};
+
+  std::once_flag started_;
+  std::atomic<bool> threaded_{};
+  std::thread writer_;
+
+  std::mutex drainMutex_;
+  String buffer_;
+
+  DiagnosticSink(std::ostream& stream) noexcept : stream_{ stream } {}
+  DiagnosticSink(const DiagnosticSink&) noexcept = delete;
+  DiagnosticSink(DiagnosticSink&&) noexcept = delete;
+  ~DiagnosticSink() noexcept;
+
+  DiagnosticSink& operator=(const DiagnosticSink&) noexcept = delete;
+  DiagnosticSink& operator=(DiagnosticSink&&) noexcept = delete;
+
+  void write(String&& text) noexcept;
+  void flush() noexcept;
+
+protected:
+  void start() noexcept;
+  void run() noexcept;
+  void drain() noexcept;
+};
+
+} // namespace zax
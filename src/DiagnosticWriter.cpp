@@ -0,0 +1,180 @@
+#include "pch.h"
+#include "DiagnosticWriter.h"
+#include "version.h"
+
+using namespace zax;
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+void appendQuoted(String& output, StringView value) noexcept
+{
+  constexpr StringView hex{ "0123456789abcdef" };
+
+  output += '"';
+  for (auto ch : value) {
+    switch (ch) {
+      case '"':   output += "\\\""; break;
+      case '\\':  output += "\\\\"; break;
+      case '\n':  output += "\\n"; break;
+      case '\r':  output += "\\r"; break;
+      case '\t':  output += "\\t"; break;
+      default: {
+        if (static_cast<unsigned char>(ch) < 0x20) {
+          output += "\\u00";
+          output += hex[(ch >> 4) & 0xF];
+          output += hex[ch & 0xF];
+          break;
+        }
+        output += ch;
+        break;
+      }
+    }
+  }
+  output += '"';
+}
+
+//-----------------------------------------------------------------------------
+void appendParameters(String& output, const DiagnosticArguments* arguments) noexcept
+{
+  output += '{';
+  if (arguments) {
+    bool first{ true };
+    for (auto& [name, value] : *arguments) {
+      if (!first)
+        output += ',';
+      first = false;
+
+      // placeholders are spelled $name$ in the templates
+      StringView key{ name };
+      if ((key.size() > 1) && ('$' == key.front()) && ('$' == key.back()))
+        key = key.substr(1, key.size() - 2);
+      appendQuoted(output, key);
+      output += ':';
+      appendQuoted(output, value);
+    }
+  }
+  output += '}';
+}
+
+//-----------------------------------------------------------------------------
+void appendLocation(String& output, StringView fileName, int line, int column) noexcept
+{
+  output += "{\"file\":";
+  appendQuoted(output, fileName);
+  output += ",\"line\":";
+  output += std::to_string(line);
+  output += ",\"column\":";
+  output += std::to_string(column);
+  output += '}';
+}
+
+//-----------------------------------------------------------------------------
+void appendSarifLocation(String& output, StringView fileName, int line, int column) noexcept
+{
+  output += "{\"physicalLocation\":{\"artifactLocation\":{\"uri\":";
+  appendQuoted(output, fileName);
+  output += "},\"region\":{\"startLine\":";
+  output += std::to_string(std::max(line, 1));
+  output += ",\"startColumn\":";
+  output += std::to_string(std::max(column, 1));
+  output += "}}}";
+}
+
+//-----------------------------------------------------------------------------
+StringView sarifLevel(CompilerException::ErrorType type) noexcept
+{
+  switch (type) {
+    case CompilerException::ErrorType::Informational:   return "note";
+    case CompilerException::ErrorType::Warning:         return "warning";
+    case CompilerException::ErrorType::Error:
+    case CompilerException::ErrorType::Fatal:           break;
+  }
+  return "error";
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+String DiagnosticWriter::header() const noexcept
+{
+  if (Format::Sarif != format_)
+    return {};
+
+  String output;
+  output += "{\"version\":\"2.1.0\",\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\",\"runs\":[{\"tool\":{\"driver\":{\"name\":";
+  appendQuoted(output, Version::name());
+  output += ",\"version\":";
+  appendQuoted(output, Version::version());
+  output += "}},\"results\":[\n";
+  return output;
+}
+
+//-----------------------------------------------------------------------------
+String DiagnosticWriter::footer() const noexcept
+{
+  if (Format::Sarif != format_)
+    return {};
+  return "]}]}\n";
+}
+
+//-----------------------------------------------------------------------------
+String DiagnosticWriter::record(const Diagnostic& diagnostic) const noexcept
+{
+  String message{ diagnostic.text_ };
+  if (diagnostic.message_)
+    diagnostic.message_->render(message, diagnostic.arguments_ ? *diagnostic.arguments_ : DiagnosticArguments{});
+
+  String output;
+  output.reserve(256 + message.size());
+
+  if (Format::Sarif == format_) {
+    output += '{';
+    if (!diagnostic.iana_.empty()) {
+      output += "\"ruleId\":";
+      appendQuoted(output, diagnostic.iana_);
+      output += ',';
+    }
+    output += "\"level\":";
+    appendQuoted(output, sarifLevel(diagnostic.type_));
+    output += ",\"message\":{\"text\":";
+    appendQuoted(output, message);
+    output += '}';
+    // a problem with the compile itself has no location to report
+    if (!diagnostic.fileName_.empty()) {
+      output += ",\"locations\":[";
+      appendSarifLocation(output, diagnostic.fileName_, diagnostic.line_, diagnostic.column_);
+      output += ']';
+    }
+    if (diagnostic.actualOrigin_) {
+      output += ",\"relatedLocations\":[";
+      appendSarifLocation(output, diagnostic.actualFileName_, diagnostic.actualLine_, diagnostic.actualColumn_);
+      output.pop_back();
+      output += ",\"message\":{\"text\":\"origin\"}}]";
+    }
+    output += ",\"properties\":{\"severity\":";
+    appendQuoted(output, CompilerException::ErrorTypeTraits::toString(diagnostic.type_));
+    output += ",\"parameters\":";
+    appendParameters(output, diagnostic.arguments_);
+    output += "}}\n";
+    return output;
+  }
+
+  output += "{\"severity\":";
+  appendQuoted(output, CompilerException::ErrorTypeTraits::toString(diagnostic.type_));
+  output += ",\"code\":";
+  appendQuoted(output, diagnostic.iana_);
+  output += ",\"message\":";
+  appendQuoted(output, message);
+  output += ",\"origin\":";
+  appendLocation(output, diagnostic.fileName_, diagnostic.line_, diagnostic.column_);
+  if (diagnostic.actualOrigin_) {
+    output += ",\"actualOrigin\":";
+    appendLocation(output, diagnostic.actualFileName_, diagnostic.actualLine_, diagnostic.actualColumn_);
+  }
+  output += ",\"parameters\":";
+  appendParameters(output, diagnostic.arguments_);
+  output += "}\n";
+  return output;
+}
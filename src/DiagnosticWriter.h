@@ -0,0 +1,56 @@
+#pragma once
+
+#include "types.h"
+#include "Config.h"
+#include "CompilerException.h"
+
+namespace zax
+{
+
+// Streams diagnostics as machine readable records, one at a time, as they
+// are emitted. JSON Lines writes a self contained object per line; SARIF
+// writes its envelope once around a results array that grows as diagnostics
+// arrive so no document is ever held in memory.
+struct DiagnosticWriter
+{
+  using Format = Config::DiagnosticsFormat;
+
+  const Format format_;
+
+  std::mutex mutex_;
+  bool first_{ true };
+
+  DiagnosticWriter(Format format) noexcept : format_{ format } {}
+  DiagnosticWriter(const DiagnosticWriter&) noexcept = delete;
+  DiagnosticWriter(DiagnosticWriter&&) noexcept = delete;
+
+  DiagnosticWriter& operator=(const DiagnosticWriter&) noexcept = delete;
+  DiagnosticWriter& operator=(DiagnosticWriter&&) noexcept = delete;
+
+  [[nodiscard]] String header() const noexcept;
+  [[nodiscard]] String footer() const noexcept;
+  [[nodiscard]] String record(const Diagnostic& diagnostic) const noexcept;
+
+  template <typename TWrite>
+  void write(const Diagnostic& diagnostic, TWrite&& write) noexcept
+  {
+    // the actual origin is already part of the record it follows
+    if (diagnostic.continuation_)
+      return;
+
+    auto text{ record(diagnostic) };
+    if (Format::Sarif != format_) {
+      write(std::move(text));
+      return;
+    }
+
+    // separators must reach the output in the same order as the records
+    std::scoped_lock lock{ mutex_ };
+    if (!first_)
+      text.insert(text.begin(), ',');
+    first_ = false;
+    write(std::move(text));
+  }
+};
+
+} // namespace zax
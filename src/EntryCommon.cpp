@@ -11,7 +11,7 @@ Context* EntryCommon::context() noexcept
 {
   if (!context_)
     return {};
-  context_->alive_();
+  context_->alive();
   return context_;
 }
 
@@ -20,7 +20,7 @@ const Context* EntryCommon::context() const noexcept
 {
   if (!context_)
     return {};
-  context_->alive_();
+  context_->alive();
   return context_;
 }
 
@@ -29,8 +29,8 @@ ContextPtr EntryCommon::contextPtr() noexcept
 {
   if (!context_)
     return {};
-  context_->alive_();
-  return context_->thisWeak_.lock();
+  context_->alive();
+  return context_->handle();
 }
 
 //-----------------------------------------------------------------------------
@@ -38,6 +38,6 @@ const ContextConstPtr EntryCommon::contextPtr() const noexcept
 {
   if (!context_)
     return {};
-  context_->alive_();
-  return context_->thisWeak_.lock();
+  context_->alive();
+  return context_->handle();
 }
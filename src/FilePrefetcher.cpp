@@ -0,0 +1,114 @@
+#include "pch.h"
+#include "FilePrefetcher.h"
+
+using namespace zax;
+
+//-----------------------------------------------------------------------------
+bool PrefetchedFile::claim() noexcept
+{
+  std::scoped_lock lock{ mutex_ };
+  if (State::Queued != state_)
+    return false;
+  state_ = State::Reading;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void PrefetchedFile::read(FilePrefetcher* reserveFrom) noexcept
+{
+  std::optional<FileStamp> stamped;
+  if (stamp_)
+    stamped = fileStamp(fileName_);
+  auto contents{ readBinaryFile(fileName_) };
+  if (reserveFrom)
+    reserveFrom->reserve(contents.second);
+
+  std::scoped_lock lock{ mutex_ };
+  contents_ = std::move(contents);
+  stamped_ = stamped;
+  reservedBy_ = reserveFrom;
+  state_ = State::Done;
+  done_.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+PrefetchedFile::Contents PrefetchedFile::take() noexcept
+{
+  if (claim())
+    read();
+
+  std::unique_lock lock{ mutex_ };
+  done_.wait(lock, [&]() noexcept { return State::Done == state_; });
+  if (auto reservedBy{ std::exchange(reservedBy_, nullptr) }; reservedBy)
+    reservedBy->release(contents_.second);
+  return std::move(contents_);
+}
+
+//-----------------------------------------------------------------------------
+FilePrefetcher::~FilePrefetcher() noexcept
+{
+  {
+    std::scoped_lock lock{ mutex_ };
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_)
+    thread.join();
+}
+
+//-----------------------------------------------------------------------------
+PrefetchedFilePtr FilePrefetcher::prefetch(StringView fileName, bool stamp) noexcept
+{
+  auto result{ std::make_shared<PrefetchedFile>(fileName, stamp) };
+
+  {
+    std::scoped_lock lock{ mutex_ };
+    queue_.push_back(result);
+
+    if (threads_.size() < std::min(MaxThreads, queue_.size())) {
+      try {
+        threads_.emplace_back([this]() noexcept { run(); });
+      }
+      catch (const std::system_error&) {
+        // reads fall back to whoever takes the file
+      }
+    }
+  }
+  wake_.notify_one();
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+void FilePrefetcher::reserve(size_t bytes) noexcept
+{
+  std::scoped_lock lock{ mutex_ };
+  bytesInFlight_ += bytes;
+}
+
+//-----------------------------------------------------------------------------
+void FilePrefetcher::release(size_t bytes) noexcept
+{
+  {
+    std::scoped_lock lock{ mutex_ };
+    bytesInFlight_ -= bytes;
+  }
+  wake_.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+void FilePrefetcher::run() noexcept
+{
+  while (true) {
+    PrefetchedFilePtr file;
+    {
+      std::unique_lock lock{ mutex_ };
+      wake_.wait(lock, [&]() noexcept { return stop_ || ((!queue_.empty()) && (bytesInFlight_ < MaxBytesInFlight)); });
+      if (stop_)
+        return;
+      file = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    if (file->claim())
+      file->read(this);
+  }
+}
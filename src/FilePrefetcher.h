@@ -0,0 +1,75 @@
+#pragma once
+
+#include "types.h"
+#include "helpers.h"
+
+namespace zax
+{
+
+struct FilePrefetcher;
+
+// A file read requested ahead of time. Whoever takes the contents first
+// either receives the bytes a worker already read or, when no worker has
+// picked the read up yet, performs the read on the calling thread.
+struct PrefetchedFile
+{
+  using Contents = std::pair<std::unique_ptr<std::byte[]>, size_t>;
+
+  enum class State
+  {
+    Queued,
+    Reading,
+    Done
+  };
+
+  const String fileName_;
+  const bool stamp_{};
+
+  std::mutex mutex_;
+  std::condition_variable done_;
+  State state_{ State::Queued };
+  Contents contents_;
+  std::optional<FileStamp> stamped_;
+  FilePrefetcher* reservedBy_{};
+
+  PrefetchedFile(StringView fileName, bool stamp) noexcept : fileName_{ fileName }, stamp_{ stamp } {}
+
+  [[nodiscard]] bool claim() noexcept;
+  void read(FilePrefetcher* reserveFrom = nullptr) noexcept;
+  [[nodiscard]] Contents take() noexcept;
+};
+
+// A small pool of reader threads shared by one parser. Threads are started
+// lazily and when none can be started every read simply happens on the
+// thread that takes the file. Reads stop being picked up while the bytes
+// read but not yet taken exceed a bound.
+struct FilePrefetcher
+{
+  constexpr static size_t MaxThreads{ 4 };
+  constexpr static size_t MaxBytesInFlight{ 64 * 1024 * 1024 };
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<PrefetchedFilePtr> queue_;
+  std::vector<std::thread> threads_;
+  size_t bytesInFlight_{};
+  bool stop_{};
+
+  FilePrefetcher() noexcept = default;
+  FilePrefetcher(const FilePrefetcher&) noexcept = delete;
+  FilePrefetcher(FilePrefetcher&&) noexcept = delete;
+  ~FilePrefetcher() noexcept;
+
+  FilePrefetcher& operator=(const FilePrefetcher&) noexcept = delete;
+  FilePrefetcher& operator=(FilePrefetcher&&) noexcept = delete;
+
+  [[nodiscard]] PrefetchedFilePtr prefetch(StringView fileName, bool stamp) noexcept;
+
+  void reserve(size_t bytes) noexcept;
+  void release(size_t bytes) noexcept;
+
+protected:
+  void run() noexcept;
+};
+
+} // namespace zax
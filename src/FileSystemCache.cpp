@@ -0,0 +1,111 @@
+#include "pch.h"
+#include "FileSystemCache.h"
+
+using namespace zax;
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+template <typename TValue, typename TFunction>
+const FileSystemCache::Result<TValue>& memoize(
+  std::unordered_map<String, FileSystemCache::Result<TValue>>& cache,
+  String&& key,
+  std::error_code& ec,
+  TFunction&& function) noexcept
+{
+  auto found{ cache.find(key) };
+  if (found == cache.end()) {
+    FileSystemCache::Result<TValue> result;
+    result.value_ = function(result.ec_);
+    found = cache.emplace(std::move(key), std::move(result)).first;
+  }
+  ec = found->second.ec_;
+  return found->second;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+Path FileSystemCache::currentPath(std::error_code& ec) noexcept
+{
+  if (!currentPath_) {
+    currentPath_.emplace();
+    currentPath_->value_ = std::filesystem::current_path(currentPath_->ec_);
+  }
+  ec = currentPath_->ec_;
+  return currentPath_->value_;
+}
+
+//-----------------------------------------------------------------------------
+Path FileSystemCache::absolute(const Path& path, std::error_code& ec) noexcept
+{
+  return memoize(absolute_, path.string(), ec, [&](std::error_code& resultEc) noexcept {
+    return std::filesystem::absolute(path, resultEc);
+  }).value_;
+}
+
+//-----------------------------------------------------------------------------
+Path FileSystemCache::proximate(const Path& path, const Path& base, std::error_code& ec) noexcept
+{
+  String key{ path.string() };
+  key += '\0';
+  key += base.string();
+  return memoize(proximate_, std::move(key), ec, [&](std::error_code& resultEc) noexcept {
+    return std::filesystem::proximate(path, base, resultEc);
+  }).value_;
+}
+
+//-----------------------------------------------------------------------------
+bool FileSystemCache::isRegularFile(const Path& path, std::error_code& ec) noexcept
+{
+  return memoize(regularFiles_, path.string(), ec, [&](std::error_code& resultEc) noexcept {
+    probedFiles_.insert(path.string());
+    return std::filesystem::is_regular_file(path, resultEc);
+  }).value_;
+}
+
+//-----------------------------------------------------------------------------
+const std::vector<Path>& FileSystemCache::directory(const Path& path, std::error_code& ec) noexcept
+{
+  return memoize(directories_, path.string(), ec, [&](std::error_code& resultEc) noexcept {
+    listedDirectories_.insert(path.string());
+    std::vector<Path> entries;
+    for (auto& entry : std::filesystem::directory_iterator(path, resultEc))
+      entries.push_back(entry.path());
+    return entries;
+  }).value_;
+}
+
+//-----------------------------------------------------------------------------
+std::optional<FileIdentity> FileSystemCache::identity(const StringView fileName) noexcept
+{
+  String key{ fileName };
+  if (auto found{ identities_.find(key) }; found != identities_.end())
+    return found->second;
+  auto result{ fileIdentity(fileName) };
+  identities_.emplace(std::move(key), result);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+void FileSystemCache::invalidate() noexcept
+{
+  currentPath_.reset();
+  absolute_.clear();
+  proximate_.clear();
+  regularFiles_.clear();
+  directories_.clear();
+  identities_.clear();
+}
+
+//-----------------------------------------------------------------------------
+void FileSystemCache::invalidate(const Path& path) noexcept
+{
+  // path computations do not depend on the file itself so only the stat
+  // results of the path and the listing of its parent are dropped
+  regularFiles_.erase(path.string());
+  identities_.erase(path.string());
+  directories_.erase(path.string());
+  directories_.erase(path.parent_path().string());
+}
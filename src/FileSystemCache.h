@@ -0,0 +1,52 @@
+#pragma once
+
+#include "types.h"
+#include "helpers.h"
+
+namespace zax
+{
+
+// Memoizes the filesystem queries made while resolving include and asset
+// paths for the lifetime of one parser. The cache is not thread safe; each
+// parser owns its own. Anything that changes the filesystem underneath a
+// long lived parser must call invalidate().
+struct FileSystemCache
+{
+  template <typename TValue>
+  struct Result
+  {
+    TValue value_{};
+    std::error_code ec_;
+  };
+
+  std::optional<Result<Path>> currentPath_;
+  std::unordered_map<String, Result<Path>> absolute_;
+  std::unordered_map<String, Result<Path>> proximate_;
+  std::unordered_map<String, Result<bool>> regularFiles_;
+  std::unordered_map<String, Result<std::vector<Path>>> directories_;
+  std::unordered_map<String, std::optional<FileIdentity>> identities_;
+
+  // every path tested and directory listed; kept through invalidation so
+  // the inputs of a run can be reported once it is done
+  std::set<String> probedFiles_;
+  std::set<String> listedDirectories_;
+
+  FileSystemCache() noexcept = default;
+  FileSystemCache(const FileSystemCache&) noexcept = delete;
+  FileSystemCache(FileSystemCache&&) noexcept = delete;
+
+  FileSystemCache& operator=(const FileSystemCache&) noexcept = delete;
+  FileSystemCache& operator=(FileSystemCache&&) noexcept = delete;
+
+  [[nodiscard]] Path currentPath(std::error_code& ec) noexcept;
+  [[nodiscard]] Path absolute(const Path& path, std::error_code& ec) noexcept;
+  [[nodiscard]] Path proximate(const Path& path, const Path& base, std::error_code& ec) noexcept;
+  [[nodiscard]] bool isRegularFile(const Path& path, std::error_code& ec) noexcept;
+  [[nodiscard]] const std::vector<Path>& directory(const Path& path, std::error_code& ec) noexcept;
+  [[nodiscard]] std::optional<FileIdentity> identity(const StringView fileName) noexcept;
+
+  void invalidate() noexcept;
+  void invalidate(const Path& path) noexcept;
+};
+
+} // namespace zax
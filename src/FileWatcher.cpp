@@ -0,0 +1,150 @@
+#include "pch.h"
+#include "FileWatcher.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif //_WIN32
+
+using namespace zax;
+
+//-----------------------------------------------------------------------------
+FileWatcher::FileWatcher(std::chrono::milliseconds debounce) noexcept :
+  debounce_{ debounce }
+{
+#ifndef _WIN32
+  descriptor_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif //_WIN32
+}
+
+//-----------------------------------------------------------------------------
+FileWatcher::~FileWatcher() noexcept
+{
+#ifndef _WIN32
+  if (descriptor_ >= 0)
+    ::close(descriptor_);
+#endif //_WIN32
+}
+
+//-----------------------------------------------------------------------------
+bool FileWatcher::watch(const FileSet& filePaths) noexcept
+{
+#ifdef _WIN32
+  (void)filePaths;
+  return false;
+#else //_WIN32
+  if (descriptor_ < 0)
+    return false;
+
+  files_.clear();
+  std::set<Path> needed;
+  for (auto& filePath : filePaths) {
+    std::error_code ec;
+    auto normalized{ std::filesystem::absolute(Path{ filePath }, ec).lexically_normal() };
+    if (ec)
+      continue;
+    files_.emplace(normalized, filePath);
+    needed.insert(normalized.parent_path());
+  }
+
+  for (auto iter{ directories_.begin() }; directories_.end() != iter; ) {
+    if (needed.erase(iter->second) > 0) {
+      ++iter;
+      continue;
+    }
+    (void)::inotify_rm_watch(descriptor_, iter->first);
+    iter = directories_.erase(iter);
+  }
+
+  constexpr uint32_t mask{ IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ATTRIB };
+
+  bool result{ true };
+  for (auto& directory : needed) {
+    auto watchDescriptor{ ::inotify_add_watch(descriptor_, directory.c_str(), mask) };
+    if (watchDescriptor < 0) {
+      result = false;
+      continue;
+    }
+    directories_[watchDescriptor] = directory;
+  }
+  return result;
+#endif //_WIN32
+}
+
+//-----------------------------------------------------------------------------
+FileWatcher::FileSet FileWatcher::wait(std::optional<std::chrono::milliseconds> timeout) noexcept
+{
+  using Clock = std::chrono::steady_clock;
+
+  FileSet changed;
+  if (descriptor_ < 0)
+    return changed;
+
+  std::optional<Clock::time_point> deadline;
+  if (timeout)
+    deadline = Clock::now() + *timeout;
+
+  while (changed.empty()) {
+    int milliseconds{ -1 };
+    if (deadline) {
+      auto remaining{ std::chrono::duration_cast<std::chrono::milliseconds>(*deadline - Clock::now()).count() };
+      if (remaining <= 0)
+        return changed;
+      milliseconds = static_cast<int>(remaining);
+    }
+    (void)read(changed, milliseconds);
+  }
+
+  // an editor save is usually several events so wait for them to settle
+  while (read(changed, static_cast<int>(debounce_.count()))) {
+  }
+  return changed;
+}
+
+//-----------------------------------------------------------------------------
+bool FileWatcher::read(FileSet& changed, int timeout) noexcept
+{
+#ifdef _WIN32
+  (void)changed;
+  (void)timeout;
+  return false;
+#else //_WIN32
+  pollfd poller{ .fd = descriptor_, .events = POLLIN };
+  if (::poll(&poller, 1, timeout) <= 0)
+    return false;
+
+  bool result{};
+  alignas(inotify_event) char buffer[16 * 1024];
+  while (true) {
+    auto length{ ::read(descriptor_, buffer, sizeof(buffer)) };
+    if (length <= 0)
+      break;
+
+    for (decltype(length) offset{}; offset < length; ) {
+      auto event{ reinterpret_cast<const inotify_event*>(buffer + offset) };
+      offset += static_cast<decltype(length)>(sizeof(inotify_event) + event->len);
+
+      // events were lost so anything may have changed
+      if (0 != (event->mask & IN_Q_OVERFLOW)) {
+        for (auto& [normalized, filePath] : files_)
+          changed.insert(filePath);
+        result = true;
+        continue;
+      }
+
+      auto directory{ directories_.find(event->wd) };
+      if ((directories_.end() == directory) || (event->len < 1))
+        continue;
+
+      auto found{ files_.find(directory->second / event->name) };
+      if (files_.end() == found)
+        continue;
+
+      changed.insert(found->second);
+      result = true;
+    }
+  }
+  return result;
+#endif //_WIN32
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "types.h"
+
+namespace zax
+{
+
+// Reports changes to a set of files through inotify. The directories that
+// hold the files are watched rather than the files themselves since editors
+// often save by renaming a new file over the old one, which would orphan a
+// watch on the file. A burst of events is coalesced until the directories
+// have stayed quiet for the debounce interval.
+struct FileWatcher
+{
+  using FileSet = std::set<String>;
+
+  constexpr static std::chrono::milliseconds DefaultDebounce{ 100 };
+
+  const std::chrono::milliseconds debounce_;
+  int descriptor_{ -1 };
+  std::unordered_map<int, Path> directories_;   // watch descriptor -> directory
+  std::map<Path, String> files_;                // normalized path -> path as watched
+
+  FileWatcher(std::chrono::milliseconds debounce = DefaultDebounce) noexcept;
+  ~FileWatcher() noexcept;
+
+  FileWatcher(const FileWatcher&) noexcept = delete;
+  FileWatcher(FileWatcher&&) noexcept = delete;
+
+  FileWatcher& operator=(const FileWatcher&) noexcept = delete;
+  FileWatcher& operator=(FileWatcher&&) noexcept = delete;
+
+  [[nodiscard]] bool available() const noexcept { return descriptor_ >= 0; }
+  [[nodiscard]] bool watch(const FileSet& filePaths) noexcept;
+  [[nodiscard]] FileSet wait(std::optional<std::chrono::milliseconds> timeout = {}) noexcept;
+
+protected:
+  [[nodiscard]] bool read(FileSet& changed, int timeout) noexcept;
+};
+
+} // namespace zax
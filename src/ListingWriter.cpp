@@ -0,0 +1,133 @@
+#include "pch.h"
+#include "ListingWriter.h"
+#include "Source.h"
+#include "Token.h"
+#include "Tokenizer.h"
+#include "version.h"
+
+#include <charconv>
+
+using namespace zax;
+using namespace std::string_view_literals;
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+void appendLineNumber(BufferedOutput& output, int line) noexcept
+{
+  constexpr size_t width{ 7 };
+
+  std::array<char, 16> digits{};
+  auto [end, ec] { std::to_chars(digits.data(), digits.data() + digits.size(), line) };
+  size_t length{ static_cast<size_t>(end - digits.data()) };
+  for (auto pad{ length }; pad < width; ++pad)
+    output.append(' ');
+  output.append(StringView{ digits.data(), length });
+  output.append("  "sv);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+ListingWriter::ListingWriter(String filePath) noexcept :
+  output_{ std::move(filePath) }
+{
+  output_.append("; "sv);
+  output_.append(Version::name());
+  output_.append(' ');
+  output_.append(Version::version());
+  output_.append(" listing\n"sv);
+}
+
+//-----------------------------------------------------------------------------
+void ListingWriter::enter(const Source& source) noexcept
+{
+  if (&source == current_)
+    return;
+  current_ = &source;
+
+  auto found{ positions_.find(&source) };
+  if (positions_.end() != found) {
+    output_.append("; resume "sv);
+    output_.append(found->second.filePath_);
+    output_.append('\n');
+    return;
+  }
+
+  Position position;
+  position.order_ = entered_++;
+  if (source.tokenizer_) {
+    position.data_ = reinterpret_cast<const char*>(source.tokenizer_->rawContents_.first.get());
+    position.size_ = position.data_ ? source.tokenizer_->rawContents_.second : 0;
+  }
+  if (source.effectivePath_)
+    position.filePath_ = source.effectivePath_->filePath_;
+
+  output_.append("; source "sv);
+  output_.append(position.filePath_);
+  output_.append('\n');
+  positions_.emplace(&source, std::move(position));
+}
+
+//-----------------------------------------------------------------------------
+void ListingWriter::leave(const Source& source) noexcept
+{
+  auto found{ positions_.find(&source) };
+  if (positions_.end() == found)
+    return;
+
+  lines(found->second, std::numeric_limits<int>::max());
+  positions_.erase(found);
+  if (&source == current_)
+    current_ = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+void ListingWriter::note(const Token& at, StringView kind, StringView text) noexcept
+{
+  if (auto found{ positions_.find(current_) }; positions_.end() != found)
+    lines(found->second, at.actualOrigin_.location_.line_);
+
+  output_.append("         ; "sv);
+  output_.append(kind);
+  output_.append(' ');
+  output_.append(text);
+  output_.append('\n');
+}
+
+//-----------------------------------------------------------------------------
+bool ListingWriter::close() noexcept
+{
+  // whatever was left unfinished is written in the order it was entered
+  std::vector<Position*> remaining;
+  remaining.reserve(positions_.size());
+  for (auto& [source, position] : positions_)
+    remaining.push_back(&position);
+  std::sort(remaining.begin(), remaining.end(), [](const Position* lhs, const Position* rhs) noexcept { return lhs->order_ < rhs->order_; });
+  for (auto position : remaining)
+    lines(*position, std::numeric_limits<int>::max());
+  positions_.clear();
+  current_ = nullptr;
+  return output_.close();
+}
+
+//-----------------------------------------------------------------------------
+void ListingWriter::lines(Position& position, int through) noexcept
+{
+  while ((position.line_ <= through) && (position.offset_ < position.size_)) {
+    auto start{ position.data_ + position.offset_ };
+    auto remaining{ position.size_ - position.offset_ };
+    auto newLine{ static_cast<const char*>(std::memchr(start, '\n', remaining)) };
+    size_t length{ newLine ? static_cast<size_t>(newLine - start) : remaining };
+    position.offset_ += length + (newLine ? 1 : 0);
+
+    StringView text{ start, length };
+    if ((!text.empty()) && ('\r' == text.back()))
+      text.remove_suffix(1);
+
+    appendLineNumber(output_, position.line_++);
+    output_.append(text);
+    output_.append('\n');
+  }
+}
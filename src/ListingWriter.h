@@ -0,0 +1,51 @@
+#pragma once
+
+#include "types.h"
+#include "BufferedOutput.h"
+
+namespace zax
+{
+
+// Streams a listing of every parsed source line interleaved with what the
+// parser made of it. Lines are sliced straight out of the loaded source
+// buffers by byte offset and only ever copied into the one output buffer,
+// so listing a huge input stays bound by I/O rather than memory.
+struct ListingWriter
+{
+  struct Position
+  {
+    const char* data_{};
+    size_t size_{};
+    size_t offset_{};
+    int line_{ 1 };
+    size_t order_{};
+    String filePath_;
+  };
+
+  using PositionMap = std::unordered_map<const Source*, Position>;
+
+  BufferedOutput output_;
+  PositionMap positions_;
+  const Source* current_{};
+  size_t entered_{};
+
+  ListingWriter(String filePath) noexcept;
+  ~ListingWriter() noexcept { (void)close(); }
+
+  ListingWriter(const ListingWriter&) noexcept = delete;
+  ListingWriter(ListingWriter&&) noexcept = delete;
+
+  ListingWriter& operator=(const ListingWriter&) noexcept = delete;
+  ListingWriter& operator=(ListingWriter&&) noexcept = delete;
+
+  void enter(const Source& source) noexcept;
+  void leave(const Source& source) noexcept;
+  void note(const Token& at, StringView kind, StringView text) noexcept;
+
+  [[nodiscard]] bool close() noexcept;
+
+protected:
+  void lines(Position& position, int through) noexcept;
+};
+
+} // namespace zax
@@ -0,0 +1,27 @@
+#include "pch.h"
+#include "MessageTemplate.h"
+
+using namespace zax;
+
+//-----------------------------------------------------------------------------
+String MessageTemplate::render(const DiagnosticArguments& arguments) const noexcept
+{
+  String output;
+  render(output, arguments);
+  return output;
+}
+
+//-----------------------------------------------------------------------------
+void MessageTemplate::render(String& output, const DiagnosticArguments& arguments) const noexcept
+{
+  for (size_t index{}; index < total_; ++index) {
+    auto& segment{ segments_[index] };
+    if (!segment.placeholder_) {
+      output += segment.text_;
+      continue;
+    }
+
+    auto found{ arguments.find(segment.text_) };
+    output += found ? StringView{ found->second } : segment.text_;
+  }
+}
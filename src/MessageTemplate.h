@@ -0,0 +1,89 @@
+#pragma once
+
+#include "types.h"
+#include "DiagnosticArguments.h"
+
+namespace zax
+{
+
+// A human readable message split at compile time into literal text and
+// $name$ placeholders so a diagnostic only pays for substitution when it is
+// actually displayed.
+struct MessageTemplate
+{
+  constexpr static size_t MaxSegments{ 8 };
+
+  struct Segment
+  {
+    StringView text_;
+    bool placeholder_{};
+  };
+
+  std::array<Segment, MaxSegments> segments_{};
+  size_t total_{};
+  bool overflow_{};
+
+  constexpr MessageTemplate() noexcept = default;
+  constexpr MessageTemplate(StringView text) noexcept
+  {
+    while (!text.empty()) {
+      auto open{ text.find('$') };
+      auto close{ StringView::npos == open ? StringView::npos : text.find('$', open + 1) };
+      if (StringView::npos == close) {
+        add(text, false);
+        break;
+      }
+      if (open > 0)
+        add(text.substr(0, open), false);
+      add(text.substr(open, close - open + 1), true);
+      text = text.substr(close + 1);
+    }
+  }
+
+  [[nodiscard]] String render(const DiagnosticArguments& arguments) const noexcept;
+  void render(String& output, const DiagnosticArguments& arguments) const noexcept;
+
+protected:
+  constexpr void add(StringView text, bool placeholder) noexcept
+  {
+    if (total_ >= MaxSegments) {
+      overflow_ = true;
+      return;
+    }
+    segments_[total_++] = Segment{ text, placeholder };
+  }
+};
+
+//-----------------------------------------------------------------------------
+template <typename TEnum, typename THumanReadableTraits>
+constexpr auto makeMessageTemplates() noexcept
+{
+  std::array<MessageTemplate, THumanReadableTraits::Total()> result{};
+  for (size_t index{}; index < result.size(); ++index)
+    result[index] = MessageTemplate{ THumanReadableTraits::toString(static_cast<TEnum>(index)) };
+  return result;
+}
+
+template <typename TEnum, typename THumanReadableTraits>
+inline constexpr auto messageTemplates{ makeMessageTemplates<TEnum, THumanReadableTraits>() };
+
+//-----------------------------------------------------------------------------
+template <typename TEnum, typename THumanReadableTraits>
+constexpr bool messageTemplatesFit() noexcept
+{
+  for (auto& entry : messageTemplates<TEnum, THumanReadableTraits>) {
+    if (entry.overflow_)
+      return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+template <typename TEnum, typename THumanReadableTraits>
+const MessageTemplate& messageTemplate(TEnum value) noexcept
+{
+  assert((THumanReadableTraits::toUnderlying(value) < messageTemplates<TEnum, THumanReadableTraits>.size()));
+  return messageTemplates<TEnum, THumanReadableTraits>[THumanReadableTraits::toUnderlying(value)];
+}
+
+} // namespace zax
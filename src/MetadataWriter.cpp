@@ -0,0 +1,524 @@
+#include "pch.h"
+#include "MetadataWriter.h"
+#include "BufferedOutput.h"
+#include "Context.h"
+#include "Parser.h"
+#include "Source.h"
+#include "Token.h"
+#include "version.h"
+
+using namespace zax;
+using namespace std::string_view_literals;
+
+//-----------------------------------------------------------------------------
+struct MetadataWriter::Encoder
+{
+  BufferedOutput output_;
+
+  Encoder(String filePath) noexcept : output_{ std::move(filePath) } {}
+  virtual ~Encoder() noexcept = default;
+
+  virtual void beginObject(size_t total) noexcept = 0;
+  virtual void endObject() noexcept = 0;
+  virtual void beginArray(size_t total) noexcept = 0;
+  virtual void endArray() noexcept = 0;
+  virtual void key(StringView name) noexcept = 0;
+  virtual void string(StringView value) noexcept = 0;
+  virtual void integer(int64_t value) noexcept = 0;
+  virtual void boolean(bool value) noexcept = 0;
+  virtual void null() noexcept = 0;
+};
+
+namespace
+{
+
+using Encoder = MetadataWriter::Encoder;
+
+//-----------------------------------------------------------------------------
+struct JsonEncoder final : public Encoder
+{
+  std::vector<bool> first_;
+  bool afterKey_{};
+
+  using Encoder::Encoder;
+
+  void separate() noexcept
+  {
+    if (afterKey_) {
+      afterKey_ = false;
+      return;
+    }
+    if (first_.empty())
+      return;
+    if (!first_.back())
+      output_.append(',');
+    first_.back() = false;
+  }
+
+  void quoted(StringView value) noexcept
+  {
+    constexpr StringView hex{ "0123456789abcdef" };
+
+    output_.append('"');
+    for (auto ch : value) {
+      switch (ch) {
+        case '"':   output_.append("\\\""); break;
+        case '\\':  output_.append("\\\\"); break;
+        case '\n':  output_.append("\\n"); break;
+        case '\r':  output_.append("\\r"); break;
+        case '\t':  output_.append("\\t"); break;
+        default: {
+          if (static_cast<unsigned char>(ch) < 0x20) {
+            output_.append("\\u00");
+            output_.append(hex[(ch >> 4) & 0xF]);
+            output_.append(hex[ch & 0xF]);
+            break;
+          }
+          output_.append(ch);
+          break;
+        }
+      }
+    }
+    output_.append('"');
+  }
+
+  void beginObject(size_t) noexcept final { separate(); output_.append('{'); first_.push_back(true); }
+  void endObject() noexcept final { first_.pop_back(); output_.append('}'); }
+  void beginArray(size_t) noexcept final { separate(); output_.append('['); first_.push_back(true); }
+  void endArray() noexcept final { first_.pop_back(); output_.append(']'); }
+  void key(StringView name) noexcept final { separate(); quoted(name); output_.append(':'); afterKey_ = true; }
+  void string(StringView value) noexcept final { separate(); quoted(value); }
+  void integer(int64_t value) noexcept final { separate(); output_.append(std::to_string(value)); }
+  void boolean(bool value) noexcept final { separate(); output_.append(value ? "true"sv : "false"sv); }
+  void null() noexcept final { separate(); output_.append("null"sv); }
+};
+
+//-----------------------------------------------------------------------------
+struct CborEncoder final : public Encoder
+{
+  using Encoder::Encoder;
+
+  void head(uint8_t major, uint64_t value) noexcept
+  {
+    auto type{ static_cast<char>(major << 5) };
+    if (value < 24) {
+      output_.append(static_cast<char>(type | static_cast<char>(value)));
+      return;
+    }
+    if (value <= 0xFF) {
+      output_.append(static_cast<char>(type | 24));
+      output_.appendBigEndian(value, 1);
+      return;
+    }
+    if (value <= 0xFFFF) {
+      output_.append(static_cast<char>(type | 25));
+      output_.appendBigEndian(value, 2);
+      return;
+    }
+    if (value <= 0xFFFFFFFF) {
+      output_.append(static_cast<char>(type | 26));
+      output_.appendBigEndian(value, 4);
+      return;
+    }
+    output_.append(static_cast<char>(type | 27));
+    output_.appendBigEndian(value, 8);
+  }
+
+  void beginObject(size_t total) noexcept final { head(5, total); }
+  void endObject() noexcept final {}
+  void beginArray(size_t total) noexcept final { head(4, total); }
+  void endArray() noexcept final {}
+  void key(StringView name) noexcept final { string(name); }
+  void string(StringView value) noexcept final { head(3, value.size()); output_.append(value); }
+  void integer(int64_t value) noexcept final
+  {
+    if (value < 0) {
+      head(1, ~static_cast<uint64_t>(value));
+      return;
+    }
+    head(0, static_cast<uint64_t>(value));
+  }
+  void boolean(bool value) noexcept final { output_.append(static_cast<char>(value ? 0xF5 : 0xF4)); }
+  void null() noexcept final { output_.append(static_cast<char>(0xF6)); }
+};
+
+//-----------------------------------------------------------------------------
+struct MsgPackEncoder final : public Encoder
+{
+  using Encoder::Encoder;
+
+  void sized(uint64_t total, uint8_t fixed, uint64_t fixedLimit, uint8_t marker16, uint8_t marker32) noexcept
+  {
+    if (total < fixedLimit) {
+      output_.append(static_cast<char>(fixed | total));
+      return;
+    }
+    if (total <= 0xFFFF) {
+      output_.append(static_cast<char>(marker16));
+      output_.appendBigEndian(total, 2);
+      return;
+    }
+    output_.append(static_cast<char>(marker32));
+    output_.appendBigEndian(total, 4);
+  }
+
+  void beginObject(size_t total) noexcept final { sized(total, 0x80, 16, 0xDE, 0xDF); }
+  void endObject() noexcept final {}
+  void beginArray(size_t total) noexcept final { sized(total, 0x90, 16, 0xDC, 0xDD); }
+  void endArray() noexcept final {}
+  void key(StringView name) noexcept final { string(name); }
+  void string(StringView value) noexcept final
+  {
+    if ((value.size() >= 32) && (value.size() <= 0xFF)) {
+      output_.append(static_cast<char>(0xD9));
+      output_.appendBigEndian(value.size(), 1);
+    }
+    else
+      sized(value.size(), 0xA0, 32, 0xDA, 0xDB);
+    output_.append(value);
+  }
+  void integer(int64_t value) noexcept final
+  {
+    if (value >= 0) {
+      auto unsignedValue{ static_cast<uint64_t>(value) };
+      if (unsignedValue < 0x80)
+        output_.append(static_cast<char>(unsignedValue));
+      else if (unsignedValue <= 0xFF) {
+        output_.append(static_cast<char>(0xCC));
+        output_.appendBigEndian(unsignedValue, 1);
+      }
+      else if (unsignedValue <= 0xFFFF) {
+        output_.append(static_cast<char>(0xCD));
+        output_.appendBigEndian(unsignedValue, 2);
+      }
+      else if (unsignedValue <= 0xFFFFFFFF) {
+        output_.append(static_cast<char>(0xCE));
+        output_.appendBigEndian(unsignedValue, 4);
+      }
+      else {
+        output_.append(static_cast<char>(0xCF));
+        output_.appendBigEndian(unsignedValue, 8);
+      }
+      return;
+    }
+
+    auto bits{ static_cast<uint64_t>(value) };
+    if (value >= -32)
+      output_.append(static_cast<char>(value));
+    else if (value >= std::numeric_limits<int8_t>::min()) {
+      output_.append(static_cast<char>(0xD0));
+      output_.appendBigEndian(bits, 1);
+    }
+    else if (value >= std::numeric_limits<int16_t>::min()) {
+      output_.append(static_cast<char>(0xD1));
+      output_.appendBigEndian(bits, 2);
+    }
+    else if (value >= std::numeric_limits<int32_t>::min()) {
+      output_.append(static_cast<char>(0xD2));
+      output_.appendBigEndian(bits, 4);
+    }
+    else {
+      output_.append(static_cast<char>(0xD3));
+      output_.appendBigEndian(bits, 8);
+    }
+  }
+  void boolean(bool value) noexcept final { output_.append(static_cast<char>(value ? 0xC3 : 0xC2)); }
+  void null() noexcept final { output_.append(static_cast<char>(0xC0)); }
+};
+
+//-----------------------------------------------------------------------------
+struct UbjsonEncoder final : public Encoder
+{
+  using Encoder::Encoder;
+
+  void number(int64_t value) noexcept
+  {
+    auto bits{ static_cast<uint64_t>(value) };
+    if ((value >= 0) && (value <= 0xFF)) {
+      output_.append('U');
+      output_.appendBigEndian(bits, 1);
+    }
+    else if ((value >= std::numeric_limits<int8_t>::min()) && (value <= std::numeric_limits<int8_t>::max())) {
+      output_.append('i');
+      output_.appendBigEndian(bits, 1);
+    }
+    else if ((value >= std::numeric_limits<int16_t>::min()) && (value <= std::numeric_limits<int16_t>::max())) {
+      output_.append('I');
+      output_.appendBigEndian(bits, 2);
+    }
+    else if ((value >= std::numeric_limits<int32_t>::min()) && (value <= std::numeric_limits<int32_t>::max())) {
+      output_.append('l');
+      output_.appendBigEndian(bits, 4);
+    }
+    else {
+      output_.append('L');
+      output_.appendBigEndian(bits, 8);
+    }
+  }
+
+  void beginObject(size_t) noexcept final { output_.append('{'); }
+  void endObject() noexcept final { output_.append('}'); }
+  void beginArray(size_t) noexcept final { output_.append('['); }
+  void endArray() noexcept final { output_.append(']'); }
+  void key(StringView name) noexcept final { number(static_cast<int64_t>(name.size())); output_.append(name); }
+  void string(StringView value) noexcept final { output_.append('S'); key(value); }
+  void integer(int64_t value) noexcept final { number(value); }
+  void boolean(bool value) noexcept final { output_.append(value ? 'T' : 'F'); }
+  void null() noexcept final { output_.append('Z'); }
+};
+
+//-----------------------------------------------------------------------------
+struct BsonEncoder final : public Encoder
+{
+  struct Document
+  {
+    uint64_t start_{};
+    bool array_{};
+    size_t index_{};
+  };
+
+  std::vector<Document> documents_;
+  String key_;
+
+  using Encoder::Encoder;
+
+  void element(char type) noexcept
+  {
+    if (documents_.empty())
+      return;
+
+    auto& document{ documents_.back() };
+    output_.append(type);
+    if (document.array_)
+      output_.append(std::to_string(document.index_++));
+    else
+      output_.append(key_);
+    output_.append('\0');
+  }
+
+  void begin(char type, bool array) noexcept
+  {
+    element(type);
+    documents_.push_back(Document{ .start_ = output_.offset(), .array_ = array });
+    output_.appendLittleEndian(0, 4);
+  }
+
+  void end() noexcept
+  {
+    output_.append('\0');
+    auto start{ documents_.back().start_ };
+    documents_.pop_back();
+    output_.patchLittleEndian(start, static_cast<uint32_t>(output_.offset() - start));
+  }
+
+  void beginObject(size_t) noexcept final { begin(0x03, false); }
+  void endObject() noexcept final { end(); }
+  void beginArray(size_t) noexcept final { begin(0x04, true); }
+  void endArray() noexcept final { end(); }
+  void key(StringView name) noexcept final { key_ = name; }
+  void string(StringView value) noexcept final
+  {
+    element(0x02);
+    output_.appendLittleEndian(value.size() + 1, 4);
+    output_.append(value);
+    output_.append('\0');
+  }
+  void integer(int64_t value) noexcept final
+  {
+    if ((value >= std::numeric_limits<int32_t>::min()) && (value <= std::numeric_limits<int32_t>::max())) {
+      element(0x10);
+      output_.appendLittleEndian(static_cast<uint64_t>(value), 4);
+      return;
+    }
+    element(0x12);
+    output_.appendLittleEndian(static_cast<uint64_t>(value), 8);
+  }
+  void boolean(bool value) noexcept final { element(0x08); output_.append(value ? '\1' : '\0'); }
+  void null() noexcept final { element(0x0A); }
+};
+
+//-----------------------------------------------------------------------------
+String versionString(const SemanticVersion& version) noexcept
+{
+  auto result{ std::to_string(version.major_) + "." + std::to_string(version.minor_) + "." + std::to_string(version.patch_) };
+  if (!version.preRelease_.empty())
+    result += "-" + version.preRelease_;
+  if (!version.build_.empty())
+    result += "+" + version.build_;
+  return result;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+MetadataWriter::MetadataWriter(const Config::MetaData& config) noexcept :
+  config_{ config }
+{
+}
+
+//-----------------------------------------------------------------------------
+MetadataWriter::~MetadataWriter() noexcept = default;
+
+//-----------------------------------------------------------------------------
+String MetadataWriter::filePath(const Config::MetaData& config, StringView extension) noexcept
+{
+  return config.outputPath_ + "." + String{ extension };
+}
+
+//-----------------------------------------------------------------------------
+StringList MetadataWriter::write(const Parser& parser) noexcept
+{
+  open();
+
+  beginObject(2);
+  {
+    key("compiler");
+    beginObject(2);
+    key("name");
+    string(Version::name());
+    key("version");
+    string(Version::version());
+    endObject();
+
+    key("sources");
+    beginArray(parser.processedSources_.size());
+    for (auto& entry : parser.processedSources_)
+      source(*entry);
+    endArray();
+  }
+  endObject();
+
+  return close();
+}
+
+//-----------------------------------------------------------------------------
+void MetadataWriter::open() noexcept
+{
+  encoders_.clear();
+  if (config_.json_)
+    encoders_.push_back(std::make_unique<JsonEncoder>(filePath(config_, "json")));
+  if (config_.bson_)
+    encoders_.push_back(std::make_unique<BsonEncoder>(filePath(config_, "bson")));
+  if (config_.cbor_)
+    encoders_.push_back(std::make_unique<CborEncoder>(filePath(config_, "cbor")));
+  if (config_.msgPack_)
+    encoders_.push_back(std::make_unique<MsgPackEncoder>(filePath(config_, "msgpack")));
+  if (config_.ubjson_)
+    encoders_.push_back(std::make_unique<UbjsonEncoder>(filePath(config_, "ubjson")));
+}
+
+//-----------------------------------------------------------------------------
+StringList MetadataWriter::close() noexcept
+{
+  StringList failed;
+  for (auto& encoder : encoders_) {
+    if (!encoder->output_.close())
+      failed.push_back(encoder->output_.filePath_);
+  }
+  encoders_.clear();
+  return failed;
+}
+
+//-----------------------------------------------------------------------------
+void MetadataWriter::source(const Source& source) noexcept
+{
+  const Context* context{ source.context_ ? &(*(source.context_)) : nullptr };
+  auto state{ context ? context->state() : CompileStateConstPtr{} };
+
+  beginObject(6);
+
+  key("file");
+  string(source.effectivePath_ ? StringView{ source.effectivePath_->filePath_ } : StringView{});
+  key("fullFile");
+  string(source.realPath_ ? StringView{ source.realPath_->fullFilePath_ } : StringView{});
+
+  key("exported");
+  boolean(state && state->export_.visible());
+
+  key("deprecated");
+  if (state && state->deprecate_)
+    deprecate(*(state->deprecate_));
+  else
+    null();
+
+  key("types");
+  if (context) {
+    beginArray(context->types_.types_.size());
+    for (auto& [name, type] : context->types_.types_)
+      string(name);
+    endArray();
+  }
+  else {
+    beginArray(0);
+    endArray();
+  }
+
+  key("aliases");
+  beginObject(2);
+  {
+    static const std::map<String, TokenConstPtr> none;
+    key("keywords");
+    aliases(context ? context->aliasing_.keywords_ : none);
+    key("operators");
+    aliases(context ? context->aliasing_.operators_ : none);
+  }
+  endObject();
+
+  endObject();
+}
+
+//-----------------------------------------------------------------------------
+void MetadataWriter::deprecate(const CompileState::Deprecate& deprecate) noexcept
+{
+  beginObject(7);
+  key("context");
+  string(CompileState::Deprecate::ContextTraits::toString(deprecate.context_));
+  key("forceError");
+  boolean(deprecate.forceError_);
+  key("min");
+  version(deprecate.min_);
+  key("max");
+  version(deprecate.max_);
+  key("file");
+  string(deprecate.origin_.filePath_ ? StringView{ deprecate.origin_.filePath_->filePath_ } : StringView{});
+  key("line");
+  integer(deprecate.origin_.location_.line_);
+  key("column");
+  integer(deprecate.origin_.location_.column_);
+  endObject();
+}
+
+//-----------------------------------------------------------------------------
+void MetadataWriter::aliases(const std::map<String, TokenConstPtr>& aliases) noexcept
+{
+  beginObject(aliases.size());
+  for (auto& [name, token] : aliases) {
+    key(name);
+    if (token)
+      string(token->token_);
+    else
+      null();
+  }
+  endObject();
+}
+
+//-----------------------------------------------------------------------------
+void MetadataWriter::version(const std::optional<SemanticVersion>& value) noexcept
+{
+  if (!value) {
+    null();
+    return;
+  }
+  string(versionString(*value));
+}
+
+//-----------------------------------------------------------------------------
+void MetadataWriter::beginObject(size_t total) noexcept { for (auto& encoder : encoders_) encoder->beginObject(total); }
+void MetadataWriter::endObject() noexcept { for (auto& encoder : encoders_) encoder->endObject(); }
+void MetadataWriter::beginArray(size_t total) noexcept { for (auto& encoder : encoders_) encoder->beginArray(total); }
+void MetadataWriter::endArray() noexcept { for (auto& encoder : encoders_) encoder->endArray(); }
+void MetadataWriter::key(StringView name) noexcept { for (auto& encoder : encoders_) encoder->key(name); }
+void MetadataWriter::string(StringView value) noexcept { for (auto& encoder : encoders_) encoder->string(value); }
+void MetadataWriter::integer(int64_t value) noexcept { for (auto& encoder : encoders_) encoder->integer(value); }
+void MetadataWriter::boolean(bool value) noexcept { for (auto& encoder : encoders_) encoder->boolean(value); }
+void MetadataWriter::null() noexcept { for (auto& encoder : encoders_) encoder->null(); }
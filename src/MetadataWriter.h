@@ -0,0 +1,56 @@
+#pragma once
+
+#include "types.h"
+#include "Config.h"
+#include "CompileState.h"
+
+namespace zax
+{
+
+// Walks the parsed model once and fans every event out to an incremental
+// encoder per requested --metadata-types format. Each encoder writes
+// through its own bounded buffer so no document is ever built in memory;
+// container sizes are known up front from the model so only BSON has to
+// patch its length prefixes after the fact.
+struct MetadataWriter
+{
+  struct Encoder;
+  using EncoderList = std::vector<std::unique_ptr<Encoder>>;
+
+  const Config::MetaData config_;
+  EncoderList encoders_;
+
+  MetadataWriter(const Config::MetaData& config) noexcept;
+  ~MetadataWriter() noexcept;
+
+  MetadataWriter(const MetadataWriter&) noexcept = delete;
+  MetadataWriter(MetadataWriter&&) noexcept = delete;
+
+  MetadataWriter& operator=(const MetadataWriter&) noexcept = delete;
+  MetadataWriter& operator=(MetadataWriter&&) noexcept = delete;
+
+  [[nodiscard]] StringList write(const Parser& parser) noexcept;
+
+  [[nodiscard]] static String filePath(const Config::MetaData& config, StringView extension) noexcept;
+
+protected:
+  void open() noexcept;
+  [[nodiscard]] StringList close() noexcept;
+
+  void source(const Source& source) noexcept;
+  void deprecate(const CompileState::Deprecate& deprecate) noexcept;
+  void aliases(const std::map<String, TokenConstPtr>& aliases) noexcept;
+  void version(const std::optional<SemanticVersion>& value) noexcept;
+
+  void beginObject(size_t total) noexcept;
+  void endObject() noexcept;
+  void beginArray(size_t total) noexcept;
+  void endArray() noexcept;
+  void key(StringView name) noexcept;
+  void string(StringView value) noexcept;
+  void integer(int64_t value) noexcept;
+  void boolean(bool value) noexcept;
+  void null() noexcept;
+};
+
+} // namespace zax
@@ -4,6 +4,7 @@
 #include "types.h"
 #include "helpers.h"
 #include "CompileState.h"
+#include "ModuleInterface.h"
 
 namespace zax
 {
@@ -11,6 +12,7 @@ namespace zax
 struct Module
 {
   const Puid id_{ puid() };
+  ModuleInterfaceConstPtr interface_;   // set when imported from a compiled interface
 };
 
 } // namespace zax
@@ -0,0 +1,393 @@
+#include "pch.h"
+#include "ModuleInterface.h"
+#include "Context.h"
+#include "Parser.h"
+#include "Source.h"
+#include "Token.h"
+#include "version.h"
+
+#include <bit>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else //_WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif //_WIN32
+
+using namespace zax;
+
+namespace
+{
+
+constexpr std::array<char, 4> Magic{ 'Z', 'M', 'I', 'F' };
+constexpr uint32_t FormatVersion{ 1 };
+
+// records are copied to and from the file as they are laid out in memory
+static_assert(sizeof(ModuleInterface::Text) == 8);
+static_assert(sizeof(ModuleInterface::Version) == 32);
+static_assert(sizeof(ModuleInterface::Deprecate) == 88);
+static_assert(sizeof(ModuleInterface::Source) == 20);
+static_assert(sizeof(ModuleInterface::Name) == 24);
+static_assert(sizeof(ModuleInterface::Header) == 48);
+
+constexpr bool LittleEndian{ std::endian::native == std::endian::little };
+
+//-----------------------------------------------------------------------------
+struct Builder
+{
+  std::vector<ModuleInterface::Source> sources_;
+  std::vector<ModuleInterface::Name> names_;
+  std::vector<ModuleInterface::Deprecate> deprecates_;
+  String strings_;
+  std::unordered_map<String, ModuleInterface::Text> interned_;
+
+  ModuleInterface::Text text(StringView value) noexcept
+  {
+    auto [iter, added] { interned_.try_emplace(String{ value }) };
+    if (added) {
+      iter->second = ModuleInterface::Text{ .offset_ = static_cast<uint32_t>(strings_.size()), .length_ = static_cast<uint32_t>(value.size()) };
+      strings_.append(value);
+    }
+    return iter->second;
+  }
+
+  ModuleInterface::Version version(const std::optional<SemanticVersion>& value) noexcept
+  {
+    if (!value)
+      return {};
+    return ModuleInterface::Version{
+      .present_ = 1,
+      .major_ = value->major_,
+      .minor_ = value->minor_,
+      .patch_ = value->patch_,
+      .preRelease_ = text(value->preRelease_),
+      .build_ = text(value->build_)
+    };
+  }
+
+  uint32_t deprecate(const CompileState::Deprecate& value) noexcept
+  {
+    deprecates_.push_back(ModuleInterface::Deprecate{
+      .context_ = static_cast<uint32_t>(value.context_),
+      .forceError_ = value.forceError_ ? 1u : 0u,
+      .min_ = version(value.min_),
+      .max_ = version(value.max_),
+      .file_ = text(value.origin_.filePath_ ? StringView{ value.origin_.filePath_->filePath_ } : StringView{}),
+      .line_ = value.origin_.location_.line_,
+      .column_ = value.origin_.location_.column_
+    });
+    return static_cast<uint32_t>(deprecates_.size() - 1);
+  }
+
+  void name(ModuleInterface::Kind kind, StringView name, StringView value) noexcept
+  {
+    names_.push_back(ModuleInterface::Name{
+      .kind_ = static_cast<uint32_t>(kind),
+      .source_ = static_cast<uint32_t>(sources_.size() - 1),
+      .name_ = text(name),
+      .value_ = text(value)
+    });
+  }
+
+  void source(const Source& source, const Context& context, const CompileState& state) noexcept
+  {
+    sources_.push_back(ModuleInterface::Source{
+      .file_ = text(source.effectivePath_ ? StringView{ source.effectivePath_->filePath_ } : StringView{}),
+      .fullFile_ = text(source.realPath_ ? StringView{ source.realPath_->fullFilePath_ } : StringView{}),
+      .deprecate_ = state.deprecate_ ? deprecate(*state.deprecate_) : ModuleInterface::NoIndex
+    });
+
+    for (auto& [typeName, type] : context.types_.types_)
+      name(ModuleInterface::Kind::Type, typeName, {});
+    for (auto& [alias, token] : context.aliasing_.keywords_)
+      name(ModuleInterface::Kind::KeywordAlias, alias, token ? StringView{ token->token_ } : StringView{});
+    for (auto& [alias, token] : context.aliasing_.operators_)
+      name(ModuleInterface::Kind::OperatorAlias, alias, token ? StringView{ token->token_ } : StringView{});
+  }
+
+  StringView view(const ModuleInterface::Text& value) const noexcept
+  {
+    return StringView{ strings_ }.substr(value.offset_, value.length_);
+  }
+
+  template <typename T>
+  static void append(String& output, const T& value) noexcept
+  {
+    output.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  template <typename T>
+  static ModuleInterface::Table append(String& output, const std::vector<T>& values) noexcept
+  {
+    ModuleInterface::Table result{ .offset_ = static_cast<uint32_t>(output.size()), .total_ = static_cast<uint32_t>(values.size()) };
+    for (auto& value : values)
+      append(output, value);
+    return result;
+  }
+
+  String build() noexcept
+  {
+    std::stable_sort(names_.begin(), names_.end(), [&](const ModuleInterface::Name& lhs, const ModuleInterface::Name& rhs) noexcept {
+      if (lhs.kind_ != rhs.kind_)
+        return lhs.kind_ < rhs.kind_;
+      return view(lhs.name_) < view(rhs.name_);
+    });
+
+    ModuleInterface::Header header;
+    std::copy(Magic.begin(), Magic.end(), header.magic_);
+    header.formatVersion_ = FormatVersion;
+    header.compiler_ = text(Version::version());
+
+    String output;
+    append(output, header);
+    header.sources_ = append(output, sources_);
+    header.names_ = append(output, names_);
+    header.deprecates_ = append(output, deprecates_);
+    header.strings_ = ModuleInterface::Table{ .offset_ = static_cast<uint32_t>(output.size()), .total_ = static_cast<uint32_t>(strings_.size()) };
+    output.append(strings_);
+
+    // the table offsets are only known once everything else is laid out
+    std::memcpy(output.data(), &header, sizeof(header));
+    return output;
+  }
+};
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+struct ModuleInterface::Mapping
+{
+  const std::byte* data_{};
+  size_t size_{};
+
+#ifdef _WIN32
+  HANDLE file_{ INVALID_HANDLE_VALUE };
+  HANDLE mapping_{};
+#endif //_WIN32
+
+  ~Mapping() noexcept
+  {
+#ifdef _WIN32
+    if (data_)
+      UnmapViewOfFile(data_);
+    if (mapping_)
+      CloseHandle(mapping_);
+    if (INVALID_HANDLE_VALUE != file_)
+      CloseHandle(file_);
+#else //_WIN32
+    if (data_)
+      ::munmap(const_cast<std::byte*>(data_), size_);
+#endif //_WIN32
+  }
+
+  [[nodiscard]] bool map(StringView filePath) noexcept
+  {
+#ifdef _WIN32
+    file_ = CreateFileW(Path{ filePath }.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (INVALID_HANDLE_VALUE == file_)
+      return false;
+
+    LARGE_INTEGER size{};
+    if ((!GetFileSizeEx(file_, &size)) || (size.QuadPart < 1))
+      return false;
+
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_)
+      return false;
+
+    data_ = static_cast<const std::byte*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    size_ = static_cast<size_t>(size.QuadPart);
+    return nullptr != data_;
+#else //_WIN32
+    auto descriptor{ ::open(String{ filePath }.c_str(), O_RDONLY | O_CLOEXEC) };
+    if (descriptor < 0)
+      return false;
+
+    struct stat info {};
+    if ((0 != ::fstat(descriptor, &info)) || (info.st_size < 1)) {
+      ::close(descriptor);
+      return false;
+    }
+
+    // the mapping outlives the descriptor
+    auto data{ ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0) };
+    ::close(descriptor);
+    if (MAP_FAILED == data)
+      return false;
+
+    data_ = static_cast<const std::byte*>(data);
+    size_ = static_cast<size_t>(info.st_size);
+    return true;
+#endif //_WIN32
+  }
+};
+
+//-----------------------------------------------------------------------------
+ModuleInterface::ModuleInterface() noexcept
+{
+}
+
+//-----------------------------------------------------------------------------
+ModuleInterface::~ModuleInterface() noexcept
+{
+}
+
+//-----------------------------------------------------------------------------
+ModuleInterfacePtr ModuleInterface::open(StringView filePath) noexcept
+{
+  if constexpr (!LittleEndian)
+    return {};
+
+  auto result{ std::make_shared<ModuleInterface>() };
+  result->mapping_ = std::make_unique<Mapping>();
+  auto& mapping{ *result->mapping_ };
+  if (!mapping.map(filePath))
+    return {};
+
+  if (mapping.size_ < sizeof(Header))
+    return {};
+
+  auto& header{ result->header_ };
+  std::memcpy(&header, mapping.data_, sizeof(header));
+  if ((!std::equal(Magic.begin(), Magic.end(), header.magic_)) || (FormatVersion != header.formatVersion_))
+    return {};
+
+  // only the table bounds are checked here; records are read when asked for
+  auto fits{ [&](const Table& table, size_t recordSize) noexcept {
+    return static_cast<uint64_t>(table.offset_) + (static_cast<uint64_t>(table.total_) * recordSize) <= mapping.size_;
+  } };
+  if ((!fits(header.sources_, sizeof(Source))) ||
+    (!fits(header.names_, sizeof(Name))) ||
+    (!fits(header.deprecates_, sizeof(Deprecate))) ||
+    (!fits(header.strings_, 1)))
+    return {};
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+bool ModuleInterface::write(const Parser& parser, StringView filePath) noexcept
+{
+  if constexpr (!LittleEndian)
+    return false;
+
+  Builder builder;
+  for (auto& source : parser.processedSources_) {
+    if (!source->context_)
+      continue;
+    auto state{ source->context_->state() };
+    if ((!state) || (!state->export_.visible()))
+      continue;
+    builder.source(*source, *source->context_, *state);
+  }
+  auto output{ builder.build() };
+
+  // written aside and renamed so an importer never maps half a file
+  Path target{ filePath };
+  auto temporary{ target };
+  temporary += "." + std::to_string(puid());
+  if (!writeBinaryFile(temporary.string(), output))
+    return false;
+
+  std::error_code ec;
+  std::filesystem::rename(temporary, target, ec);
+  if (ec) {
+    std::filesystem::remove(temporary, ec);
+    return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+T ModuleInterface::record(const Table& table, size_t index) const noexcept
+{
+  assert(index < table.total_);
+  T result;
+  std::memcpy(&result, mapping_->data_ + table.offset_ + (index * sizeof(T)), sizeof(T));
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+ModuleInterface::Source ModuleInterface::source(size_t index) const noexcept
+{
+  return record<Source>(header_.sources_, index);
+}
+
+//-----------------------------------------------------------------------------
+ModuleInterface::Name ModuleInterface::name(size_t index) const noexcept
+{
+  return record<Name>(header_.names_, index);
+}
+
+//-----------------------------------------------------------------------------
+std::optional<ModuleInterface::Name> ModuleInterface::find(Kind kind, StringView name) const noexcept
+{
+  auto wanted{ static_cast<uint32_t>(kind) };
+
+  size_t first{};
+  size_t count{ totalNames() };
+  while (count > 0) {
+    auto step{ count / 2 };
+    auto probe{ this->name(first + step) };
+    if ((probe.kind_ < wanted) || ((probe.kind_ == wanted) && (text(probe.name_) < name))) {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+      count = step;
+  }
+
+  if (first >= totalNames())
+    return {};
+  auto found{ this->name(first) };
+  if ((found.kind_ != wanted) || (text(found.name_) != name))
+    return {};
+  return found;
+}
+
+//-----------------------------------------------------------------------------
+std::optional<CompileState::Deprecate> ModuleInterface::deprecate(const Source& source) const noexcept
+{
+  if ((NoIndex == source.deprecate_) || (source.deprecate_ >= header_.deprecates_.total_))
+    return {};
+
+  auto stored{ record<Deprecate>(header_.deprecates_, source.deprecate_) };
+  if (stored.context_ >= CompileState::Deprecate::ContextTraits::Total())
+    return {};
+
+  auto version{ [&](const Version& value) noexcept -> std::optional<SemanticVersion> {
+    if (!value.present_)
+      return {};
+    SemanticVersion result;
+    result.major_ = value.major_;
+    result.minor_ = value.minor_;
+    result.patch_ = value.patch_;
+    result.preRelease_ = text(value.preRelease_);
+    result.build_ = text(value.build_);
+    return result;
+  } };
+
+  CompileState::Deprecate result{ .context_ = static_cast<CompileState::Deprecate::Context>(stored.context_) };
+  result.forceError_ = 0 != stored.forceError_;
+  result.min_ = version(stored.min_);
+  result.max_ = version(stored.max_);
+  result.origin_.filePath_ = std::make_shared<SourceTypes::FilePath>();
+  result.origin_.filePath_->filePath_ = text(stored.file_);
+  result.origin_.location_.line_ = stored.line_;
+  result.origin_.location_.column_ = stored.column_;
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+StringView ModuleInterface::text(const Text& text) const noexcept
+{
+  if (static_cast<uint64_t>(text.offset_) + text.length_ > header_.strings_.total_)
+    return {};
+  return StringView{ reinterpret_cast<const char*>(mapping_->data_ + header_.strings_.offset_ + text.offset_), text.length_ };
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "types.h"
+#include "CompileState.h"
+
+namespace zax
+{
+
+ZAX_DECLARE_STRUCT_PTR(ModuleInterface);
+
+// The compiled interface of a module: what its exported sources declare laid
+// out as fixed size little-endian records that refer to one string table by
+// offset. Importers map the file and read the records in place, so opening
+// an interface costs a header check no matter how large the module is and
+// a name is found by binary search without building anything in memory.
+struct ModuleInterface
+{
+  constexpr static uint32_t NoIndex{ UINT32_MAX };
+
+  enum class Kind : uint32_t
+  {
+    Type,
+    KeywordAlias,
+    OperatorAlias
+  };
+
+  struct KindDeclare final : public zs::EnumDeclare<Kind, 3>
+  {
+    constexpr const Entries operator()() const noexcept
+    {
+      return { {
+        {Kind::Type, "type"},
+        {Kind::KeywordAlias, "keyword-alias"},
+        {Kind::OperatorAlias, "operator-alias"}
+      } };
+    }
+  };
+
+  using KindTraits = zs::EnumTraits<Kind, KindDeclare>;
+
+  struct Text
+  {
+    uint32_t offset_{};
+    uint32_t length_{};
+  };
+
+  struct Version
+  {
+    uint32_t present_{};
+    int32_t major_{};
+    int32_t minor_{};
+    int32_t patch_{};
+    Text preRelease_;
+    Text build_;
+  };
+
+  struct Deprecate
+  {
+    uint32_t context_{};
+    uint32_t forceError_{};
+    Version min_;
+    Version max_;
+    Text file_;
+    int32_t line_{};
+    int32_t column_{};
+  };
+
+  struct Source
+  {
+    Text file_;
+    Text fullFile_;
+    uint32_t deprecate_{ NoIndex };
+  };
+
+  // sorted by kind then name so a lookup is a binary search
+  struct Name
+  {
+    uint32_t kind_{};
+    uint32_t source_{};
+    Text name_;
+    Text value_;
+  };
+
+  struct Table
+  {
+    uint32_t offset_{};
+    uint32_t total_{};
+  };
+
+  struct Header
+  {
+    char magic_[4]{};
+    uint32_t formatVersion_{};
+    Text compiler_;
+    Table sources_;
+    Table names_;
+    Table deprecates_;
+    Table strings_;
+  };
+
+  struct Mapping;
+
+  std::unique_ptr<Mapping> mapping_;
+  Header header_;
+
+  ModuleInterface() noexcept;
+  ~ModuleInterface() noexcept;
+
+  ModuleInterface(const ModuleInterface&) noexcept = delete;
+  ModuleInterface(ModuleInterface&&) noexcept = delete;
+
+  ModuleInterface& operator=(const ModuleInterface&) noexcept = delete;
+  ModuleInterface& operator=(ModuleInterface&&) noexcept = delete;
+
+  [[nodiscard]] static ModuleInterfacePtr open(StringView filePath) noexcept;
+  [[nodiscard]] static bool write(const Parser& parser, StringView filePath) noexcept;
+
+  [[nodiscard]] size_t totalSources() const noexcept { return header_.sources_.total_; }
+  [[nodiscard]] size_t totalNames() const noexcept { return header_.names_.total_; }
+
+  [[nodiscard]] Source source(size_t index) const noexcept;
+  [[nodiscard]] Name name(size_t index) const noexcept;
+  [[nodiscard]] std::optional<Name> find(Kind kind, StringView name) const noexcept;
+  [[nodiscard]] std::optional<CompileState::Deprecate> deprecate(const Source& source) const noexcept;
+
+  [[nodiscard]] StringView text(const Text& text) const noexcept;
+  [[nodiscard]] StringView compiler() const noexcept { return text(header_.compiler_); }
+
+protected:
+  template <typename T>
+  [[nodiscard]] T record(const Table& table, size_t index) const noexcept;
+};
+
+} // namespace zax
@@ -83,6 +83,14 @@ OperatorLut::~OperatorLut() noexcept
 {
 }
 
+//-----------------------------------------------------------------------------
+OperatorLutConstPtr OperatorLut::shared() noexcept
+{
+  // the table never changes once built so every parser can read the same one
+  static const OperatorLutConstPtr value{ std::make_shared<OperatorLut>() };
+  return value;
+}
+
 //-----------------------------------------------------------------------------
 bool OperatorLut::hasConflicts(TokenTypes::Operator value) const noexcept
 {
@@ -32,6 +32,8 @@ struct OperatorLut : public OperatorLutTypes
   OperatorLut() noexcept;
   ~OperatorLut() noexcept;
 
+  [[nodiscard]] static OperatorLutConstPtr shared() noexcept;
+
   bool hasConflicts(TokenTypes::Operator value) const noexcept;
   const OperatorEnumSet& lookupConflicts(TokenTypes::Operator value) const noexcept;
 
@@ -0,0 +1,640 @@
+#include "pch.h"
+#include "ParseResultCache.h"
+#include "CompileState.h"
+#include "Sha256.h"
+#include "Source.h"
+#include "version.h"
+
+using namespace zax;
+
+namespace
+{
+
+constexpr StringView Magic{ "ZPRC" };
+constexpr uint32_t FormatVersion{ 2 };
+constexpr uint32_t NoIndex{ UINT32_MAX };
+
+using Kind = ParseResult::Kind;
+using BufferedKind = ParserTypes::BufferedDiagnostic::Kind;
+
+//-----------------------------------------------------------------------------
+struct Writer
+{
+  String output_;
+
+  void u8(uint8_t value) noexcept { output_.push_back(static_cast<char>(value)); }
+  void u32(uint32_t value) noexcept { for (int shift{}; shift < 32; shift += 8) u8(static_cast<uint8_t>(value >> shift)); }
+  void u64(uint64_t value) noexcept { for (int shift{}; shift < 64; shift += 8) u8(static_cast<uint8_t>(value >> shift)); }
+  void i32(int32_t value) noexcept { u32(static_cast<uint32_t>(value)); }
+  void flag(bool value) noexcept { u8(value ? 1 : 0); }
+  void text(StringView value) noexcept { u32(static_cast<uint32_t>(value.size())); output_.append(value); }
+};
+
+//-----------------------------------------------------------------------------
+struct Reader
+{
+  StringView input_;
+  bool failed_{};
+
+  uint8_t u8() noexcept
+  {
+    if (input_.empty()) {
+      failed_ = true;
+      return 0;
+    }
+    auto result{ static_cast<uint8_t>(input_.front()) };
+    input_.remove_prefix(1);
+    return result;
+  }
+  uint32_t u32() noexcept { uint32_t result{}; for (int shift{}; shift < 32; shift += 8) result |= static_cast<uint32_t>(u8()) << shift; return result; }
+  uint64_t u64() noexcept { uint64_t result{}; for (int shift{}; shift < 64; shift += 8) result |= static_cast<uint64_t>(u8()) << shift; return result; }
+  int32_t i32() noexcept { return static_cast<int32_t>(u32()); }
+  bool flag() noexcept { return 0 != u8(); }
+  String text() noexcept
+  {
+    auto length{ u32() };
+    if (length > input_.size()) {
+      failed_ = true;
+      return {};
+    }
+    String result{ input_.substr(0, length) };
+    input_.remove_prefix(length);
+    return result;
+  }
+
+  // an enum is only accepted when it is one this build knows about
+  template <typename TEnum, typename TTraits>
+  TEnum enumeration() noexcept
+  {
+    auto value{ u32() };
+    if (value >= TTraits::Total())
+      failed_ = true;
+    return failed_ ? TEnum{} : static_cast<TEnum>(value);
+  }
+};
+
+//-----------------------------------------------------------------------------
+template <typename T>
+std::vector<T> unstack(std::stack<T> stack) noexcept
+{
+  std::vector<T> result;
+  for (; !stack.empty(); stack.pop())
+    result.push_back(stack.top());
+  std::reverse(result.begin(), result.end());
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+template <typename T, typename TWrite>
+void writeStack(Writer& writer, const std::stack<T>& stack, TWrite&& write) noexcept
+{
+  auto values{ unstack(stack) };
+  writer.u32(static_cast<uint32_t>(values.size()));
+  for (auto& value : values)
+    write(value);
+}
+
+//-----------------------------------------------------------------------------
+template <typename T, typename TRead>
+void readStack(Reader& reader, std::stack<T>& stack, TRead&& read) noexcept
+{
+  stack = {};
+  auto total{ reader.u32() };
+  for (uint32_t loop{}; (loop < total) && (!reader.failed_); ++loop) {
+    T value{};
+    read(value);
+    stack.push(value);
+  }
+}
+
+//-----------------------------------------------------------------------------
+template <typename TFaults>
+bool writeFaults(Writer& writer, const TFaults& faults) noexcept
+{
+  // the owner of a lock only exists in the process that took it
+  bool locked{};
+  auto write{ [&](const typename TFaults::StateArray& states) noexcept {
+    for (auto& state : states) {
+      locked = locked || state.locked_;
+      writer.flag(state.defaultEnabled_);
+      writer.flag(state.defaultForceError_);
+      writer.flag(state.enabled_);
+      writer.flag(state.forceError_);
+    }
+  } };
+  write(faults.current_);
+  writeStack(writer, faults.stack_, write);
+  return !locked;
+}
+
+//-----------------------------------------------------------------------------
+template <typename TFaults>
+void readFaults(Reader& reader, TFaults& faults) noexcept
+{
+  auto read{ [&](typename TFaults::StateArray& states) noexcept {
+    for (auto& state : states) {
+      state = {};
+      state.defaultEnabled_ = reader.flag();
+      state.defaultForceError_ = reader.flag();
+      state.enabled_ = reader.flag();
+      state.forceError_ = reader.flag();
+    }
+  } };
+  read(faults.current_);
+  readStack(reader, faults.stack_, read);
+}
+
+//-----------------------------------------------------------------------------
+bool isRealPath(const SourceTypes::FilePath& filePath) noexcept
+{
+  auto source{ filePath.source_.lock() };
+  return (source) && (source->realPath_.get() == &filePath);
+}
+
+//-----------------------------------------------------------------------------
+void writeFilePath(Writer& writer, const SourceTypes::FilePath& filePath) noexcept
+{
+  writer.text(filePath.filePath_);
+  writer.text(filePath.fullFilePath_);
+  writer.flag(isRealPath(filePath));
+}
+
+//-----------------------------------------------------------------------------
+SourceTypes::FilePathPtr readFilePath(Reader& reader, const ParseResultCache::ResolveFilePath& resolve) noexcept
+{
+  auto filePath{ reader.text() };
+  auto fullFilePath{ reader.text() };
+  auto realPath{ reader.flag() };
+  return resolve(filePath, fullFilePath, realPath);
+}
+
+//-----------------------------------------------------------------------------
+void writeOrigin(Writer& writer, const SourceTypes::Origin& origin) noexcept
+{
+  writer.flag(static_cast<bool>(origin.filePath_));
+  if (origin.filePath_)
+    writeFilePath(writer, *origin.filePath_);
+  writer.i32(origin.location_.line_);
+  writer.i32(origin.location_.column_);
+}
+
+//-----------------------------------------------------------------------------
+void readOrigin(Reader& reader, SourceTypes::Origin& origin, const ParseResultCache::ResolveFilePath& resolve) noexcept
+{
+  origin = {};
+  if (reader.flag())
+    origin.filePath_ = readFilePath(reader, resolve);
+  origin.location_.line_ = reader.i32();
+  origin.location_.column_ = reader.i32();
+}
+
+//-----------------------------------------------------------------------------
+void writeVersion(Writer& writer, const std::optional<SemanticVersion>& version) noexcept
+{
+  writer.flag(static_cast<bool>(version));
+  if (!version)
+    return;
+  writer.i32(version->major_);
+  writer.i32(version->minor_);
+  writer.i32(version->patch_);
+  writer.text(version->preRelease_);
+  writer.text(version->build_);
+}
+
+//-----------------------------------------------------------------------------
+void readVersion(Reader& reader, std::optional<SemanticVersion>& version) noexcept
+{
+  version.reset();
+  if (!reader.flag())
+    return;
+  version.emplace();
+  version->major_ = reader.i32();
+  version->minor_ = reader.i32();
+  version->patch_ = reader.i32();
+  version->preRelease_ = reader.text();
+  version->build_ = reader.text();
+}
+
+//-----------------------------------------------------------------------------
+bool writeState(Writer& writer, const CompileState& state) noexcept
+{
+  bool result{ writeFaults(writer, state.errors_) };
+  result = writeFaults(writer, state.panics_) && result;
+  result = writeFaults(writer, state.warnings_) && result;
+
+  auto variableDefaults{ [&](const CompileState::VariableDefaults& value) noexcept { writer.flag(value.varies_); writer.flag(value.mutable_); } };
+  auto typeDefaults{ [&](const CompileState::TypeDefaults& value) noexcept { writer.flag(value.mutable_); writer.flag(value.constant_); } };
+  auto functionDefaults{ [&](const CompileState::FunctionDefaults& value) noexcept { writer.flag(value.constant_); } };
+  auto exports{ [&](const CompileState::Export& value) noexcept { writer.flag(value.export_); } };
+
+  variableDefaults(state.variableDefaults_);
+  typeDefaults(state.typeDefaults_);
+  functionDefaults(state.functionDefaults_);
+  exports(state.export_);
+
+  writer.flag(static_cast<bool>(state.deprecate_));
+  if (state.deprecate_) {
+    writeOrigin(writer, state.deprecate_->origin_);
+    writer.u32(static_cast<uint32_t>(state.deprecate_->context_));
+    writer.flag(state.deprecate_->forceError_);
+    writeVersion(writer, state.deprecate_->min_);
+    writeVersion(writer, state.deprecate_->max_);
+  }
+
+  writeStack(writer, state.variableDefaultsStack_, variableDefaults);
+  writeStack(writer, state.typeDefaultsStack_, typeDefaults);
+  writeStack(writer, state.functionDefaultsStack_, functionDefaults);
+  writeStack(writer, state.exportStack_, exports);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+CompileStatePtr readState(Reader& reader, const ParseResultCache::ResolveFilePath& resolve) noexcept
+{
+  auto state{ std::make_shared<CompileState>() };
+  readFaults(reader, state->errors_);
+  readFaults(reader, state->panics_);
+  readFaults(reader, state->warnings_);
+
+  auto variableDefaults{ [&](CompileState::VariableDefaults& value) noexcept { value.varies_ = reader.flag(); value.mutable_ = reader.flag(); } };
+  auto typeDefaults{ [&](CompileState::TypeDefaults& value) noexcept { value.mutable_ = reader.flag(); value.constant_ = reader.flag(); } };
+  auto functionDefaults{ [&](CompileState::FunctionDefaults& value) noexcept { value.constant_ = reader.flag(); } };
+  auto exports{ [&](CompileState::Export& value) noexcept { value.export_ = reader.flag(); } };
+
+  variableDefaults(state->variableDefaults_);
+  typeDefaults(state->typeDefaults_);
+  functionDefaults(state->functionDefaults_);
+  exports(state->export_);
+
+  if (reader.flag()) {
+    auto& deprecate{ state->deprecate_.emplace() };
+    readOrigin(reader, deprecate.origin_, resolve);
+    deprecate.context_ = reader.enumeration<CompileState::Deprecate::Context, CompileState::Deprecate::ContextTraits>();
+    deprecate.forceError_ = reader.flag();
+    readVersion(reader, deprecate.min_);
+    readVersion(reader, deprecate.max_);
+  }
+
+  readStack(reader, state->variableDefaultsStack_, variableDefaults);
+  readStack(reader, state->typeDefaultsStack_, typeDefaults);
+  readStack(reader, state->functionDefaultsStack_, functionDefaults);
+  readStack(reader, state->exportStack_, exports);
+  return state;
+}
+
+//-----------------------------------------------------------------------------
+void writeAliases(Writer& writer, const std::map<String, TokenConstPtr>& aliases, const std::function<void(const TokenConstPtr&)>& token) noexcept
+{
+  writer.u32(static_cast<uint32_t>(aliases.size()));
+  for (auto& [name, value] : aliases) {
+    writer.text(name);
+    token(value);
+  }
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+struct IndexTable
+{
+  std::vector<const T*> values_;
+  std::unordered_map<const T*, uint32_t> indexes_;
+
+  uint32_t operator()(const T* value) noexcept
+  {
+    if (!value)
+      return NoIndex;
+    auto [iter, added] { indexes_.try_emplace(value, static_cast<uint32_t>(values_.size())) };
+    if (added)
+      values_.push_back(value);
+    return iter->second;
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Tokens share their file paths and states so both are written once into a
+// table ahead of the entries; sharing is kept on replay as diagnostics tell
+// a token's actual origin apart from its origin by file path identity.
+struct ResultWriter
+{
+  Writer body_;
+  IndexTable<SourceTypes::FilePath> filePaths_;
+  IndexTable<CompileState> states_;
+
+  void state(const CompileStateConstPtr& state) noexcept { body_.u32(states_(state.get())); }
+
+  void origin(const SourceTypes::Origin& origin) noexcept
+  {
+    body_.u32(filePaths_(origin.filePath_.get()));
+    body_.i32(origin.location_.line_);
+    body_.i32(origin.location_.column_);
+  }
+
+  void token(const TokenConstPtr& token) noexcept
+  {
+    body_.flag(static_cast<bool>(token));
+    if (!token)
+      return;
+    body_.u32(static_cast<uint32_t>(token->type_));
+    body_.u32(static_cast<uint32_t>(token->operator_));
+    body_.flag(static_cast<bool>(token->keyword_));
+    if (token->keyword_)
+      body_.u32(static_cast<uint32_t>(*token->keyword_));
+    body_.flag(token->forcedSeparator_);
+    body_.text(token->originalToken_);
+    body_.text(token->token_);
+    origin(token->origin_);
+    origin(token->actualOrigin_);
+    state(token->compileState_);
+  }
+
+  void write(const ParseResult& result) noexcept
+  {
+    body_.u32(static_cast<uint32_t>(result.entries_.size()));
+    for (auto& entry : result.entries_) {
+      body_.u8(static_cast<uint8_t>(entry.kind_));
+      switch (entry.kind_) {
+        case Kind::Diagnostic: {
+          auto& diagnostic{ entry.diagnostic_ };
+          body_.u8(static_cast<uint8_t>(diagnostic.kind_));
+          body_.u32(static_cast<uint32_t>(diagnostic.error_));
+          body_.u32(static_cast<uint32_t>(diagnostic.warning_));
+          body_.u32(static_cast<uint32_t>(diagnostic.info_));
+          token(diagnostic.token_);
+          body_.u32(static_cast<uint32_t>(diagnostic.mapping_.size()));
+          for (auto& [name, value] : diagnostic.mapping_) {
+            body_.text(name);
+            body_.text(value);
+          }
+          break;
+        }
+        case Kind::Source:
+        case Kind::Asset: {
+          auto& request{ entry.request_ };
+          token(request.token_);
+          state(request.compileState_);
+          body_.text(request.filePath_);
+          body_.text(request.fullFilePath_);
+          body_.text(request.renameFilePath_);
+          body_.u32(static_cast<uint32_t>(request.required_));
+          body_.flag(request.generated_);
+          body_.i32(request.parentTabStopWidth_);
+          break;
+        }
+        case Kind::Yield: break;
+        case Kind::Apply: state(entry.state_); break;
+      }
+    }
+    state(result.state_);
+
+    auto writeToken{ [&](const TokenConstPtr& value) noexcept { token(value); } };
+    writeAliases(body_, result.aliasing_.keywords_, writeToken);
+    writeAliases(body_, result.aliasing_.operators_, writeToken);
+  }
+};
+
+//-----------------------------------------------------------------------------
+struct ResultReader
+{
+  Reader& reader_;
+  ParseResult& result_;
+  const ParseResultCache::ResolveFilePath& resolve_;
+  std::vector<SourceTypes::FilePathPtr> filePaths_;
+  std::vector<CompileStatePtr> states_;
+
+  template <typename T>
+  T lookup(const std::vector<T>& table) noexcept
+  {
+    auto index{ reader_.u32() };
+    if (NoIndex == index)
+      return {};
+    if (index >= table.size()) {
+      reader_.failed_ = true;
+      return {};
+    }
+    return table[index];
+  }
+
+  CompileStatePtr state() noexcept { return lookup(states_); }
+
+  void origin(SourceTypes::Origin& origin) noexcept
+  {
+    origin.filePath_ = lookup(filePaths_);
+    origin.location_.line_ = reader_.i32();
+    origin.location_.column_ = reader_.i32();
+  }
+
+  StringView intern(String&& text) noexcept
+  {
+    return result_.strings_.emplace_back(std::move(text));
+  }
+
+  TokenPtr token() noexcept
+  {
+    if (!reader_.flag())
+      return {};
+    auto result{ std::make_shared<Token>() };
+    result->type_ = reader_.enumeration<TokenTypes::Type, TokenTypes::TypeTraits>();
+    result->operator_ = reader_.enumeration<TokenTypes::Operator, TokenTypes::OperatorTraits>();
+    if (reader_.flag())
+      result->keyword_ = reader_.enumeration<TokenTypes::Keyword, TokenTypes::KeywordTraits>();
+    result->forcedSeparator_ = reader_.flag();
+    result->originalToken_ = intern(reader_.text());
+    result->token_ = intern(reader_.text());
+    origin(result->origin_);
+    origin(result->actualOrigin_);
+    result->compileState_ = state();
+    return result;
+  }
+
+  void aliases(std::map<String, TokenConstPtr>& aliases) noexcept
+  {
+    auto total{ reader_.u32() };
+    for (uint32_t loop{}; (loop < total) && (!reader_.failed_); ++loop) {
+      auto name{ reader_.text() };
+      aliases[name] = token();
+    }
+  }
+
+  [[nodiscard]] bool read() noexcept
+  {
+    auto totalFilePaths{ reader_.u32() };
+    for (uint32_t loop{}; (loop < totalFilePaths) && (!reader_.failed_); ++loop)
+      filePaths_.push_back(readFilePath(reader_, resolve_));
+
+    auto totalStates{ reader_.u32() };
+    for (uint32_t loop{}; (loop < totalStates) && (!reader_.failed_); ++loop)
+      states_.push_back(readState(reader_, resolve_));
+
+    auto totalEntries{ reader_.u32() };
+    for (uint32_t loop{}; (loop < totalEntries) && (!reader_.failed_); ++loop) {
+      auto& entry{ result_.entries_.emplace_back() };
+      entry.kind_ = static_cast<Kind>(reader_.u8());
+      switch (entry.kind_) {
+        case Kind::Diagnostic: {
+          auto& diagnostic{ entry.diagnostic_ };
+          diagnostic.kind_ = static_cast<BufferedKind>(reader_.u8());
+          diagnostic.error_ = reader_.enumeration<ErrorTypes::Error, ErrorTypes::ErrorTraits>();
+          diagnostic.warning_ = reader_.enumeration<WarningTypes::Warning, WarningTypes::WarningTraits>();
+          diagnostic.info_ = reader_.enumeration<InformationalTypes::Informational, InformationalTypes::InformationalTraits>();
+          diagnostic.token_ = token();
+          auto totalMappings{ reader_.u32() };
+          for (uint32_t mapping{}; (mapping < totalMappings) && (!reader_.failed_); ++mapping) {
+            auto name{ reader_.text() };
+            diagnostic.mapping_[name] = reader_.text();
+          }
+          switch (diagnostic.kind_) {
+            case BufferedKind::Fatal:
+            case BufferedKind::Error:
+            case BufferedKind::Warning:
+            case BufferedKind::Informational:   break;
+            default:                            reader_.failed_ = true; break;
+          }
+          if (!diagnostic.token_)
+            reader_.failed_ = true;
+          break;
+        }
+        case Kind::Source:
+        case Kind::Asset: {
+          auto& request{ entry.request_ };
+          request.token_ = token();
+          request.compileState_ = state();
+          request.filePath_ = reader_.text();
+          request.fullFilePath_ = reader_.text();
+          request.renameFilePath_ = reader_.text();
+          request.required_ = reader_.enumeration<ParserDirectiveTypes::SourceAssetRequired, ParserDirectiveTypes::SourceAssetRequiredTraits>();
+          request.generated_ = reader_.flag();
+          request.parentTabStopWidth_ = reader_.i32();
+          if ((!request.token_) || (!request.token_->actualOrigin_.filePath_) || (!request.compileState_))
+            reader_.failed_ = true;
+          break;
+        }
+        case Kind::Yield:   break;
+        case Kind::Apply: {
+          entry.state_ = state();
+          if (!entry.state_)
+            reader_.failed_ = true;
+          break;
+        }
+        default:            reader_.failed_ = true; break;
+      }
+    }
+    result_.state_ = state();
+
+    aliases(result_.aliasing_.keywords_);
+    aliases(result_.aliasing_.operators_);
+    return (!reader_.failed_) && (reader_.input_.empty()) && (result_.state_);
+  }
+};
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+ParseResultCache::ParseResultCache(StringView directory) noexcept :
+  directory_{ directory }
+{
+}
+
+//-----------------------------------------------------------------------------
+std::optional<String> ParseResultCache::key(
+  const ParserDirectiveTypes::SourceAsset& pending,
+  const std::byte* contents,
+  size_t length,
+  const Context::Aliasing& visible) noexcept
+{
+  if (!pending.compileState_)
+    return {};
+
+  Writer writer;
+  writer.text(Version::version());
+  writer.u32(FormatVersion);
+  writer.text(pending.filePath_);
+  writer.text(pending.fullFilePath_);
+  writer.i32(pending.parentTabStopWidth_);
+
+  // a replay trusts the key completely so the bytes enter it as a digest
+  auto digest{ Sha256::hash(contents, length) };
+  writer.text(StringView{ reinterpret_cast<const char*>(digest.data()), digest.size() });
+  writer.u64(length);
+
+  if (!writeState(writer, *pending.compileState_))
+    return {};
+
+  auto spelling{ [&](const TokenConstPtr& token) noexcept { writer.text(token ? token->token_ : StringView{}); } };
+  writeAliases(writer, visible.keywords_, spelling);
+  writeAliases(writer, visible.operators_, spelling);
+  return std::move(writer.output_);
+}
+
+//-----------------------------------------------------------------------------
+ParseResultPtr ParseResultCache::find(const String& key, const ResolveFilePath& resolve) noexcept
+{
+  auto [contents, length] { readBinaryFile(filePath(key).string()) };
+  if (!contents) {
+    ++misses_;
+    return {};
+  }
+
+  Reader reader{ StringView{ reinterpret_cast<const char*>(contents.get()), length } };
+  auto result{ std::make_shared<ParseResult>() };
+  result->key_ = key;
+  result->replay_ = true;
+
+  // the file name is only a hash of the key so the whole key must match
+  bool matched{ Magic == reader.input_.substr(0, Magic.size()) };
+  if (matched) {
+    reader.input_.remove_prefix(Magic.size());
+    matched = (FormatVersion == reader.u32()) && (key == reader.text()) && (!reader.failed_);
+  }
+  if ((!matched) || (!ResultReader{ reader, *result, resolve }.read())) {
+    ++misses_;
+    return {};
+  }
+
+  ++hits_;
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+bool ParseResultCache::store(const ParseResult& result) noexcept
+{
+  ResultWriter encoder;
+  encoder.write(result);
+
+  Writer writer;
+  writer.output_.append(Magic);
+  writer.u32(FormatVersion);
+  writer.text(result.key_);
+  writer.u32(static_cast<uint32_t>(encoder.filePaths_.values_.size()));
+  for (auto filePath : encoder.filePaths_.values_)
+    writeFilePath(writer, *filePath);
+  writer.u32(static_cast<uint32_t>(encoder.states_.values_.size()));
+  for (auto state : encoder.states_.values_) {
+    if (!writeState(writer, *state))
+      return false;
+  }
+  writer.output_.append(encoder.body_.output_);
+
+  std::error_code ec;
+  std::filesystem::create_directories(directory_, ec);
+
+  // written aside and renamed so a concurrent reader never sees half a file
+  auto target{ filePath(result.key_) };
+  auto temporary{ target };
+  temporary += "." + std::to_string(puid());
+  if (!writeBinaryFile(temporary.string(), writer.output_))
+    return false;
+
+  std::filesystem::rename(temporary, target, ec);
+  if (ec) {
+    std::filesystem::remove(temporary, ec);
+    return false;
+  }
+  ++stored_;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+Path ParseResultCache::filePath(const String& key) const noexcept
+{
+  return directory_ / (Sha256::toHex(Sha256::hash(key)) + String{ FileExtension });
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "types.h"
+#include "Context.h"
+#include "ParserTypes.h"
+#include "ParserDirectiveTypes.h"
+
+namespace zax
+{
+
+// What parsing one source produced in the order it was produced: the
+// diagnostics raised, the [[source]] and [[asset]] requests made and the
+// points where parsing yielded to the requested sources. Requests are kept
+// unresolved so wildcards and missing files are looked up again on replay.
+// The final state and the declared aliases are applied once replay ends.
+struct ParseResult
+{
+  enum class Kind : uint8_t
+  {
+    Diagnostic,
+    Source,
+    Asset,
+    Yield,
+    Apply     // a fault directive reached the includers' already lexed tokens
+  };
+
+  struct Entry
+  {
+    Kind kind_{};
+    ParserTypes::BufferedDiagnostic diagnostic_;
+    ParserDirectiveTypes::SourceAsset request_;
+    CompileStatePtr state_;
+  };
+
+  String key_;
+  std::vector<Entry> entries_;
+  CompileStatePtr state_;
+  Context::Aliasing aliasing_;
+  std::deque<String> strings_;    // text of the replayed tokens
+
+  size_t next_{};
+  bool replay_{};
+};
+
+// Keeps parse results on disk between runs. A source's parse result only
+// depends on its bytes, its path, the state it inherits and the aliases it
+// can see so those make up the key; a warm rebuild of an unchanged source
+// replays the stored result without lexing or parsing it. Anything that
+// cannot be reproduced exactly (e.g. a locked fault whose owner only exists
+// in the process that locked it) is simply not cached.
+struct ParseResultCache
+{
+  constexpr static StringView FileExtension{ ".zpr" };
+
+  // maps a stored file path back onto a live one; a source's real path must
+  // resolve to that source's own path so tokens still reach the source
+  using ResolveFilePath = std::function<SourceTypes::FilePathPtr(const String& filePath, const String& fullFilePath, bool realPath)>;
+
+  const Path directory_;
+  size_t hits_{};
+  size_t misses_{};
+  size_t stored_{};
+
+  ParseResultCache(StringView directory) noexcept;
+
+  ParseResultCache(const ParseResultCache&) noexcept = delete;
+  ParseResultCache(ParseResultCache&&) noexcept = delete;
+
+  ParseResultCache& operator=(const ParseResultCache&) noexcept = delete;
+  ParseResultCache& operator=(ParseResultCache&&) noexcept = delete;
+
+  [[nodiscard]] static std::optional<String> key(
+    const ParserDirectiveTypes::SourceAsset& pending,
+    const std::byte* contents,
+    size_t length,
+    const Context::Aliasing& visible) noexcept;
+
+  [[nodiscard]] ParseResultPtr find(const String& key, const ResolveFilePath& resolve) noexcept;
+  [[nodiscard]] bool store(const ParseResult& result) noexcept;
+
+  [[nodiscard]] Path filePath(const String& key) const noexcept;
+};
+
+} // namespace zax
@@ -1,10 +1,13 @@
 #include "pch.h"
 #include "Parser.h"
+#include "AssetCopier.h"
 #include "CompilerException.h"
 #include "CompileState.h"
 #include "Context.h"
+#include "Module.h"
 #include "OperatorLut.h"
 #include "Source.h"
+#include "SourceCache.h"
 #include "Tokenizer.h"
 
 using namespace zax;
@@ -17,25 +20,28 @@ Parser::Parser(
   const Config& config,
   Callbacks* callbacks) noexcept :
   config_{ config },
-  operatorLut_{ std::make_shared<OperatorLut>() }
+  operatorLut_{ OperatorLut::shared() }
 {
   if (!callbacks) {
-    callbacks_.fatal_ = [](Error error, const TokenConstPtr& token, const StringMap& mapping) noexcept {
+    callbacks_.fatal_ = [](Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept {
       zax::fatal(error, token, mapping);
     };
-    callbacks_.error_ = [](Error error, const TokenConstPtr& token, const StringMap& mapping) noexcept {
+    callbacks_.error_ = [](Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept {
       zax::output(error, token, mapping);
     };
-    callbacks_.warning_ = [](Warning warning, const TokenConstPtr& token, const StringMap& mapping) noexcept {
+    callbacks_.warning_ = [](Warning warning, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept {
       zax::output(warning, token, mapping);
     };
-    callbacks_.info_ = [](Informational info, const TokenConstPtr& token, const StringMap& mapping) noexcept {
+    callbacks_.info_ = [](Informational info, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept {
       zax::output(info, token, mapping);
     };
-    callbacks_.shouldAbort_ = []() noexcept -> bool { return zax::shouldAbort(); };
+    callbacks_.cancellation_ = zax::cancellation();
   }
   else
     callbacks_ = std::move(*callbacks);
+
+  if (!callbacks_.cancellation_)
+    callbacks_.cancellation_ = std::make_shared<CancellationToken>();
 }
 
 //-----------------------------------------------------------------------------
@@ -56,8 +62,7 @@ void Parser::parse() noexcept
     }
   } };
   if (!rootContext_) {
-    rootContext_ = std::make_shared<Context>();
-    rootContext_->thisWeak_ = rootContext_;
+    rootContext_ = contextPool_.create();
     rootContext_->state_ = std::make_shared<CompileState>();
     fixWarningDefault(rootContext_->state_->warnings_);
     rootContext_->owner_ = id_;
@@ -65,6 +70,17 @@ void Parser::parse() noexcept
     rootContext_->module_ = module_.get();
   }
 
+  if ((!listing_) && (!config_.listingFilePath_.empty()))
+    listing_ = std::make_unique<ListingWriter>(config_.listingFilePath_);
+
+  // a listing shows every line parsed so nothing is replayed while writing one
+  if ((!parseCache_) && (!listing_) && (!config_.parseCachePath_.empty()))
+    parseCache_ = std::make_unique<ParseResultCache>(config_.parseCachePath_);
+
+  // a listing follows the serial parse order so it keeps every source here
+  if ((config_.sourceWorkers_ > 1) && (config_.inputFilePaths_.size() > 1) && (!listing_))
+    parseSourcesInParallel();
+
   while (!shouldAbort()) {
     prime();
     processAssets();
@@ -72,15 +88,49 @@ void Parser::parse() noexcept
     if (sources_.empty())
       break;
 
+    auto source{ sources_.front() };
+    if (bufferedDiagnostics_)
+      bufferedDiagnostics_->enter(source);
+
     auto& tokenizer{ getSourceTokenizer() };
-    if (tokenizer.empty()) {
-      processedSources_.push_back(sources_.front());
-      sources_.pop_front();
-      continue;
+    if (listing_)
+      listing_->enter(*source);
+
+    bool finished{};
+    if ((source->parseResult_) && (source->parseResult_->replay_)) {
+      finished = replay(*source);
+    }
+    else {
+      recording_ = source->parseResult_.get();
+      finished = tokenizer.empty();
+      if (!finished) {
+        process(getSourceContext());
+        if ((recording_) && ((pendingSources_.size() > 0) || (pendingAssets_.size() > 0)))
+          recording_->entries_.push_back(ParseResult::Entry{ .kind_ = ParseResult::Kind::Yield });
+      }
+      recording_ = nullptr;
+      if (finished)
+        store(*source);
     }
 
-    process(getSourceContext());
+    if (!finished)
+      continue;
+
+    if (bufferedDiagnostics_)
+      bufferedDiagnostics_->leave(source);
+    if (listing_)
+      listing_->leave(*source);
+    processedSources_.push_back(source);
+    sources_.pop_front();
   }
+
+  if ((listing_) && (!listing_->close()))
+    out(Error::OutputFailure, makeInternalToken(rootContext_->state()), DiagnosticArguments{ {"$file$", config_.listingFilePath_} });
+
+  auto& probedFiles{ fileSystemCache_.probedFiles_ };
+  auto& listedDirectories{ fileSystemCache_.listedDirectories_ };
+  dependencies_.probedFiles_.insert(probedFiles.begin(), probedFiles.end());
+  dependencies_.listedDirectories_.insert(listedDirectories.begin(), listedDirectories.end());
 }
 
 //-----------------------------------------------------------------------------
@@ -90,15 +140,309 @@ void Parser::process(Context& context) noexcept
     if ((pendingSources_.size() > 0) || (pendingAssets_.size()> 0))
       break;
 
-    if (consumeSeparators(context, false)) {
-      context.singleLineState_ = {};
-      continue;
+    auto iter{ context->begin() };
+    switch (classifyStatement(context, iter)) {
+      case StatementLead::Separator: {
+        (void)consumeSeparators(context, false);
+        context.singleLineState_ = {};
+        break;
+      }
+      case StatementLead::Directive:    (void)consumeLineParserDirective(context, iter); break;
+      case StatementLead::Declaration:  (void)consumeAlias(context, iter); break;
+      case StatementLead::Unknown:      break;
     }
-    if (consumeLineParserDirective(context))
-      continue;
-    if (consumeAlias(context))
+  }
+}
+
+//-----------------------------------------------------------------------------
+ModulePtr Parser::import(const String& name, StringView interfaceFilePath) noexcept
+{
+  if (auto found{ imports_.find(name) }; imports_.end() != found)
+    return found->second;
+
+  auto moduleInterface{ ModuleInterface::open(interfaceFilePath) };
+  if (!moduleInterface)
+    return {};
+
+  auto result{ std::make_shared<Module>() };
+  result->interface_ = std::move(moduleInterface);
+  imports_[name] = result;
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+ParserTypes::StatementLead Parser::classifyStatement(const Context& context, Tokenizer::iterator iter) noexcept
+{
+  auto token{ *iter };
+  if (!token)
+    return StatementLead::Unknown;
+
+  if (isSeparator(token))
+    return StatementLead::Separator;
+
+  if (isOperator(context, token, Operator::DirectiveOpen))
+    return StatementLead::Directive;
+
+  if ((isLiteral(token)) && (isOperator(context, *(iter + 1), Operator::MetaDeclare)))
+    return StatementLead::Declaration;
+
+  return StatementLead::Unknown;
+}
+
+//-----------------------------------------------------------------------------
+void Parser::parseSourcesInParallel() noexcept
+{
+  // Every command line source only inherits the root state so each one is
+  // parsed by its own worker parser. The worker diagnostics are replayed
+  // afterwards in the order a serial parse would have reported them.
+  std::vector<ParserPtr> workers;
+  std::vector<SourceAsset> inputs;
+
+  auto budget{ std::make_shared<DiagnosticBudget>() };
+  budget->errors_ = maxErrors() - totalErrors();
+  budget->warnings_ = maxWarnings() ? (*maxWarnings() - totalWarnings()) : std::numeric_limits<int>::max();
+
+  for (auto& file : config_.inputFilePaths_) {
+    inputs.push_back(makeCommandLineSource(file));
+  }
+
+  for (auto& file : config_.inputFilePaths_) {
+    Config config{ config_ };
+    config.inputFilePaths_ = { file };
+    config.sourceWorkers_ = 1;
+
+    auto worker{ std::make_shared<Parser>(config) };
+    worker->callbacks_.cancellation_ = callbacks_.cancellation_;
+    worker->bufferDiagnostics(budget);
+    worker->importer_ = importer_;
+    worker->module_ = module_;
+
+    // a serial parse has already claimed every other command line source
+    auto ownIdentity{ fileSystemCache_.identity(inputs[workers.size()].filePath_) };
+    for (auto& input : inputs) {
+      auto identity{ fileSystemCache_.identity(input.filePath_) };
+      if ((identity) ? (identity != ownIdentity) : (input.fullFilePath_ != inputs[workers.size()].fullFilePath_))
+        (void)worker->includedSources_.insert(identity, input.fullFilePath_);
+    }
+    workers.push_back(worker);
+  }
+  config_.inputFilePaths_.clear();
+
+  {
+    std::atomic<size_t> next{};
+    std::vector<std::thread> threads;
+    auto totalThreads{ std::min(static_cast<size_t>(config_.sourceWorkers_), workers.size()) };
+    for (size_t loop{}; loop < totalThreads; ++loop) {
+      threads.emplace_back([&]() noexcept {
+        for (auto index{ next++ }; index < workers.size(); index = next++)
+          workers[index]->parse();
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+  sourceParsers_.insert(sourceParsers_.end(), workers.begin(), workers.end());
+  for (auto& worker : workers)
+    dependencies_.merge(worker->dependencies_);
+
+  // a worker only cancelled early so the replay in serial order decides
+  // what is reported and whether the parse stops
+  using Reason = CancellationToken::Reason;
+  auto& cancellation{ *callbacks_.cancellation_ };
+  auto workerReason{ cancellation.reason() };
+  if ((Reason::None != workerReason) && (Reason::Requested != workerReason))
+    cancellation.reset();
+  if (shouldAbort())
+    return;
+
+  replayWorkers(workers);
+
+  // workers cut short still leave the parse incomplete
+  if ((Reason::None != workerReason) && (!shouldAbort()))
+    (void)cancellation.cancel(workerReason);
+}
+
+//-----------------------------------------------------------------------------
+void Parser::replayWorkers(std::vector<ParserPtr>& workers) noexcept
+{
+  using Kind = BufferedDiagnostic::Kind;
+
+  // a serial parse loads every command line source before parsing any so
+  // their load failures and ownership are resolved first
+  std::vector<size_t> firstEntered;
+  std::vector<bool> owners;
+  for (auto& worker : workers) {
+    auto& entries{ worker->bufferedDiagnostics_->entries_ };
+    size_t index{};
+    for (; index < entries.size(); ++index) {
+      auto& entry{ entries[index] };
+      if (Kind::EnterSource == entry.kind_)
+        break;
+      if (Kind::Poll != entry.kind_)
+        replay(entry);
+    }
+    firstEntered.push_back(index);
+    owners.push_back((index < entries.size()) && (include(*(entries[index].source_))));
+  }
+
+  for (size_t loop{}; loop < workers.size(); ++loop) {
+    if (!owners[loop])
       continue;
+
+    auto& entries{ workers[loop]->bufferedDiagnostics_->entries_ };
+    size_t skipDepth{};
+    for (auto index{ firstEntered[loop] }; index < entries.size(); ++index) {
+      auto& entry{ entries[index] };
+      if (skipDepth > 0) {
+        if (Kind::EnterSource == entry.kind_)
+          ++skipDepth;
+        if (Kind::LeaveSource == entry.kind_)
+          --skipDepth;
+        continue;
+      }
+
+      switch (entry.kind_) {
+        case Kind::Poll: {
+          if (shouldAbort())
+            return;
+          break;
+        }
+        case Kind::EnterSource: {
+          // a serial parse polls before it enters each source
+          if (shouldAbort())
+            return;
+          // another worker already parsed this source, as would a serial parse
+          if ((index != firstEntered[loop]) &&
+              (!include(*(entry.source_))))
+            skipDepth = 1;
+          break;
+        }
+        case Kind::LeaveSource: {
+          processedSources_.push_back(entry.source_);
+          break;
+        }
+        default: {
+          replay(entry);
+          break;
+        }
+      }
+    }
+    entries.clear();
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool Parser::include(const Source& source) noexcept
+{
+  return includedSources_.insert(source.identity_, source.realPath_->fullFilePath_, source.contentKey_);
+}
+
+//-----------------------------------------------------------------------------
+void Parser::bufferDiagnostics(const DiagnosticBudgetPtr& budget) noexcept
+{
+  using Kind = BufferedDiagnostic::Kind;
+  using Reason = CancellationToken::Reason;
+
+  bufferedDiagnostics_ = std::make_unique<BufferedDiagnostics>();
+  auto buffer{ bufferedDiagnostics_.get() };
+  auto cancellation{ callbacks_.cancellation_ };
+
+  callbacks_.fatal_ = [buffer, cancellation](Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept {
+    buffer->push(BufferedDiagnostic{ .kind_ = Kind::Fatal, .error_ = error, .token_ = token, .mapping_ = mapping });
+    (void)cancellation->cancel(Reason::Fatal);
+  };
+  callbacks_.error_ = [buffer, cancellation, budget](Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept {
+    buffer->push(BufferedDiagnostic{ .kind_ = Kind::Error, .error_ = error, .token_ = token, .mapping_ = mapping });
+    if (budget->errors_.fetch_sub(1, std::memory_order_relaxed) <= 0)
+      (void)cancellation->cancel(Reason::TooManyErrors);
+  };
+  callbacks_.warning_ = [buffer, cancellation, budget](Warning warning, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept {
+    buffer->push(BufferedDiagnostic{ .kind_ = Kind::Warning, .warning_ = warning, .token_ = token, .mapping_ = mapping });
+    if (budget->warnings_.fetch_sub(1, std::memory_order_relaxed) <= 0)
+      (void)cancellation->cancel(Reason::TooManyWarnings);
+  };
+  callbacks_.info_ = [buffer](Informational info, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept {
+    buffer->push(BufferedDiagnostic{ .kind_ = Kind::Informational, .info_ = info, .token_ = token, .mapping_ = mapping });
+  };
+}
+
+//-----------------------------------------------------------------------------
+void ParserTypes::BufferedDiagnostics::enter(const SourcePtr& source) noexcept
+{
+  if (!enteredSources_.insert(source->id_).second)
+    return;
+  entries_.push_back(BufferedDiagnostic{ .kind_ = BufferedDiagnostic::Kind::EnterSource, .source_ = source });
+}
+
+//-----------------------------------------------------------------------------
+void Parser::replay(const BufferedDiagnostic& entry) noexcept
+{
+  using Kind = BufferedDiagnostic::Kind;
+
+  switch (entry.kind_) {
+    case Kind::Fatal:           callbacks_.fatal_(entry.error_, entry.token_, entry.mapping_); break;
+    case Kind::Error:           callbacks_.error_(entry.error_, entry.token_, entry.mapping_); break;
+    case Kind::Warning:         callbacks_.warning_(entry.warning_, entry.token_, entry.mapping_); break;
+    case Kind::Informational:   callbacks_.info_(entry.info_, entry.token_, entry.mapping_); break;
+    case Kind::Poll:
+    case Kind::EnterSource:
+    case Kind::LeaveSource:     break;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void Parser::record(BufferedDiagnostic&& entry) noexcept
+{
+  if (recording_)
+    recording_->entries_.push_back(ParseResult::Entry{ .kind_ = ParseResult::Kind::Diagnostic, .diagnostic_ = std::move(entry) });
+}
+
+//-----------------------------------------------------------------------------
+bool Parser::replay(Source& source) noexcept
+{
+  auto& result{ *source.parseResult_ };
+  while ((!shouldAbort()) && (result.next_ < result.entries_.size())) {
+    auto& entry{ result.entries_[result.next_++] };
+    switch (entry.kind_) {
+      case ParseResult::Kind::Diagnostic:   replay(entry.diagnostic_); break;
+      case ParseResult::Kind::Source:       requestSource(entry.request_); break;
+      case ParseResult::Kind::Asset:        requestAsset(entry.request_); break;
+      case ParseResult::Kind::Yield:        return false;
+      case ParseResult::Kind::Apply: {
+        // the includers are parsed live so their pending tokens take the state
+        for (auto iter{ std::next(sources_.begin()) }; sources_.end() != iter; ++iter) {
+          for (auto& token : (*iter)->tokenizer_->parsedTokens_)
+            token->compileState_ = entry.state_;
+        }
+        break;
+      }
+    }
+  }
+  if (result.next_ < result.entries_.size())
+    return false;
+
+  source.context_->state_ = result.state_;
+  source.context_->aliasing_ = result.aliasing_;
+  if ((!result.aliasing_.keywords_.empty()) || (!result.aliasing_.operators_.empty()))
+    source.context_->aliasAdded();
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void Parser::store(Source& source) noexcept
+{
+  if ((!parseCache_) || (!source.parseResult_) || (source.parseResult_->replay_))
+    return;
+
+  // a parse cut short or one that declared types cannot be reproduced
+  if ((!shouldAbort()) && (source.context_->types_.types_.empty())) {
+    auto& result{ *source.parseResult_ };
+    result.state_ = source.context_->state_;
+    result.aliasing_ = source.context_->aliasing_;
+    (void)parseCache_->store(result);
   }
+  source.parseResult_.reset();
 }
 
 //-----------------------------------------------------------------------------
@@ -107,7 +451,31 @@ void Parser::processAssets() noexcept
   if (pendingAssets_.size() < 1)
     return;
 
+  if (!config_.outputPath_.empty()) {
+    String manifestFullPath;
+    assetCopier_.loadManifest(makeIncludeFile(config_.outputPath_, AssetCopier::ManifestFileName, manifestFullPath, &fileSystemCache_));
+
+    if ((config_.assetStore_) && (assetCopier_.storePath_.empty())) {
+      String storeFullPath;
+      Path storePath{ makeIncludeFile(config_.outputPath_, AssetCopier::StoreDirectoryName, storeFullPath, &fileSystemCache_) };
+      std::error_code ec;
+      std::filesystem::create_directories(storePath, ec);
+      if (!ec)
+        assetCopier_.storePath_ = storePath;
+    }
+  }
+
+  // validate everything up front so the copies can run in parallel, keeping
+  // track of which job each asset became so failures report in order
+  AssetCopier::JobList jobs;
+  std::vector<std::optional<size_t>> pendingJobs;
+  std::map<String, size_t> destinations;
+  std::set<Path> parentOutputPaths;
+
   for (auto& pending : pendingAssets_) {
+    pendingJobs.emplace_back();
+    depend(pending, true);
+
     if (pending.generated_) {
       // TODO: execute pending compile time functions now
     }
@@ -119,40 +487,58 @@ void Parser::processAssets() noexcept
     }
 
     if (Path{ pending.renameFilePath_ }.has_root_path()) {
-      out(Error::OutputFailure, pending.token_, StringMap{ {"$file$", pending.renameFilePath_ } });
+      out(Error::OutputFailure, pending.token_, DiagnosticArguments{ {"$file$", pending.renameFilePath_ } });
       continue;
     }
 
     if (String::npos != pending.renameFilePath_.find("..")) {
-      out(Error::OutputFailure, pending.token_, StringMap{ {"$file$", pending.renameFilePath_ } });
+      out(Error::OutputFailure, pending.token_, DiagnosticArguments{ {"$file$", pending.renameFilePath_ } });
       continue;
     }
 
     String fullPath;
-    auto useOutputPath{ makeIncludeFile(config_.outputPath_, pending.renameFilePath_, fullPath) };
-
-    Path parentOutputPath{ Path{ useOutputPath }.parent_path() };
-    if (!parentOutputPath.empty()) {
-      std::filesystem::create_directories(parentOutputPath, ec);
-    }
+    auto useOutputPath{ makeIncludeFile(config_.outputPath_, pending.renameFilePath_, fullPath, &fileSystemCache_) };
 
     Path sourcePath { pending.filePath_ };
-    if (!std::filesystem::is_regular_file(sourcePath)) {
-      out(Error::AssetNotFound, pending.token_, StringMap{ {"$file$", pending.filePath_ } });
+    if (!fileSystemCache_.isRegularFile(sourcePath, ec)) {
+      out(Error::AssetNotFound, pending.token_, DiagnosticArguments{ {"$file$", pending.filePath_ } });
       continue;
     }
-    Path temp{ pending.renameFilePath_ };
-    std::filesystem::copy_file(
-      Path{ pending.filePath_ },
-      Path{ pending.renameFilePath_ },
-      std::filesystem::copy_options::update_existing,
-      ec
-    );
-    if (ec) {
-      out(Error::OutputFailure, pending.token_, StringMap{ {"$file$", pending.renameFilePath_ } });
+
+    // a later asset landing on the same output never replaced the first
+    if (destinations.contains(useOutputPath))
       continue;
-    }
+    destinations.emplace(useOutputPath, jobs.size());
+
+    Path parentOutputPath{ Path{ useOutputPath }.parent_path() };
+    if (!parentOutputPath.empty())
+      parentOutputPaths.insert(parentOutputPath);
+
+    pendingJobs.back() = jobs.size();
+    jobs.push_back(AssetCopier::Job{ .source_ = sourcePath, .destination_ = Path{ useOutputPath } });
+  }
+
+  for (auto& parentOutputPath : parentOutputPaths) {
+    std::error_code ec;
+    std::filesystem::create_directories(parentOutputPath, ec);
   }
+
+  assetCopier_.run(jobs, config_.assetWorkers_);
+
+  size_t index{};
+  for (auto& pending : pendingAssets_) {
+    auto& job{ pendingJobs[index++] };
+    if (!job)
+      continue;
+
+    fileSystemCache_.invalidate(jobs[*job].destination_);
+    if (jobs[*job].ec_)
+      out(Error::OutputFailure, pending.token_, DiagnosticArguments{ {"$file$", pending.renameFilePath_ } });
+    else
+      dependencies_.outputs_.insert(jobs[*job].destination_.string());
+  }
+
+  (void)assetCopier_.saveManifest();
   pendingAssets_.clear();
 }
 
@@ -265,12 +651,10 @@ TokenConstPtr Parser::validOrLastValid(const TokenConstPtr& token, Tokenizer& to
 }
 
 //-----------------------------------------------------------------------------
-ParserTypes::Extraction Parser::extract(Context& context, Tokenizer::iterator first, Tokenizer::iterator last) noexcept
+ParserTypes::Extraction Parser::extract(Context& context) noexcept
 {
   Extraction result;
-  result.context_ = context.thisWeak_.lock()->forkChild(ContextTypes::Type::Expression);
-  result.tokenizer_ = std::make_shared<Tokenizer>(first.list(), first.list().extract(first, last));
-  result.context_->tokenizer_ = result.tokenizer_;
+  result.context_ = context.forkChild(ContextTypes::Type::Expression);
   return result;
 }
 
@@ -477,6 +861,24 @@ std::function<bool(const TokenConstPtr& token)> Parser::isOperatorOrAlternativeF
   };
 }
 
+//-----------------------------------------------------------------------------
+void Parser::prefetch(SourceAsset& sourceAsset) noexcept
+{
+  sourceAsset.prefetch_.reset();
+  if (sourceAsset.generated_)
+    return;
+
+  // a source already parsed is skipped before it is ever read
+  if (includedSources_.contains(fileSystemCache_.identity(sourceAsset.filePath_)))
+    return;
+
+  // a warm cache hands out the bytes it holds without reading the file
+  if ((config_.sourceCache_) && (config_.sourceCache_->contains(sourceAsset.fullFilePath_)))
+    return;
+
+  sourceAsset.prefetch_ = prefetcher_.prefetch(sourceAsset.filePath_, static_cast<bool>(config_.sourceCache_));
+}
+
 //-----------------------------------------------------------------------------
 void Parser::prime() noexcept
 {
@@ -485,19 +887,8 @@ void Parser::prime() noexcept
 
   if (pendingSources_.size() < 1) {
     for (auto& file : config_.inputFilePaths_) {
-      auto token{ makeInternalToken(rootContext_->state()) };
-      SourceAsset source{};
-      source.token_ = token;
-      source.compileState_ = rootContext_->state();
-      source.filePath_ = makeIncludeFile("ignored.bin", file, source.fullFilePath_);
-      if (source.filePath_.empty()) {
-        // try to load anyway
-        source.filePath_ = file;
-        source.fullFilePath_ = file;
-      }
-      source.required_ = decltype(source.required_)::Yes;
-      source.commandLine_ = true;
-      source.parentTabStopWidth_ = config_.tabStopWidth_;
+      auto source{ makeCommandLineSource(file) };
+      prefetch(source);
       pendingSources_.push_back(source);
     }
     config_.inputFilePaths_.clear();
@@ -509,30 +900,60 @@ void Parser::prime() noexcept
       // TODO: execute pending compile time functions now
     }
 
-    auto fileContents{ readBinaryFile(pending.filePath_) };
+    depend(pending, false);
+
+    auto identity{ fileSystemCache_.identity(pending.filePath_) };
+    if (includedSources_.contains(identity)) {
+      ++avoidedSourceLoads_;
+      continue;
+    }
+
+    SourceCache::Contents fileContents;
+    if (config_.sourceCache_)
+      fileContents = config_.sourceCache_->find(pending.fullFilePath_);
+    if (!fileContents.first) {
+      std::optional<FileStamp> stamp;
+      if (pending.prefetch_) {
+        fileContents = pending.prefetch_->take();
+        stamp = pending.prefetch_->stamped_;
+      }
+      else {
+        if (config_.sourceCache_)
+          stamp = fileStamp(pending.filePath_);
+        fileContents = readBinaryFile(pending.filePath_);
+      }
+      if ((config_.sourceCache_) && (stamp))
+        config_.sourceCache_->store(pending.fullFilePath_, *stamp, fileContents);
+    }
     if ((!fileContents.first) ||
         (fileContents.second < 1)) {
       switch (pending.required_) {
         case SourceAssetRequired::Yes: {
           if (pending.commandLine_)
-            fatal(Error::SourceNotFound, pending.token_, StringMap{ {"$file$", pending.filePath_} });
+            fatal(Error::SourceNotFound, pending.token_, DiagnosticArguments{ {"$file$", pending.filePath_} });
           else
-            out(Error::SourceNotFound, pending.token_, StringMap{ {"$file$", pending.filePath_} });
+            out(Error::SourceNotFound, pending.token_, DiagnosticArguments{ {"$file$", pending.filePath_} });
           break;
         }
         case SourceAssetRequired::No: {
           break;
         }
         case SourceAssetRequired::Warn: {
-          out(Warning::SourceNotFound, pending.token_, StringMap{ {"$file$", pending.filePath_} });
+          out(Warning::SourceNotFound, pending.token_, DiagnosticArguments{ {"$file$", pending.filePath_} });
           break;
         }
       }
       continue;
     }
 
-    if (!alreadyIncludedSources_.insert(pending.fullFilePath_).second)
+    std::optional<FileContentKey> contentKey;
+    if (config_.deduplicateSourcesByContent_)
+      contentKey = fileContentKey(fileContents.first, fileContents.second);
+
+    if (!includedSources_.insert(identity, pending.fullFilePath_, contentKey)) {
+      ++duplicateSources_;
       continue;
+    }
 
     auto source{ std::make_shared<Source>() };
     source->context_ = rootContext_->forkChild(source->id_, ContextTypes::Type::Source);
@@ -542,6 +963,37 @@ void Parser::prime() noexcept
     source->realPath_->filePath_ = pending.filePath_;
     source->realPath_->fullFilePath_ = pending.fullFilePath_;
     source->realPath_->source_ = source;
+    source->identity_ = identity;
+    source->contentKey_ = contentKey;
+
+    ParseResultPtr parseResult;
+    if (parseCache_) {
+      if (auto key{ ParseResultCache::key(pending, fileContents.first.get(), fileContents.second, rootContext_->aliasing_) }; key) {
+        auto resolve{ [&](const String& filePath, const String& fullFilePath, bool realPath) noexcept -> SourceTypes::FilePathPtr {
+          auto matches{ [&](const SourcePtr& other) noexcept {
+            return (other->realPath_->filePath_ == filePath) && (other->realPath_->fullFilePath_ == fullFilePath);
+          } };
+          if (realPath) {
+            if (matches(source))
+              return source->realPath_;
+            if (auto found{ std::find_if(sources_.begin(), sources_.end(), matches) }; sources_.end() != found)
+              return (*found)->realPath_;
+          }
+          auto result{ std::make_shared<SourceTypes::FilePath>() };
+          if (!realPath)
+            result->source_ = source;
+          result->filePath_ = filePath;
+          result->fullFilePath_ = fullFilePath;
+          return result;
+        } };
+        parseResult = parseCache_->find(*key, resolve);
+        if (!parseResult) {
+          parseResult = std::make_shared<ParseResult>();
+          parseResult->key_ = std::move(*key);
+        }
+      }
+    }
+
     source->tokenizer_ = std::make_shared<Tokenizer>(
       source->realPath_,
       std::move(fileContents),
@@ -551,6 +1003,17 @@ void Parser::prime() noexcept
     source->tokenizer_->skipComments_ = true;
     source->tokenizer_->errorCallback_ = callbacks_.error_;
     source->tokenizer_->warningCallback_ = callbacks_.warning_;
+    if (parseResult) {
+      // lexing diagnostics belong to the parse result being recorded
+      source->tokenizer_->errorCallback_ = [this](Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept {
+        out(error, token, mapping);
+      };
+      source->tokenizer_->warningCallback_ = [this](Warning warning, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept {
+        record(BufferedDiagnostic{ .kind_ = BufferedDiagnostic::Kind::Warning, .warning_ = warning, .token_ = token, .mapping_ = mapping });
+        callbacks_.warning_(warning, token, mapping);
+      };
+    }
+    source->parseResult_ = std::move(parseResult);
     source->context_->tokenizer_ = source->tokenizer_;
     pushFrontSourceList.push_back(source);
   }
@@ -560,6 +1023,34 @@ void Parser::prime() noexcept
   pendingSources_.clear();
 }
 
+//-----------------------------------------------------------------------------
+ParserDirectiveTypes::SourceAsset Parser::makeCommandLineSource(const String& file) noexcept
+{
+  auto token{ makeInternalToken(rootContext_->state()) };
+  SourceAsset source{};
+  source.token_ = token;
+  source.compileState_ = rootContext_->state();
+  source.filePath_ = makeIncludeFile("ignored.bin", file, source.fullFilePath_, &fileSystemCache_);
+  if (source.filePath_.empty()) {
+    // try to load anyway
+    source.filePath_ = file;
+    source.fullFilePath_ = file;
+  }
+  source.required_ = decltype(source.required_)::Yes;
+  source.commandLine_ = true;
+  source.parentTabStopWidth_ = config_.tabStopWidth_;
+  return source;
+}
+
+//-----------------------------------------------------------------------------
+void Parser::depend(const SourceAsset& sourceAsset, bool asset) noexcept
+{
+  String requestedBy;
+  if ((!sourceAsset.commandLine_) && (sourceAsset.token_) && (sourceAsset.token_->actualOrigin_.filePath_))
+    requestedBy = sourceAsset.token_->actualOrigin_.filePath_->fullFilePath_;
+  dependencies_.add(sourceAsset.fullFilePath_, requestedBy, asset);
+}
+
 //-----------------------------------------------------------------------------
 Tokenizer& Parser::getSourceTokenizer() noexcept
 {
@@ -589,34 +1080,41 @@ ContextPtr Parser::getSourceContextPtr() noexcept
 }
 
 //-----------------------------------------------------------------------------
-void Parser::fatal(Error error, const TokenConstPtr& token, const StringMap& mapping) noexcept
+void Parser::fatal(Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept
 {
+  record(BufferedDiagnostic{ .kind_ = BufferedDiagnostic::Kind::Fatal, .error_ = error, .token_ = token, .mapping_ = mapping });
   callbacks_.fatal_(error, token, mapping);
 }
 
 //-----------------------------------------------------------------------------
-void Parser::out(Error error, const TokenConstPtr& token, const StringMap& mapping) noexcept
+void Parser::out(Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept
 {
+  record(BufferedDiagnostic{ .kind_ = BufferedDiagnostic::Kind::Error, .error_ = error, .token_ = token, .mapping_ = mapping });
   callbacks_.error_(error, token, mapping);
 }
 
 //-----------------------------------------------------------------------------
-void Parser::out(Warning warning, const TokenConstPtr& token, const StringMap& mapping) noexcept
+void Parser::out(Warning warning, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept
 {
   assert(token);
   assert(token->compileState_);
-  if (token->compileState_->warnings_.at(warning).enabled_)
-    callbacks_.warning_(warning, token, mapping);
+  if (!token->compileState_->warnings_.at(warning).enabled_)
+    return;
+  record(BufferedDiagnostic{ .kind_ = BufferedDiagnostic::Kind::Warning, .warning_ = warning, .token_ = token, .mapping_ = mapping });
+  callbacks_.warning_(warning, token, mapping);
 }
 
 //-----------------------------------------------------------------------------
-void Parser::out(Informational info, const TokenConstPtr& token, const StringMap& mapping) noexcept
+void Parser::out(Informational info, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept
 {
+  record(BufferedDiagnostic{ .kind_ = BufferedDiagnostic::Kind::Informational, .info_ = info, .token_ = token, .mapping_ = mapping });
   callbacks_.info_(info, token, mapping);
 }
 
 //-----------------------------------------------------------------------------
-bool Parser::shouldAbort() noexcept
+void Parser::listing(const TokenConstPtr& at, StringView kind, StringView text) noexcept
 {
-  return callbacks_.shouldAbort_();
+  if ((!listing_) || (!at))
+    return;
+  listing_->note(*at, kind, text);
 }
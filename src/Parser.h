@@ -4,6 +4,12 @@
 #include "types.h"
 #include "ParserTypes.h"
 #include "ParserDirectiveTypes.h"
+#include "AssetCopier.h"
+#include "FilePrefetcher.h"
+#include "FileSystemCache.h"
+#include "ListingWriter.h"
+#include "ParseResultCache.h"
+#include "SourceDependencies.h"
 
 namespace zax
 {
@@ -15,20 +21,36 @@ struct Parser : public ParserTypes,
   const Puid id_{ puid() };
   Config config_;
   Callbacks callbacks_;
-  OperatorLutPtr operatorLut_;
+  OperatorLutConstPtr operatorLut_;
+  FilePrefetcher prefetcher_;
+  FileSystemCache fileSystemCache_;
 
   ModuleWeakPtr importer_;
   ModulePtr module_;
   ModuleMap imports_;
 
+  ContextPool contextPool_;
   ContextPtr rootContext_;
 
+  uint32_t aliasGeneration_{ 1 };
+  mutable AliasCache aliasCache_;
+
   SourceAssetList pendingSources_;
   SourceAssetList pendingAssets_;
+  AssetCopier assetCopier_;
+  std::unique_ptr<ListingWriter> listing_;
+  std::unique_ptr<ParseResultCache> parseCache_;
+  ParseResult* recording_{};
+
+  std::list<ParserPtr> sourceParsers_;   // workers own the contexts of the sources they parsed
+  std::unique_ptr<BufferedDiagnostics> bufferedDiagnostics_;
 
   SourceList sources_;
   SourceList processedSources_;
-  std::set<Path> alreadyIncludedSources_;
+  IncludedSources includedSources_;
+  SourceDependencies dependencies_;
+  size_t avoidedSourceLoads_{};
+  size_t duplicateSources_{};
 
   Parser(
     const Config& config,
@@ -43,15 +65,19 @@ struct Parser : public ParserTypes,
 
   void parse() noexcept;
   void process(Context& context) noexcept;
+  [[nodiscard]] ModulePtr import(const String& name, StringView interfaceFilePath) noexcept;
   void processAssets() noexcept;
 
   [[nodiscard]] std::optional<DirectiveResult> parseDirective(
     Context& context,
     Tokenizer::iterator iter,
-    ParseDirectiveFunctions& functions) noexcept;
+    const DirectiveSchema& schema,
+    DirectiveArguments& arguments) noexcept;
   [[nodiscard]] static std::optional<DirectiveLiteralResult> parseDirectiveLiteral(const Context& context, Tokenizer::iterator iter) noexcept;
 
-  [[nodiscard]] bool consumeLineParserDirective(Context& context) noexcept;
+  [[nodiscard]] static StatementLead classifyStatement(const Context& context, Tokenizer::iterator iter) noexcept;
+
+  [[nodiscard]] bool consumeLineParserDirective(Context& context, Tokenizer::iterator iter) noexcept;
   [[nodiscard]] bool consumeAssetOrSourceDirective(Context& context, Tokenizer::iterator iter, bool isSource) noexcept;
   [[nodiscard]] bool consumeTabStopDirective(Context& context, Tokenizer::iterator iter) noexcept;
   [[nodiscard]] bool consumeFileAssignDirective(Context& context, Tokenizer::iterator iter) noexcept;
@@ -65,7 +91,7 @@ struct Parser : public ParserTypes,
   [[nodiscard]] bool consumeTypesDirective(Context& context, Tokenizer::iterator iter) noexcept;
   [[nodiscard]] bool consumeFunctionsDirective(Context& context, Tokenizer::iterator iter) noexcept;
 
-  [[nodiscard]] bool consumeAlias(Context& context) noexcept;
+  [[nodiscard]] bool consumeAlias(Context& context, Tokenizer::iterator iter) noexcept;
   [[nodiscard]] bool consumeKeywordAlias(Context& context, Tokenizer::iterator iter) noexcept;
 
   [[nodiscard]] static std::optional<QuoteResult> parseQuote(Tokenizer::iterator iter) noexcept;
@@ -90,10 +116,12 @@ struct Parser : public ParserTypes,
   [[nodiscard]] TokenConstPtr validOrLastValid(const TokenConstPtr& token, Tokenizer& tokenizer) const noexcept;
   [[nodiscard]] TokenConstPtr validOrLastValid(const TokenConstPtr& token, Tokenizer::iterator iter) const noexcept { return validOrLastValid(token, iter.list()); }
 
-  [[nodiscard]] Extraction extract(Context& context, Tokenizer::iterator first, Tokenizer::iterator last) noexcept;
+  [[nodiscard]] Extraction extract(Context& context) noexcept;
 
   void handleAsset(Context& context, SourceAssetDirective&) noexcept;
   void handleSource(Context& context, SourceAssetDirective&) noexcept;
+  void requestAsset(const SourceAsset& request) noexcept;
+  void requestSource(const SourceAsset& request) noexcept;
 
   [[nodiscard]] static std::optional<Operator> extractOperator(const Context& context, const TokenConstPtr& token) noexcept;
   [[nodiscard]] static bool isOperator(const Context& context, const TokenConstPtr& token, Operator oper) noexcept;
@@ -117,6 +145,18 @@ struct Parser : public ParserTypes,
   [[nodiscard]] static std::function<bool(const TokenConstPtr& token)> isOperatorOrAlternativeFunc(const OperatorLut& lut, Operator oper) noexcept;
 
 protected:
+  void parseSourcesInParallel() noexcept;
+  void bufferDiagnostics(const DiagnosticBudgetPtr& budget) noexcept;
+  void replayWorkers(std::vector<ParserPtr>& workers) noexcept;
+  [[nodiscard]] bool include(const Source& source) noexcept;
+  void replay(const BufferedDiagnostic& entry) noexcept;
+  void record(BufferedDiagnostic&& entry) noexcept;
+  [[nodiscard]] bool replay(Source& source) noexcept;
+  void store(Source& source) noexcept;
+
+  [[nodiscard]] SourceAsset makeCommandLineSource(const String& file) noexcept;
+  void depend(const SourceAsset& sourceAsset, bool asset) noexcept;
+  void prefetch(SourceAsset& sourceAsset) noexcept;
   void prime() noexcept;
   Tokenizer& getSourceTokenizer() noexcept;
   TokenizerPtr getSourceTokenizerPtr() noexcept;
@@ -125,11 +165,17 @@ protected:
   ContextPtr getSourceContextPtr() noexcept;
 
 public:
-  void fatal(Error error, const TokenConstPtr& token, const StringMap& mapping = {}) noexcept;
-  void out(Error error, const TokenConstPtr& token, const StringMap& mapping = {}) noexcept;
-  void out(Warning warning, const TokenConstPtr& token, const StringMap& mapping = {}) noexcept;
-  void out(Informational info, const TokenConstPtr& token, const StringMap& mapping = {}) noexcept;
-  [[nodiscard]] bool shouldAbort() noexcept;
+  void fatal(Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping = {}) noexcept;
+  void out(Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping = {}) noexcept;
+  void out(Warning warning, const TokenConstPtr& token, const DiagnosticArguments& mapping = {}) noexcept;
+  void out(Informational info, const TokenConstPtr& token, const DiagnosticArguments& mapping = {}) noexcept;
+  [[nodiscard]] bool shouldAbort() noexcept
+  {
+    if ((bufferedDiagnostics_) && (bufferedDiagnostics_->unpolled_))
+      bufferedDiagnostics_->poll();
+    return callbacks_.cancellation_->cancelled();
+  }
+  void listing(const TokenConstPtr& at, StringView kind, StringView text) noexcept;
 };
 
 } // namespace zax
@@ -89,6 +89,68 @@ struct ParserDirectiveTypes
 
   using PushPopTraits = zs::EnumTraits<PushPop, PushPopDeclare>;
 
+  enum class VariablesDefault {
+    Mutable,
+    Immutable,
+    Final,
+    Varies
+  };
+
+  struct VariablesDefaultDeclare final : public zs::EnumDeclare<VariablesDefault, 4>
+  {
+    constexpr const Entries operator()() const noexcept
+    {
+      return { {
+        {VariablesDefault::Mutable, "mutable"},
+        {VariablesDefault::Immutable, "immutable"},
+        {VariablesDefault::Final, "final"},
+        {VariablesDefault::Varies, "varies"}
+      } };
+    }
+  };
+
+  using VariablesDefaultTraits = zs::EnumTraits<VariablesDefault, VariablesDefaultDeclare>;
+
+  enum class TypesDefault {
+    Mutable,
+    Immutable,
+    Constant,
+    Inconstant
+  };
+
+  struct TypesDefaultDeclare final : public zs::EnumDeclare<TypesDefault, 4>
+  {
+    constexpr const Entries operator()() const noexcept
+    {
+      return { {
+        {TypesDefault::Mutable, "mutable"},
+        {TypesDefault::Immutable, "immutable"},
+        {TypesDefault::Constant, "constant"},
+        {TypesDefault::Inconstant, "inconstant"}
+      } };
+    }
+  };
+
+  using TypesDefaultTraits = zs::EnumTraits<TypesDefault, TypesDefaultDeclare>;
+
+  enum class FunctionsDefault {
+    Constant,
+    Inconstant
+  };
+
+  struct FunctionsDefaultDeclare final : public zs::EnumDeclare<FunctionsDefault, 2>
+  {
+    constexpr const Entries operator()() const noexcept
+    {
+      return { {
+        {FunctionsDefault::Constant, "constant"},
+        {FunctionsDefault::Inconstant, "inconstant"}
+      } };
+    }
+  };
+
+  using FunctionsDefaultTraits = zs::EnumTraits<FunctionsDefault, FunctionsDefaultDeclare>;
+
   enum class FaultOptions {
     Yes,
     No,
@@ -205,22 +267,153 @@ struct ParserDirectiveTypes
     bool success_{ true };
   };
   
+  using DirectiveHash = std::uint64_t;
+
+  constexpr static DirectiveHash directiveHashSeed{ 14695981039346656037ULL };
+
+  // FNV-1a which can be folded one token at a time so a dashed name hashes
+  // the same whether it was matched incrementally or as a whole
+  [[nodiscard]] constexpr static DirectiveHash directiveHash(StringView value, DirectiveHash hash = directiveHashSeed) noexcept
+  {
+    for (auto let : value) {
+      hash ^= static_cast<DirectiveHash>(static_cast<unsigned char>(let));
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
   struct DirectiveLiteralResult
   {
     Tokenizer::iterator literalIter_;
     Tokenizer::iterator afterIter_;
-    String name_;
+    StringView name_;
+    DirectiveHash hash_{ directiveHashSeed };
+  };
+
+
+  enum class DirectiveValueKind {
+    None,
+    Literal,
+    Quote,
+    Number,
+    Extracted
+  };
+
+  struct DirectiveValue;
+  struct DirectiveArguments;
+
+  // a domain converts a literal value (or a name) into an enum's underlying
+  // value, or no value when outside the domain
+  using DirectiveDomain = std::optional<int>(*)(StringView) noexcept;
+  using DirectiveAccept = bool(*)(const DirectiveArguments&, const DirectiveValue&) noexcept;
+
+  template <typename TEnumTraits>
+  [[nodiscard]] static std::optional<int> enumDomain(StringView value) noexcept
+  {
+    auto result{ TEnumTraits::toEnum(value) };
+    if (!result)
+      return {};
+    return static_cast<int>(*result);
+  }
+
+  struct DirectiveArgumentSchema
+  {
+    StringView name_;
+    DirectiveDomain nameDomain_{};    // matches any name within the domain instead of name_
+    bool primary_{};
+
+    bool none_{};
+    bool literal_{};
+    bool quote_{};
+    bool number_{};
+    bool extracted_{};
+
+    std::array<DirectiveDomain, 3> domains_{};  // literal values must fall in one domain (when any are specified)
+    bool once_{};
+    bool nonEmpty_{};
+    int minimum_{ std::numeric_limits<int>::min() };
+
+    [[nodiscard]] constexpr bool accepts(DirectiveValueKind kind) const noexcept
+    {
+      switch (kind) {
+        case DirectiveValueKind::None:      return none_;
+        case DirectiveValueKind::Literal:   return literal_;
+        case DirectiveValueKind::Quote:     return quote_;
+        case DirectiveValueKind::Number:    return number_;
+        case DirectiveValueKind::Extracted: return extracted_;
+      }
+      return false;
+    }
+  };
+
+  struct DirectiveSchema
+  {
+    std::span<const DirectiveArgumentSchema> arguments_;
+    DirectiveAccept accept_{};        // optional cross argument validation
+
+    [[nodiscard]] constexpr const DirectiveArgumentSchema* find(bool primary, StringView name) const noexcept
+    {
+      for (auto& argument : arguments_) {
+        if (primary != argument.primary_)
+          continue;
+        if (primary)
+          return &argument;
+        if (argument.nameDomain_) {
+          if (argument.nameDomain_(name))
+            return &argument;
+          continue;
+        }
+        if (argument.name_ == name)
+          return &argument;
+      }
+      return nullptr;
+    }
   };
 
+  struct DirectiveValue
+  {
+    const DirectiveArgumentSchema* argument_{};
+    Tokenizer::iterator literalIter_;
+    StringView name_;
+    DirectiveValueKind kind_{};
+    String value_;
+    size_t domain_{};
+    std::optional<int> enum_;
+    int number_{};
+    ParserTypes::Extraction extraction_;
+
+    [[nodiscard]] bool primary() const noexcept { return argument_ && argument_->primary_; }
+
+    template <typename TEnum>
+    [[nodiscard]] TEnum as() const noexcept { assert(enum_); return static_cast<TEnum>(*enum_); }
+  };
 
-  struct ParseDirectiveFunctions
+  struct DirectiveArguments
   {
-    std::function<bool(bool, StringView)> legalName_;
-    std::function<bool(bool, Tokenizer::iterator, StringView)> noValueFunc_;
-    std::function<bool(bool, Tokenizer::iterator, StringView, StringView)> literalValueFunc_;
-    std::function<bool(bool, Tokenizer::iterator, StringView, StringView)> quoteValueFunc_;
-    std::function<bool(bool, Tokenizer::iterator, StringView, StringView)> numberValueFunc_;
-    std::function<bool(bool, Tokenizer::iterator, StringView, ParserTypes::Extraction&)> extractedValueFunc_;
+    std::vector<DirectiveValue> values_;
+
+    [[nodiscard]] const DirectiveValue* primary() const noexcept
+    {
+      if (values_.empty())
+        return nullptr;
+      return values_.front().primary() ? &(values_.front()) : nullptr;
+    }
+
+    [[nodiscard]] const DirectiveValue* find(StringView name) const noexcept
+    {
+      for (auto iter{ values_.rbegin() }; iter != values_.rend(); ++iter) {
+        if ((!iter->primary()) && (name == iter->name_))
+          return &(*iter);
+      }
+      return nullptr;
+    }
+
+    [[nodiscard]] size_t count(const DirectiveArgumentSchema& argument) const noexcept
+    {
+      return static_cast<size_t>(std::count_if(values_.begin(), values_.end(), [&argument](const DirectiveValue& value) noexcept -> bool {
+        return &argument == value.argument_;
+      }));
+    }
   };
 
   struct Descope
@@ -242,6 +435,7 @@ struct ParserDirectiveTypes
     bool generated_{};
     bool commandLine_{};
     int parentTabStopWidth_{ 8 };
+    PrefetchedFilePtr prefetch_;
   };
 
   using SourceAssetList = std::list<SourceAsset>;
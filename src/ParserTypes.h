@@ -2,7 +2,10 @@
 #pragma once
 
 #include "types.h"
+#include "CancellationToken.h"
 #include "Config.h"
+#include "helpers.h"
+#include "ContextPool.h"
 #include "Errors.h"
 #include "Warnings.h"
 #include "Informationals.h"
@@ -25,18 +28,27 @@ struct ParserTypes
   using Informational = InformationalTypes::Informational;
   using TokenType = TokenTypes::Type;
 
+  // What a statement's leading tokens can possibly start; the statement loop
+  // classifies the front token once and only runs the matching consumer.
+  enum class StatementLead {
+    Unknown,
+    Separator,
+    Directive,        // [[
+    Declaration       // literal ::
+  };
+
   using ModuleMap = std::map<String, ModulePtr>;
   using ModuleList = std::list<ModulePtr>;
   using SourceList = std::list<SourcePtr>;
 
   struct Callbacks
   {
-    std::function<void(Error, const TokenConstPtr& token, const StringMap&)> fatal_;
-    std::function<void(Error, const TokenConstPtr& token, const StringMap&)> error_;
-    std::function<void(Warning, const TokenConstPtr& token, const StringMap&)> warning_;
-    std::function<void(Informational, const TokenConstPtr& token, const StringMap&)> info_;
+    std::function<void(Error, const TokenConstPtr& token, const DiagnosticArguments&)> fatal_;
+    std::function<void(Error, const TokenConstPtr& token, const DiagnosticArguments&)> error_;
+    std::function<void(Warning, const TokenConstPtr& token, const DiagnosticArguments&)> warning_;
+    std::function<void(Informational, const TokenConstPtr& token, const DiagnosticArguments&)> info_;
 
-    std::function<bool()> shouldAbort_;
+    CancellationTokenPtr cancellation_;
   };
 
   struct QuoteResult {
@@ -49,11 +61,122 @@ struct ParserTypes
     Tokenizer::iterator afterIter_;
     String number_;
   };
+  // The tokens of an unresolved value are never copied out; they stay with
+  // the directive being consumed and only the expression context is forked.
   struct Extraction {
     ContextPtr context_;
-    TokenizerPtr tokenizer_;
 
-    bool hasValue() const noexcept { return static_cast<bool>(tokenizer_); }
+    bool hasValue() const noexcept { return static_cast<bool>(context_); }
+  };
+
+  // Sources are deduplicated by file identity so differently spelled paths
+  // and links to one file are only parsed once, and optionally by content so
+  // copies are caught too. The path is only a fallback when a file cannot be
+  // identified.
+  struct IncludedSources {
+    std::unordered_set<FileIdentity, FileIdentity::Hash> identities_;
+    std::unordered_set<FileContentKey, FileContentKey::Hash> contents_;
+    std::unordered_set<String> paths_;
+
+    [[nodiscard]] bool contains(const std::optional<FileIdentity>& identity) const noexcept { return (identity) && (identities_.contains(*identity)); }
+    [[nodiscard]] bool contains(const std::optional<FileIdentity>& identity, const String& fullFilePath, const std::optional<FileContentKey>& content) const noexcept
+    {
+      if ((content) && (contents_.contains(*content)))
+        return true;
+      if (identity)
+        return identities_.contains(*identity);
+      return paths_.contains(fullFilePath);
+    }
+    [[nodiscard]] bool insert(const std::optional<FileIdentity>& identity, const String& fullFilePath, const std::optional<FileContentKey>& content = {}) noexcept
+    {
+      if (contains(identity, fullFilePath, content))
+        return false;
+      if (identity)
+        identities_.insert(*identity);
+      else
+        paths_.insert(fullFilePath);
+      if (content)
+        contents_.insert(*content);
+      return true;
+    }
+  };
+
+  // A worker parser records its diagnostics, abort polls and the nesting of
+  // the sources it parses so they can be replayed in serial order.
+  struct BufferedDiagnostic {
+    enum class Kind {
+      Fatal,
+      Error,
+      Warning,
+      Informational,
+      Poll,
+      EnterSource,
+      LeaveSource
+    };
+
+    Kind kind_{};
+    Error error_{};
+    Warning warning_{};
+    Informational info_{};
+    TokenConstPtr token_;
+    DiagnosticArguments mapping_;
+    SourcePtr source_;
+  };
+  // Shared by the workers of one parse so the first fatal, or the diagnostic
+  // that spends what is left of the limits, cancels every worker at once.
+  struct DiagnosticBudget {
+    std::atomic<int> errors_{};
+    std::atomic<int> warnings_{};
+  };
+  using DiagnosticBudgetPtr = std::shared_ptr<DiagnosticBudget>;
+
+  struct BufferedDiagnostics {
+    std::vector<BufferedDiagnostic> entries_;
+    std::set<Puid> enteredSources_;
+    bool unpolled_{};
+
+    void enter(const SourcePtr& source) noexcept;
+    void leave(const SourcePtr& source) noexcept { entries_.push_back(BufferedDiagnostic{ .kind_ = BufferedDiagnostic::Kind::LeaveSource, .source_ = source }); }
+    void push(BufferedDiagnostic&& entry) noexcept
+    {
+      entries_.push_back(std::move(entry));
+      unpolled_ = true;
+    }
+    void poll() noexcept
+    {
+      // only a diagnostic can change the outcome of the next poll
+      entries_.push_back(BufferedDiagnostic{ .kind_ = BufferedDiagnostic::Kind::Poll });
+      unpolled_ = false;
+    }
+  };
+
+  // Resolved aliases are cached per (spelling, context) and the whole cache
+  // is dropped whenever any scope gains an alias since an alias added to a
+  // parent scope changes the resolution of every descendant scope.
+  struct AliasCacheKeyView {
+    StringView spelling_;
+    uint32_t contextIndex_{};
+    uint32_t contextGeneration_{};
+  };
+  struct AliasCacheKey {
+    String spelling_;
+    uint32_t contextIndex_{};
+    uint32_t contextGeneration_{};
+
+    operator AliasCacheKeyView() const noexcept { return AliasCacheKeyView{ spelling_, contextIndex_, contextGeneration_ }; }
+  };
+  struct AliasCacheHash {
+    using is_transparent = void;
+    size_t operator()(const AliasCacheKeyView& key) const noexcept { return std::hash<StringView>{}(key.spelling_) ^ (static_cast<size_t>(key.contextIndex_) * 0x9E3779B97F4A7C15ull) ^ key.contextGeneration_; }
+    size_t operator()(const AliasCacheKey& key) const noexcept { return (*this)(static_cast<AliasCacheKeyView>(key)); }
+  };
+  struct AliasCacheEqual {
+    using is_transparent = void;
+    bool operator()(const AliasCacheKeyView& lhs, const AliasCacheKeyView& rhs) const noexcept { return (lhs.spelling_ == rhs.spelling_) && (lhs.contextIndex_ == rhs.contextIndex_) && (lhs.contextGeneration_ == rhs.contextGeneration_); }
+  };
+  struct AliasCache {
+    uint32_t generation_{};
+    std::unordered_map<AliasCacheKey, TokenConstPtr, AliasCacheHash, AliasCacheEqual> resolved_;
   };
 };
 
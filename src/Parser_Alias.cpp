@@ -10,10 +10,8 @@ using namespace zax;
 using namespace std::string_view_literals;
 
 //-----------------------------------------------------------------------------
-bool Parser::consumeAlias(Context& context) noexcept
+bool Parser::consumeAlias(Context& context, Tokenizer::iterator iter) noexcept
 {
-  auto iter{ context->begin() };
-
   if (consumeKeywordAlias(context, iter))
     return true;
 
@@ -41,7 +39,7 @@ bool Parser::consumeKeywordAlias(Context& context, Tokenizer::iterator iter) noe
     ++iter;
 
     if (!isKeyword(context, *iter, Keyword::Keyword)) {
-      out(Error::TokenExpected, pickValid(validOrLastValid(*iter, iter), literal), StringMap{ { "$token$", String{ TokenTypes::KeywordTraits::toString(Keyword::Keyword) } } });
+      out(Error::TokenExpected, pickValid(validOrLastValid(*iter, iter), literal), DiagnosticArguments{ { "$token$", String{ TokenTypes::KeywordTraits::toString(Keyword::Keyword) } } });
       (void)consumeTo(isSeparatorFunc(), iter);
       return true;
     }
@@ -57,13 +55,14 @@ bool Parser::consumeKeywordAlias(Context& context, Tokenizer::iterator iter) noe
 
     String newKeyword{ literal->token_ };
     if (auto found = context.aliasing_.operators_.find(newKeyword); found != context.aliasing_.operators_.end()) {
-      out(Error::KeywordAliasAlreadyDefined, pickValid(validOrLastValid(*iter, iter), literal), StringMap{ {"$alias$", newKeyword} });
+      out(Error::KeywordAliasAlreadyDefined, pickValid(validOrLastValid(*iter, iter), literal), DiagnosticArguments{ {"$alias$", newKeyword} });
       (void)consumeTo(isSeparatorFunc(), iter);
       return true;
     }
     (void)consumeAfter(iter);
 
     context.aliasing_.operators_.emplace(newKeyword, operToken);
+    context.aliasAdded();
     return false;
   }
 
@@ -80,12 +79,13 @@ bool Parser::consumeKeywordAlias(Context& context, Tokenizer::iterator iter) noe
 
   String newKeyword{ literal->token_ };
   if (auto found = context.aliasing_.keywords_.find(newKeyword); found != context.aliasing_.keywords_.end()) {
-    out(Error::KeywordAliasAlreadyDefined, pickValid(validOrLastValid(*iter, iter), literal), StringMap{ {"$alias$", newKeyword} });
+    out(Error::KeywordAliasAlreadyDefined, pickValid(validOrLastValid(*iter, iter), literal), DiagnosticArguments{ {"$alias$", newKeyword} });
     (void)consumeTo(isSeparatorFunc(), iter);
     return true;
   }
 
   (void)consumeAfter(iter);
   context.aliasing_.operators_.emplace(newKeyword, keywordLiteral);
+  context.aliasAdded();
   return true;
 }
@@ -9,11 +9,255 @@ using namespace zax;
 
 using namespace std::string_view_literals;
 
+namespace
+{
+
+struct LineDirective
+{
+  StringView name_;
+  bool requiresAssign_{};
+  bool (*consume_)(Parser&, Context&, Tokenizer::iterator) noexcept {};
+};
+
+constexpr std::array<LineDirective, 13> lineDirectives{ {
+  { "asset"sv, false, [](Parser& parser, Context& context, Tokenizer::iterator iter) noexcept -> bool { return parser.consumeAssetOrSourceDirective(context, iter, false); } },
+  { "source"sv, false, [](Parser& parser, Context& context, Tokenizer::iterator iter) noexcept -> bool { return parser.consumeAssetOrSourceDirective(context, iter, true); } },
+  { "tab-stop"sv, false, [](Parser& parser, Context& context, Tokenizer::iterator iter) noexcept -> bool { return parser.consumeTabStopDirective(context, iter); } },
+  { "file"sv, true, [](Parser& parser, Context& context, Tokenizer::iterator iter) noexcept -> bool { return parser.consumeFileAssignDirective(context, iter); } },
+  { "line"sv, true, [](Parser& parser, Context& context, Tokenizer::iterator iter) noexcept -> bool { return parser.consumeLineAssignDirective(context, iter); } },
+  { "panic"sv, false, [](Parser& parser, Context& context, Tokenizer::iterator iter) noexcept -> bool { return parser.consumePanicDirective(context, iter); } },
+  { "warning"sv, false, [](Parser& parser, Context& context, Tokenizer::iterator iter) noexcept -> bool { return parser.consumeWarningDirective(context, iter); } },
+  { "error"sv, false, [](Parser& parser, Context& context, Tokenizer::iterator iter) noexcept -> bool { return parser.consumeErrorDirective(context, iter); } },
+  { "functions"sv, false, [](Parser& parser, Context& context, Tokenizer::iterator iter) noexcept -> bool { return parser.consumeFunctionsDirective(context, iter); } },
+  { "types"sv, false, [](Parser& parser, Context& context, Tokenizer::iterator iter) noexcept -> bool { return parser.consumeTypesDirective(context, iter); } },
+  { "variables"sv, false, [](Parser& parser, Context& context, Tokenizer::iterator iter) noexcept -> bool { return parser.consumeVariablesDirective(context, iter); } },
+  { "deprecate"sv, false, [](Parser& parser, Context& context, Tokenizer::iterator iter) noexcept -> bool { return parser.consumeDeprecateDirective(context, iter); } },
+  { "export"sv, false, [](Parser& parser, Context& context, Tokenizer::iterator iter) noexcept -> bool { return parser.consumeExportDirective(context, iter); } }
+} };
+
+constexpr size_t lineDirectiveSlotCount{ 32 };
+constexpr std::uint8_t noLineDirective{ 0xFF };
+
+// find a shift of the name hash which places every known directive into its
+// own slot (i.e. a perfect hash over the known names)
+constexpr int findLineDirectiveShift() noexcept
+{
+  for (int shift{}; shift < 64; ++shift) {
+    std::array<bool, lineDirectiveSlotCount> used{};
+    bool perfect{ true };
+    for (auto& directive : lineDirectives) {
+      auto slot{ (Parser::directiveHash(directive.name_) >> shift) % lineDirectiveSlotCount };
+      if (used[slot]) {
+        perfect = false;
+        break;
+      }
+      used[slot] = true;
+    }
+    if (perfect)
+      return shift;
+  }
+  return -1;
+}
+
+constexpr int lineDirectiveShift{ findLineDirectiveShift() };
+static_assert(lineDirectiveShift >= 0);
+
+constexpr auto makeLineDirectiveSlots() noexcept
+{
+  std::array<std::uint8_t, lineDirectiveSlotCount> slots{};
+  for (auto& slot : slots)
+    slot = noLineDirective;
+  for (size_t index{}; index < lineDirectives.size(); ++index)
+    slots[(Parser::directiveHash(lineDirectives[index].name_) >> lineDirectiveShift) % lineDirectiveSlotCount] = static_cast<std::uint8_t>(index);
+  return slots;
+}
+
+constexpr auto lineDirectiveSlots{ makeLineDirectiveSlots() };
+
+//-----------------------------------------------------------------------------
+const LineDirective* findLineDirective(const Parser::DirectiveLiteralResult& literal) noexcept
+{
+  auto index{ lineDirectiveSlots[(literal.hash_ >> lineDirectiveShift) % lineDirectiveSlotCount] };
+  if (noLineDirective == index)
+    return nullptr;
+  auto& directive{ lineDirectives[index] };
+  if (directive.name_ != literal.name_)
+    return nullptr;
+  return &directive;
+}
+
+//-----------------------------------------------------------------------------
+bool acceptDirectiveValue(
+  const Parser::DirectiveSchema& schema,
+  Parser::DirectiveArguments& arguments,
+  Parser::DirectiveValue&& value) noexcept
+{
+  using DirectiveValueKind = Parser::DirectiveValueKind;
+
+  if (!value.argument_)
+    return false;
+
+  auto& argument{ *value.argument_ };
+  if (!argument.accepts(value.kind_))
+    return false;
+  if ((argument.once_) && (arguments.count(argument) > 0))
+    return false;
+
+  switch (value.kind_) {
+    case DirectiveValueKind::None: {
+      if (argument.nameDomain_)
+        value.enum_ = argument.nameDomain_(value.name_);
+      break;
+    }
+    case DirectiveValueKind::Quote: {
+      if ((argument.nonEmpty_) && (value.value_.empty()))
+        return false;
+      break;
+    }
+    case DirectiveValueKind::Literal: {
+      if ((argument.nonEmpty_) && (value.value_.empty()))
+        return false;
+      if (!argument.domains_.front())
+        break;
+      for (value.domain_ = 0; value.domain_ < argument.domains_.size(); ++value.domain_) {
+        auto domain{ argument.domains_[value.domain_] };
+        if (!domain)
+          return false;
+        value.enum_ = domain(value.value_);
+        if (value.enum_)
+          break;
+      }
+      if (!value.enum_)
+        return false;
+      break;
+    }
+    case DirectiveValueKind::Number: {
+      auto number{ toInt(value.value_) };
+      if (!number)
+        return false;
+      if (*number < argument.minimum_)
+        return false;
+      value.number_ = *number;
+      break;
+    }
+    case DirectiveValueKind::Extracted: break;
+  }
+
+  if ((schema.accept_) && (!schema.accept_(arguments, value)))
+    return false;
+
+  arguments.values_.push_back(std::move(value));
+  return true;
+}
+
+using ArgumentSchema = Parser::DirectiveArgumentSchema;
+
+//-----------------------------------------------------------------------------
+std::optional<int> extensionDomain(StringView value) noexcept
+{
+  if (!Parser::isUnknownExtension(value))
+    return {};
+  return 0;
+}
+
+constexpr std::array<ArgumentSchema, 4> assetArguments{ {
+  { .primary_ = true, .quote_ = true, .extracted_ = true, .once_ = true, .nonEmpty_ = true },
+  { .name_ = "required"sv, .literal_ = true, .domains_ = { Parser::enumDomain<Parser::SourceAssetRequiredTraits> }, .once_ = true },
+  { .name_ = "generated"sv, .literal_ = true, .domains_ = { Parser::enumDomain<Parser::YesNoTraits> }, .once_ = true },
+  { .name_ = "rename"sv, .quote_ = true, .extracted_ = true, .nonEmpty_ = true }
+} };
+
+constexpr std::array<ArgumentSchema, 3> sourceArguments{ {
+  assetArguments[0],
+  assetArguments[1],
+  assetArguments[2]
+} };
+
+constexpr std::array<ArgumentSchema, 1> tabStopArguments{ {
+  { .primary_ = true, .number_ = true, .extracted_ = true, .minimum_ = 1 }
+} };
+
+constexpr std::array<ArgumentSchema, 1> fileArguments{ {
+  { .primary_ = true, .quote_ = true, .extracted_ = true, .nonEmpty_ = true }
+} };
+
+constexpr std::array<ArgumentSchema, 2> lineArguments{ {
+  { .primary_ = true, .number_ = true, .extracted_ = true },
+  { .name_ = "increment"sv, .number_ = true, .extracted_ = true, .once_ = true }
+} };
+
+constexpr std::array<ArgumentSchema, 5> deprecateArguments{ {
+  { .primary_ = true, .none_ = true, .literal_ = true, .domains_ = { Parser::enumDomain<Parser::YesNoAlwaysNeverTraits> } },
+  { .name_ = "context"sv, .literal_ = true, .domains_ = { Parser::enumDomain<CompileState::Deprecate::ContextTraits> }, .once_ = true },
+  { .name_ = "error"sv, .none_ = true, .once_ = true },
+  { .name_ = "min"sv, .quote_ = true, .extracted_ = true, .once_ = true },
+  { .name_ = "max"sv, .quote_ = true, .extracted_ = true, .once_ = true }
+} };
+
+constexpr std::array<ArgumentSchema, 1> exportArguments{ {
+  { .primary_ = true, .none_ = true, .literal_ = true, .domains_ = { Parser::enumDomain<Parser::YesNoAlwaysNeverTraits>, Parser::enumDomain<Parser::PushPopTraits> } }
+} };
+
+constexpr std::array<ArgumentSchema, 1> variablesArguments{ {
+  { .primary_ = true, .literal_ = true, .domains_ = { Parser::enumDomain<Parser::VariablesDefaultTraits>, Parser::enumDomain<Parser::PushPopTraits> } }
+} };
+
+constexpr std::array<ArgumentSchema, 1> typesArguments{ {
+  { .primary_ = true, .literal_ = true, .domains_ = { Parser::enumDomain<Parser::TypesDefaultTraits>, Parser::enumDomain<Parser::PushPopTraits> } }
+} };
+
+constexpr std::array<ArgumentSchema, 1> functionsArguments{ {
+  { .primary_ = true, .literal_ = true, .domains_ = { Parser::enumDomain<Parser::FunctionsDefaultTraits>, Parser::enumDomain<Parser::PushPopTraits> } }
+} };
+
+//-----------------------------------------------------------------------------
+bool isDeprecateEnabled(const Parser::DirectiveArguments& arguments) noexcept
+{
+  auto primary{ arguments.primary() };
+  if (!primary)
+    return false;
+  if (Parser::DirectiveValueKind::None == primary->kind_)
+    return true;
+  switch (primary->as<Parser::YesNoAlwaysNever>()) {
+    case Parser::YesNoAlwaysNever::Yes:     return true;
+    case Parser::YesNoAlwaysNever::No:      break;
+    case Parser::YesNoAlwaysNever::Always:  return true;
+    case Parser::YesNoAlwaysNever::Never:   break;
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+bool acceptDeprecateValue(const Parser::DirectiveArguments& arguments, const Parser::DirectiveValue& value) noexcept
+{
+  if (value.primary())
+    return true;
+  if (!isDeprecateEnabled(arguments))
+    return false;
+  if (Parser::DirectiveValueKind::Quote == value.kind_)
+    return static_cast<bool>(SemanticVersion::convert(value.value_));
+  return true;
+}
+
+constexpr Parser::DirectiveSchema assetSchema{ assetArguments };
+constexpr Parser::DirectiveSchema sourceSchema{ sourceArguments };
+constexpr Parser::DirectiveSchema tabStopSchema{ tabStopArguments };
+constexpr Parser::DirectiveSchema fileSchema{ fileArguments };
+constexpr Parser::DirectiveSchema lineSchema{ lineArguments };
+constexpr Parser::DirectiveSchema deprecateSchema{ deprecateArguments, acceptDeprecateValue };
+constexpr Parser::DirectiveSchema exportSchema{ exportArguments };
+constexpr Parser::DirectiveSchema variablesSchema{ variablesArguments };
+constexpr Parser::DirectiveSchema typesSchema{ typesArguments };
+constexpr Parser::DirectiveSchema functionsSchema{ functionsArguments };
+
+} // namespace
+
 //-----------------------------------------------------------------------------
 std::optional<Parser::DirectiveResult> Parser::parseDirective(
   Context& context,
   Tokenizer::iterator iter,
-  ParseDirectiveFunctions& functions) noexcept
+  const DirectiveSchema& schema,
+  DirectiveArguments& arguments) noexcept
 {
   if (iter.isEnd())
     return {};
@@ -21,10 +265,6 @@ std::optional<Parser::DirectiveResult> Parser::parseDirective(
   if (!isOperator(context, *iter, Operator::DirectiveOpen))
     return {};
 
-  const OperatorLut& lut{ *iter.list().operatorLut_ };
-
-  assert(functions.legalName_);
-
   bool lastWasComma{};
   bool syntax{};
   bool forceSyntax{};
@@ -73,7 +313,18 @@ std::optional<Parser::DirectiveResult> Parser::parseDirective(
     }
     iter = literal->afterIter_;
 
-    if (!functions.legalName_(primary, literal->name_)) {
+    auto argument{ schema.find(primary, literal->name_) };
+
+    auto makeValue{ [&argument, &literal](DirectiveValueKind kind) noexcept -> DirectiveValue {
+      DirectiveValue value;
+      value.argument_ = argument;
+      value.literalIter_ = literal->literalIter_;
+      value.name_ = literal->name_;
+      value.kind_ = kind;
+      return value;
+    } };
+
+    if (!argument) {
       if (!Parser::isUnknownExtension(literal->name_)) {
         out(Warning::UnknownDirectiveArgument, *literal->literalIter_);
         understood = false;
@@ -87,7 +338,7 @@ std::optional<Parser::DirectiveResult> Parser::parseDirective(
       if (!isCommaOrCloseDirective(context, *iter))
         break;
 
-      bool check{ functions.noValueFunc_ && functions.noValueFunc_(primary, literal->literalIter_, literal->name_) };
+      bool check{ acceptDirectiveValue(schema, arguments, makeValue(DirectiveValueKind::None)) };
       if (!check) {
         out(Warning::DirectiveNotUnderstood, *literal->literalIter_);
         understood = false;
@@ -112,7 +363,9 @@ std::optional<Parser::DirectiveResult> Parser::parseDirective(
       if (isCommaOrCloseDirective(context, *assigned->afterIter_)) {
         foundLiteral = true;
 
-        auto check{ functions.literalValueFunc_ && functions.literalValueFunc_(primary, literal->literalIter_, literal->name_, assigned->name_) };
+        auto value{ makeValue(DirectiveValueKind::Literal) };
+        value.value_ = assigned->name_;
+        auto check{ acceptDirectiveValue(schema, arguments, std::move(value)) };
         bool literalSuccess{ !((!check) && (!isUnknownExtension(literal->name_))) };
 
         // if this literal was processed then treat it as success, otherwise treat this as an evaluation
@@ -127,7 +380,9 @@ std::optional<Parser::DirectiveResult> Parser::parseDirective(
       if (auto assigned{ parseQuote(iter) }; assigned) {
         if (isCommaOrCloseDirective(context, *assigned->afterIter_)) {
           iter = assigned->afterIter_;
-          auto check{ functions.quoteValueFunc_ && functions.quoteValueFunc_(primary, literal->literalIter_, literal->name_, assigned->quote_) };
+          auto value{ makeValue(DirectiveValueKind::Quote) };
+          value.value_ = std::move(assigned->quote_);
+          auto check{ acceptDirectiveValue(schema, arguments, std::move(value)) };
           if ((!check) && (!isUnknownExtension(literal->name_))) {
             out(Warning::DirectiveNotUnderstood, *literal->literalIter_);
             understood = false;
@@ -140,7 +395,9 @@ std::optional<Parser::DirectiveResult> Parser::parseDirective(
       if (auto assigned{ parseSimpleNumber(context, iter) }; assigned) {
         if (isCommaOrCloseDirective(context, *assigned->afterIter_)) {
           iter = assigned->afterIter_;
-          auto check{ functions.numberValueFunc_ && functions.numberValueFunc_(primary, literal->literalIter_, literal->name_, assigned->number_) };
+          auto value{ makeValue(DirectiveValueKind::Number) };
+          value.value_ = std::move(assigned->number_);
+          auto check{ acceptDirectiveValue(schema, arguments, std::move(value)) };
           if ((!check) && (!isUnknownExtension(literal->name_))) {
             out(Warning::DirectiveNotUnderstood, *literal->literalIter_);
             understood = false;
@@ -151,7 +408,7 @@ std::optional<Parser::DirectiveResult> Parser::parseDirective(
       }
     }
 
-    if ((!functions.extractedValueFunc_) && (!isUnknownExtension(literal->name_))) {
+    if (((!argument) || (!argument->extracted_)) && (!isUnknownExtension(literal->name_))) {
       out(Warning::DirectiveNotUnderstood, *iter);
       understood = false;
       break;
@@ -164,8 +421,9 @@ std::optional<Parser::DirectiveResult> Parser::parseDirective(
     // scope: check will extract function
     {
       auto errorToken{ *startIter ? *startIter : *literal->literalIter_ };
-      auto extraction{ extract(context, startIter, iter) };
-      auto check{ functions.extractedValueFunc_ && functions.extractedValueFunc_(primary, literal->literalIter_, literal->name_, extraction) };
+      auto value{ makeValue(DirectiveValueKind::Extracted) };
+      value.extraction_ = extract(context);
+      auto check{ acceptDirectiveValue(schema, arguments, std::move(value)) };
       if ((!check) && (!isUnknownExtension(literal->name_))) {
         out(Warning::DirectiveNotUnderstood, errorToken);
         understood = false;
@@ -223,172 +481,77 @@ std::optional<ParserDirectiveTypes::DirectiveLiteralResult> Parser::parseDirecti
   DirectiveLiteralResult result;
   result.literalIter_ = iter;
   result.name_ = (*iter)->token_;
+  result.hash_ = directiveHash(result.name_);
+
+  // dashed names are almost always contiguous in the source so the name can
+  // remain a view into the raw buffer; only a name split by whitespace (or
+  // spelled with an alternative dash) needs to be joined into an atom
+  String joined;
+  auto append{ [&result, &joined](StringView piece) noexcept {
+    result.hash_ = directiveHash(piece, result.hash_);
+    if ((joined.empty()) && (piece.data() == result.name_.data() + result.name_.size())) {
+      result.name_ = StringView{ result.name_.data(), result.name_.size() + piece.size() };
+      return;
+    }
+    if (joined.empty())
+      joined = result.name_;
+    joined += piece;
+  } };
 
   auto lastValid{ iter };
-  bool lastWasDash{};
+  TokenConstPtr lastDash;
   while (true) {
     ++iter;
     if (isOperatorOrAlternative(context, lut, *iter, Operator::MinusPreUnary)) {
-      if (lastWasDash)
+      if (lastDash)
         break;
-      lastWasDash = true;
+      lastDash = *iter;
       continue;
     }
     if (!isLiteral(*iter))
       break;
-    if (lastWasDash)
-      result.name_ += "-";
+    if (lastDash)
+      append("-"sv == lastDash->token_ ? lastDash->token_ : "-"sv);
     lastValid = iter;
-    result.name_ += (*iter)->token_;
-    lastWasDash = false;
+    append((*iter)->token_);
+    lastDash.reset();
   }
+  if (!joined.empty())
+    result.name_ = result.literalIter_.list().atom(std::move(joined));
+
   result.afterIter_ = ++lastValid;
   return result;
 }
 
 //-----------------------------------------------------------------------------
-bool Parser::consumeLineParserDirective(Context& context) noexcept
+bool Parser::consumeLineParserDirective(Context& context, Tokenizer::iterator iter) noexcept
 {
-  auto iter{ context->begin() };
-
-  if (!isOperator(context, *iter, Operator::DirectiveOpen))
-    return false;
-
   auto primaryLiteral{ parseDirectiveLiteral(context, iter + 1) };
   if (!primaryLiteral) {
-    ParseDirectiveFunctions nothing;
-    nothing.legalName_ = [](bool, StringView) noexcept -> bool { return true; };
-    auto directive{ parseDirective(context, iter, nothing) };
+    DirectiveArguments nothing;
+    auto directive{ parseDirective(context, iter, DirectiveSchema{}, nothing) };
     assert(directive);
     iter = directive->afterIter_;
     (void)consumeTo(directive->afterIter_);
     return true;
   }
 
-  if ("asset"sv == primaryLiteral->name_)
-    return consumeAssetOrSourceDirective(context, iter, false);
-
-  if ("source"sv == primaryLiteral->name_)
-    return consumeAssetOrSourceDirective(context, iter, true);
-
-  if ("tab-stop"sv == primaryLiteral->name_)
-    return consumeTabStopDirective(context, iter);
+  auto found{ findLineDirective(*primaryLiteral) };
+  if (!found)
+    return false;
 
-  if ("file"sv == primaryLiteral->name_) {
-    if (!isOperatorOrAlternative(context, *(primaryLiteral->afterIter_), Operator::Assign))
-      return false;
-    return consumeFileAssignDirective(context, iter);
-  }
-  if ("line"sv == primaryLiteral->name_) {
+  if (found->requiresAssign_) {
     if (!isOperatorOrAlternative(context, *(primaryLiteral->afterIter_), Operator::Assign))
       return false;
-    return consumeLineAssignDirective(context, iter);
   }
-  if ("panic"sv == primaryLiteral->name_)
-    return consumePanicDirective(context, iter);
-  if ("warning"sv == primaryLiteral->name_)
-    return consumeWarningDirective(context, iter);
-  if ("error"sv == primaryLiteral->name_)
-    return consumeErrorDirective(context, iter);
-  if ("functions"sv == primaryLiteral->name_)
-    return consumeFunctionsDirective(context, iter);
-  if ("types"sv == primaryLiteral->name_)
-    return consumeTypesDirective(context, iter);
-  if ("variables"sv == primaryLiteral->name_)
-    return consumeVariablesDirective(context, iter);
-  if ("deprecate"sv == primaryLiteral->name_)
-    return consumeDeprecateDirective(context, iter);
-  if ("export"sv == primaryLiteral->name_)
-    return consumeExportDirective(context, iter);
-
-  return false;
+  return found->consume_(*this, context, iter);
 }
 
 //-----------------------------------------------------------------------------
 bool Parser::consumeAssetOrSourceDirective(Context& context, Tokenizer::iterator iter, bool isSource) noexcept
 {
-  SourceAssetDirective asset;
-  bool foundSourceOrAsset{};
-  bool foundRename{};
-  bool foundRequired{};
-  bool foundGenerated{};
-
-  ParseDirectiveFunctions functions;
-
-  functions.legalName_ = [isSource](bool primary, StringView name) noexcept -> bool {
-    if (primary)
-      return true;
-    if ("required"sv == name)
-      return true;
-    if ("generated"sv == name)
-      return true;
-    if ((!isSource) && ("rename"sv == name))
-      return true;
-    return false;
-  };
-
-  functions.literalValueFunc_ = [&asset, &foundRequired, &foundGenerated](bool primary, Tokenizer::iterator foundAt, StringView name, StringView value) noexcept -> bool {
-    if (primary)
-      return false;
-    if ("required"sv == name) {
-      if (foundRequired)
-        return false;
-      auto enumValue { SourceAssetRequiredTraits::toEnum(value) };
-      if (!enumValue)
-        return false;
-      asset.required_ = *enumValue;
-      foundRequired = true;
-      return true;
-    }
-    if ("generated"sv == name) {
-      if (foundGenerated)
-        return false;
-      auto enumValue{ YesNoTraits::toEnum(value) };
-      if (!enumValue)
-        return false;
-      asset.generated_ = *enumValue == YesNo::Yes ? true : false;
-      foundGenerated = true;
-      return true;
-    }
-    return false;
-  };
-
-  functions.quoteValueFunc_ = [isSource , &asset, &foundSourceOrAsset, &foundRename](bool primary, Tokenizer::iterator foundAt, StringView name, StringView value) noexcept -> bool {
-    if (value.empty())
-      return false;
-    if (primary) {
-      assert(!foundSourceOrAsset);
-      asset.token_ = (*foundAt);
-      asset.file_ = value;
-      foundSourceOrAsset = true;
-      return true;
-    }
-    if (isSource)
-      return false;
-    if ("rename"sv != name)
-      return false;
-    asset.rename_ = value;
-    foundRename = true;
-    return true;
-  };
-
-  functions.extractedValueFunc_ = [isSource , &asset, &foundSourceOrAsset, &foundRename](bool primary, Tokenizer::iterator foundAt, StringView name, Extraction& value) noexcept -> bool {
-    if (primary) {
-      assert(!foundSourceOrAsset);
-      asset.unresolvedFile_ = value;
-      foundSourceOrAsset = true;
-      return true;
-    }
-    if (isSource)
-      return false;
-    if ("rename"sv != name)
-      return false;
-    asset.unresolvedRename_ = value;
-    foundRename = true;
-    return true;
-  };
-
-  auto directive{ parseDirective(context, iter, functions) };
+  DirectiveArguments arguments;
+  auto directive{ parseDirective(context, iter, isSource ? sourceSchema : assetSchema, arguments) };
 
   assert(directive);
 
@@ -399,6 +562,27 @@ bool Parser::consumeAssetOrSourceDirective(Context& context, Tokenizer::iterator
   if (!directive->success_)
     return true;
 
+  SourceAssetDirective asset;
+
+  if (auto primary{ arguments.primary() }; primary) {
+    if (DirectiveValueKind::Quote == primary->kind_) {
+      asset.token_ = *(primary->literalIter_);
+      asset.file_ = primary->value_;
+    }
+    else
+      asset.unresolvedFile_ = primary->extraction_;
+  }
+  if (auto required{ arguments.find("required"sv) }; required)
+    asset.required_ = required->as<SourceAssetRequired>();
+  if (auto generated{ arguments.find("generated"sv) }; generated)
+    asset.generated_ = generated->as<YesNo>() == YesNo::Yes ? true : false;
+  if (auto rename{ arguments.find("rename"sv) }; rename) {
+    if (DirectiveValueKind::Quote == rename->kind_)
+      asset.rename_ = rename->value_;
+    else
+      asset.unresolvedRename_ = rename->extraction_;
+  }
+
   if (!asset.token_)
     asset.token_ = *(directive->literalIter_);
 
@@ -412,43 +596,21 @@ bool Parser::consumeAssetOrSourceDirective(Context& context, Tokenizer::iterator
 //-----------------------------------------------------------------------------
 bool Parser::consumeTabStopDirective(Context& context, Tokenizer::iterator iter) noexcept
 {
-  std::optional<int> applyTabStop{};
-
-  ParseDirectiveFunctions functions;
-
-  functions.legalName_ = [](bool primary, StringView name) noexcept -> bool {
-    return primary;
-  };
-
-  functions.numberValueFunc_ = [&applyTabStop](bool primary, Tokenizer::iterator foundAt, StringView name, StringView value) noexcept -> bool {
-    assert(primary);
-    assert("tab-stop"sv == name);
-    assert(!foundAt.isEnd());
-
-    auto numValue{ toInt(value) };
-    if (!numValue)
-      return false;
-    if (*numValue < 1)
-      return false;
-    applyTabStop = *numValue;
-    return true;
-  };
-
-  functions.extractedValueFunc_ = [](bool primary, Tokenizer::iterator foundAt, StringView name, Extraction& value) noexcept -> bool {
-    assert(primary);
-    assert("tab-stop"sv == name);
+  DirectiveArguments arguments;
+  auto directive{ parseDirective(context, iter, tabStopSchema, arguments) };
 
+  assert(directive);
+  if (directive->success_) {
+    if (auto primary{ arguments.primary() }; primary) {
+      if (DirectiveValueKind::Number == primary->kind_) {
+        auto& tokenizer{ directive->openIter_.list() };
+        tokenizer.parserPos_.tabStopWidth_ = primary->number_;
+      }
+      else {
 #define RESOLVE_TAB_STOP_NOW 1
 #define RESOLVE_TAB_STOP_NOW 2
-    return true;
-  };
-
-  auto directive{ parseDirective(context, iter, functions) };
-
-  assert(directive);
-  if (directive->success_ && applyTabStop) {
-    auto& tokenizer{ directive->openIter_.list() };
-    tokenizer.parserPos_.tabStopWidth_ = *applyTabStop;
+      }
+    }
   }
 
   (void)consumeTo(directive->afterIter_);
@@ -458,46 +620,25 @@ bool Parser::consumeTabStopDirective(Context& context, Tokenizer::iterator iter)
 //-----------------------------------------------------------------------------
 bool Parser::consumeFileAssignDirective(Context& context, Tokenizer::iterator iter) noexcept
 {
-  String applyFileName;
-
-  ParseDirectiveFunctions functions;
-
-  functions.legalName_ = [](bool primary, StringView name) noexcept -> bool {
-    return primary;
-  };
-
-  functions.quoteValueFunc_ = [&applyFileName](bool primary, Tokenizer::iterator foundAt, StringView name, StringView value) noexcept -> bool {
-    assert(primary);
-
-    if (value.empty())
-      return false;
-
-    assert("file"sv == name);
-    assert(!foundAt.isEnd());
-
-    applyFileName = value;
-    return true;
-  };
-
-  functions.extractedValueFunc_ = [](bool primary, Tokenizer::iterator foundAt, StringView name, Extraction& value) noexcept -> bool {
-    assert(primary);
-
-    assert("file"sv == name);
+  DirectiveArguments arguments;
+  auto directive{ parseDirective(context, iter, fileSchema, arguments) };
 
+  assert(directive);
+  if (directive->success_) {
+    if (auto primary{ arguments.primary() }; primary) {
+      if (DirectiveValueKind::Quote == primary->kind_) {
+        auto& tokenizer{ directive->openIter_.list() };
+        auto newPath{ std::make_shared<SourceTypes::FilePath>(*tokenizer.actualFilePath_) };
+        newPath->filePath_ = primary->value_;
+        newPath->fullFilePath_ = primary->value_;
+        tokenizer.filePath_ = newPath;
+        listing(*(directive->literalIter_), "file"sv, newPath->filePath_);
+      }
+      else {
 #define RESOLVE_FILE_NAME_NOW 1
 #define RESOLVE_FILE_NAME_NOW 2
-    return true;
-  };
-
-  auto directive{ parseDirective(context, iter, functions) };
-
-  assert(directive);
-  if (directive->success_ && (!applyFileName.empty())) {
-    auto& tokenizer{ directive->openIter_.list() };
-    auto newPath{ std::make_shared<SourceTypes::FilePath>(*tokenizer.actualFilePath_) };
-    newPath->filePath_ = applyFileName;
-    newPath->fullFilePath_ = applyFileName;
-    tokenizer.filePath_ = newPath;
+      }
+    }
   }
   (void)consumeTo(directive->afterIter_);
   return true;
@@ -506,71 +647,34 @@ bool Parser::consumeFileAssignDirective(Context& context, Tokenizer::iterator it
 //-----------------------------------------------------------------------------
 bool Parser::consumeLineAssignDirective(Context& context, Tokenizer::iterator iter) noexcept
 {
-  bool foundIncrement{};
-
   int deltaFrom{};
   std::optional<int> applyLine{};
   std::optional<int> applySkip{};
 
-  ParseDirectiveFunctions functions;
-
-  functions.legalName_ = [](bool primary, StringView name) noexcept -> bool {
-    if (primary)
-      return true;
-    if ("increment"sv == name)
-      return true;
-    return false;
-  };
-
-  functions.numberValueFunc_ = [&foundIncrement, &applyLine, &applySkip, &deltaFrom](bool primary, Tokenizer::iterator foundAt, StringView name, StringView value) noexcept -> bool {
-    assert(!foundAt.isEnd());
-
-    auto numValue{ toInt(value) };
-    if (!numValue)
-      return false;
-
-    if (primary) {
-      assert("line"sv == name);
-
-      applyLine = *numValue;
-      deltaFrom = (*foundAt)->actualOrigin_.location_.line_;
-      return true;
-    }
-
-    assert("increment"sv == name);
-    if (foundIncrement)
-      return false;
-
-    foundIncrement = true;
-    applySkip = *numValue;
-    return true;
-  };
-
-  functions.extractedValueFunc_ = [&foundIncrement](bool primary, Tokenizer::iterator foundAt, StringView name, Extraction& value) noexcept -> bool {
-    if (primary) {
-      assert("line"sv == name);
+  DirectiveArguments arguments;
+  auto directive{ parseDirective(context, iter, lineSchema, arguments) };
 
+  assert(directive);
+  if (directive->success_) {
+    if (auto primary{ arguments.primary() }; primary) {
+      if (DirectiveValueKind::Number == primary->kind_) {
+        applyLine = primary->number_;
+        deltaFrom = (*(primary->literalIter_))->actualOrigin_.location_.line_;
+      }
+      else {
 #define RESOLVE_LINE_NOW 1
 #define RESOLVE_LINE_NOW 2
-      //applyLine =
-      return true;
+      }
     }
-
-    assert("increment"sv == name);
-    if (foundIncrement)
-      return false;
-
+    if (auto increment{ arguments.find("increment"sv) }; increment) {
+      if (DirectiveValueKind::Number == increment->kind_)
+        applySkip = increment->number_;
+      else {
 #define RESOLVE_LINE_INCREMENT_NOW 1
 #define RESOLVE_LINE_INCREMENT_NOW 2
-    foundIncrement = true;
-    //applySkip =
-    return true;
-  };
-
-  auto directive{ parseDirective(context, iter, functions) };
+      }
+    }
 
-  assert(directive);
-  if (directive->success_) {
     if (applyLine) {
       if (!applySkip)
         applySkip = 1;
@@ -589,6 +693,9 @@ bool Parser::consumeLineAssignDirective(Context& context, Tokenizer::iterator it
         token->origin_.location_.line_ = calculateNewLine(token->actualOrigin_.location_.line_);
       } };
 
+      if (listing_)
+        listing(*(directive->literalIter_), "line"sv, std::to_string(calculateNewLine(deltaFrom + 1)));
+
       for (auto& parsedToken : tokenizer.parsedTokens_) {
         calculateTokenNewLine(parsedToken);
         for (auto comment{ parsedToken->comment_ }; comment; comment = comment->comment_) {
@@ -607,138 +714,172 @@ bool Parser::consumeLineAssignDirective(Context& context, Tokenizer::iterator it
 namespace {
 
 //-----------------------------------------------------------------------------
-template <typename TEnumType, typename TEnumTraits, bool VAllowMessage, bool VAllowOption>
-std::optional<ParserDirectiveTypes::DirectiveResult> consumeFaultDirective(
-  Parser& parser,
-  Context& context,
-  Tokenizer::iterator iter,
-  String& outMessage,
-  std::optional<ParserDirectiveTypes::FaultOptions>& outOption,
-  std::optional<TEnumType>& outWhich,
-  String &outFoundUnknown,
-  StringMap& outMapping) noexcept
+template <typename TEnumTraits, bool VAllowMessage, bool VAllowOption>
+constexpr auto makeFaultArguments() noexcept
 {
-  assert(!iter.isEnd());
+  constexpr ArgumentSchema primary{
+    .primary_ = true,
+    .literal_ = true,
+    .quote_ = VAllowMessage,
+    .extracted_ = VAllowMessage,
+    .domains_ = VAllowOption ?
+      std::array<Parser::DirectiveDomain, 3>{ Parser::enumDomain<Parser::FaultOptionsTraits>, Parser::enumDomain<TEnumTraits>, extensionDomain } :
+      std::array<Parser::DirectiveDomain, 3>{ Parser::enumDomain<TEnumTraits>, extensionDomain }
+  };
+  constexpr ArgumentSchema which{ .nameDomain_ = Parser::enumDomain<TEnumTraits>, .none_ = true };
+  constexpr ArgumentSchema unknown{ .nameDomain_ = extensionDomain, .none_ = true };
+
+  if constexpr (VAllowMessage) {
+    return std::array<ArgumentSchema, 5>{ {
+      primary,
+      { .name_ = "name"sv, .quote_ = true, .extracted_ = true },
+      { .name_ = "value"sv, .quote_ = true, .extracted_ = true },
+      which,
+      unknown
+    } };
+  }
+  else {
+    return std::array<ArgumentSchema, 3>{ { primary, which, unknown } };
+  }
+}
 
-  String lastName;
-  std::optional<TEnumType> useEnum;
+//-----------------------------------------------------------------------------
+template <bool VAllowOption>
+bool isFaultOption(const Parser::DirectiveValue& value) noexcept
+{
+  if constexpr (VAllowOption)
+    return (value.primary()) && (Parser::DirectiveValueKind::Literal == value.kind_) && (0 == value.domain_);
+  return false;
+}
 
-  ParserDirectiveTypes::ParseDirectiveFunctions functions;
+//-----------------------------------------------------------------------------
+template <bool VAllowOption>
+bool isFaultWhich(const Parser::DirectiveValue& value) noexcept
+{
+  if (Parser::DirectiveValueKind::None == value.kind_)
+    return true;
+  return (value.primary()) && (Parser::DirectiveValueKind::Literal == value.kind_) && (!isFaultOption<VAllowOption>(value));
+}
 
-  functions.legalName_ = [&useEnum](bool primary, StringView name) noexcept -> bool {
-    useEnum.reset();
-    if (primary)
-      return true;
-    if constexpr (VAllowMessage) {
-      if ("name"sv == name)
-        return true;
-      if ("value"sv == name)
-        return true;
-    }
-    useEnum = TEnumTraits::toEnum(name);
-    if (useEnum.has_value())
-      return true;
-    // treat the unknown extension as handled
-    if (Parser::isUnknownExtension(name))
-      return true;
-    return false;
-  };
+//-----------------------------------------------------------------------------
+bool hasPendingFaultName(const Parser::DirectiveArguments& arguments) noexcept
+{
+  bool pending{};
+  for (auto& value : arguments.values_) {
+    if (Parser::DirectiveValueKind::Quote != value.kind_)
+      continue;
+    if (value.primary())
+      continue;
+    pending = ("name"sv == value.name_);
+  }
+  return pending;
+}
 
-  functions.noValueFunc_ = [&outWhich, &outFoundUnknown, &useEnum](bool primary, Tokenizer::iterator foundAt, StringView name) noexcept -> bool {
-    if (primary)
-      return false;
-    if ((outWhich) || (!outFoundUnknown.empty()))
-      return false;
-    outWhich = useEnum;
-    if (!outWhich) {
-      if (Parser::isUnknownExtension(name)) {
-        outFoundUnknown = name;
-        return true;
-      }
-      return false;
-    }
+//-----------------------------------------------------------------------------
+template <bool VAllowOption>
+bool acceptFaultValue(const Parser::DirectiveArguments& arguments, const Parser::DirectiveValue& value) noexcept
+{
+  if (value.primary())
     return true;
-  };
-
-  functions.literalValueFunc_ = [&outOption, &outWhich, &outFoundUnknown](bool primary, Tokenizer::iterator foundAt, StringView name, StringView value) noexcept -> bool {
-    if (!primary)
-      return false;
 
-    if constexpr (VAllowOption) {
-      auto option{ ParserDirectiveTypes::FaultOptionsTraits::toEnum(value) };
-      if (option) {
-        outOption = option;
-        return true;
+  switch (value.kind_) {
+    case Parser::DirectiveValueKind::None: {
+      for (auto& existing : arguments.values_) {
+        if (isFaultWhich<VAllowOption>(existing))
+          return false;
       }
-    }
-    auto which{ TEnumTraits::toEnum(value) };
-    if (which) {
-      outWhich = which;
       return true;
     }
-    if (Parser::isUnknownExtension(value)) {
-      outFoundUnknown = value;
-      return true;
+    case Parser::DirectiveValueKind::Quote: {
+      if (auto primary{ arguments.primary() }; (primary) && (isFaultOption<VAllowOption>(*primary)))
+        return false;
+      [[fallthrough]];
     }
-    return false;
-  };
+    case Parser::DirectiveValueKind::Extracted: {
+      if ("name"sv == value.name_)
+        return !hasPendingFaultName(arguments);
+      if ("value"sv == value.name_)
+        return hasPendingFaultName(arguments);
+      return false;
+    }
+    default: break;
+  }
+  return false;
+}
 
-  functions.quoteValueFunc_ = [&outMessage, &outOption, &lastName, &outMapping](bool primary, Tokenizer::iterator foundAt, StringView name, StringView value) noexcept -> bool {
-    if constexpr (VAllowMessage) {
-      if (primary) {
-        outMessage = value;
-        return true;
-      }
+template <typename TEnumTraits, bool VAllowMessage, bool VAllowOption>
+constexpr auto faultArguments{ makeFaultArguments<TEnumTraits, VAllowMessage, VAllowOption>() };
 
-      if (outOption)
-        return false;
+template <typename TEnumTraits, bool VAllowMessage, bool VAllowOption>
+constexpr Parser::DirectiveSchema faultSchema{ faultArguments<TEnumTraits, VAllowMessage, VAllowOption>, acceptFaultValue<VAllowOption> };
 
-      if ("name"sv == name) {
-        if (!lastName.empty())
-          return false;
-        lastName = value;
-        return true;
+//-----------------------------------------------------------------------------
+template <typename TEnumType, typename TEnumTraits, bool VAllowMessage, bool VAllowOption>
+std::optional<ParserDirectiveTypes::DirectiveResult> consumeFaultDirective(
+  Parser& parser,
+  Context& context,
+  Tokenizer::iterator iter,
+  String& outMessage,
+  std::optional<ParserDirectiveTypes::FaultOptions>& outOption,
+  std::optional<TEnumType>& outWhich,
+  String &outFoundUnknown,
+  DiagnosticArguments& outMapping) noexcept
+{
+  assert(!iter.isEnd());
+
+  Parser::DirectiveArguments arguments;
+  auto result{ parser.parseDirective(context, iter, faultSchema<TEnumTraits, VAllowMessage, VAllowOption>, arguments) };
+
+  String lastName;
+  for (auto& value : arguments.values_) {
+    switch (value.kind_) {
+      case Parser::DirectiveValueKind::None: {
+        outWhich = TEnumTraits::toEnum(value.name_);
+        if (!outWhich)
+          outFoundUnknown = value.name_;
+        break;
       }
-      if ("value"sv == name) {
-        if (lastName.empty())
-          return false;
-        outMapping[lastName] = value;
+      case Parser::DirectiveValueKind::Literal: {
+        if (isFaultOption<VAllowOption>(value))
+          outOption = value.as<ParserDirectiveTypes::FaultOptions>();
+        else if ((VAllowOption ? 1 : 0) == value.domain_)
+          outWhich = value.as<TEnumType>();
+        else
+          outFoundUnknown = value.value_;
+        break;
+      }
+      case Parser::DirectiveValueKind::Quote: {
+        if (value.primary()) {
+          outMessage = value.value_;
+          break;
+        }
+        if ("name"sv == value.name_) {
+          lastName = value.value_;
+          break;
+        }
+        outMapping[lastName] = value.value_;
         lastName.clear();
-        return true;
+        break;
       }
-    }
-    return false;
-  };
-
-  functions.extractedValueFunc_ = [&outMessage, &lastName, &outMapping](bool primary, Tokenizer::iterator foundAt, StringView name, ParserTypes::Extraction& value) noexcept -> bool {
-    if constexpr (VAllowMessage) {
-      if (primary) {
+      case Parser::DirectiveValueKind::Extracted: {
+        if (value.primary()) {
 #define RESOLVE_MESSAGE_NOW 1
 #define RESOLVE_MESSAGE_NOW 2
-        //message =
-        return true;
-      }
-
-      if ("name"sv == name) {
-        if (!lastName.empty())
-          return false;
+          break;
+        }
+        if ("name"sv == value.name_) {
 #define RESOLVE_NAME_NOW 1
 #define RESOLVE_NAME_NOW 2
-        return true;
-      }
-
-      if ("value"sv == name) {
-        if (lastName.empty())
-          return false;
+          break;
+        }
 #define RESOLVE_NAME_VALUE_NOW 1
 #define RESOLVE_NAME_VALUE_NOW 2
-        return true;
+        break;
       }
+      default: break;
     }
-    return false;
-  };
+  }
 
-  auto result{ parser.parseDirective(context, iter, functions) };
   if (result) {
     if (result->success_) {
       if (!lastName.empty()) {
@@ -780,10 +921,16 @@ void applyToSources(
   bool stopAtSeparator = false) noexcept
 {
   bool topmost{ true };
-  auto& sources{ context.parser().sources_ };
+  auto& parser{ context.parser() };
+  auto& sources{ parser.sources_ };
   for (auto& source : sources) {
     if (!applyToParsedTokens(context, *source->tokenizer_, state, topmost && stopAtSeparator))
       return;
+
+    // the includers' tokens are not part of a parse result so replay has to
+    // reach them the same way
+    if ((topmost) && (parser.recording_) && (sources.size() > 1))
+      parser.recording_->entries_.push_back(ParseResult::Entry{ .kind_ = ParseResult::Kind::Apply, .state_ = state });
     topmost = false;
   }
 }
@@ -916,7 +1063,7 @@ bool Parser::consumePanicDirective(Context& context, Tokenizer::iterator iter) n
   std::optional<ParserDirectiveTypes::FaultOptions> option;
   std::optional<PanicTypes::Panic> which;
   String foundUnknown;
-  StringMap mapping;
+  DiagnosticArguments mapping;
   auto directive{ consumeFaultDirective<PanicTypes::Panic, PanicTypes::PanicTraits, false, true>(*this, context, iter, message, option, which, foundUnknown, mapping) };
   if (!directive)
     return false;
@@ -935,6 +1082,9 @@ bool Parser::consumePanicDirective(Context& context, Tokenizer::iterator iter) n
     if (!foundUnknown.empty())
       break;
 
+    if (listing_)
+      listing(*(directive->literalIter_), "panic"sv, String{ ParserDirectiveTypes::FaultOptionsTraits::toString(*option) } + " " + String{ which ? PanicTypes::PanicTraits::toString(*which) : "all"sv });
+
     applyFaultDirective<PanicTypes::Panic, Panics, false>(
       context,
       directive->literalIter_,
@@ -955,7 +1105,7 @@ bool Parser::consumeWarningDirective(Context& context, Tokenizer::iterator iter)
   std::optional<ParserDirectiveTypes::FaultOptions> option;
   std::optional<WarningTypes::Warning> which;
   String foundUnknown;
-  StringMap mapping;
+  DiagnosticArguments mapping;
   auto directive{ consumeFaultDirective<WarningTypes::Warning, WarningTypes::WarningTraits, true, true>(*this, context, iter, message, option, which, foundUnknown, mapping) };
   if (!directive)
     return false;
@@ -988,6 +1138,9 @@ bool Parser::consumeWarningDirective(Context& context, Tokenizer::iterator iter)
     if (!foundUnknown.empty())
       break;
 
+    if (listing_)
+      listing(*(directive->literalIter_), "warning"sv, String{ ParserDirectiveTypes::FaultOptionsTraits::toString(*option) } + " " + String{ which ? WarningTypes::WarningTraits::toString(*which) : "all"sv });
+
     applyFaultDirective<WarningTypes::Warning, Warnings, true>(
       context,
       directive->literalIter_,
@@ -1008,7 +1161,7 @@ bool Parser::consumeErrorDirective(Context& context, Tokenizer::iterator iter) n
   std::optional<ParserDirectiveTypes::FaultOptions> option;
   std::optional<ErrorTypes::Error> which;
   String foundUnknown;
-  StringMap mapping;
+  DiagnosticArguments mapping;
   auto directive{ consumeFaultDirective<ErrorTypes::Error, ErrorTypes::ErrorTraits, true, false>(*this, context, iter, message, option, which, foundUnknown, mapping) };
   if (!directive)
     return false;
@@ -1045,158 +1198,52 @@ bool Parser::consumeErrorDirective(Context& context, Tokenizer::iterator iter) n
 //-----------------------------------------------------------------------------
 bool Parser::consumeDeprecateDirective(Context& context, Tokenizer::iterator iter) noexcept
 {
-  std::optional<YesNoAlwaysNever> option{};
-  std::optional<CompileState::Deprecate::Context> csContext{};
-  std::optional<bool> error{};
-  std::optional<SemanticVersion> min;
-  std::optional<SemanticVersion> max;
-
-  auto optionNotSetOrNever{ [&option]() noexcept -> bool {
-    if (!option)
-      return true;
-    switch (*option) {
-      case YesNoAlwaysNever::Yes:     break;
-      case YesNoAlwaysNever::No:      return true;
-      case YesNoAlwaysNever::Always:  break;
-      case YesNoAlwaysNever::Never:   return true;
-    }
-    return false;
-  } };
-
-  ParseDirectiveFunctions functions;
-
-  functions.legalName_ = [](bool primary, StringView name) noexcept -> bool {
-    if (primary)
-      return true;
-    if ("context"sv == name)
-      return true;
-    if ("error"sv == name)
-      return true;
-    if ("min"sv == name)
-      return true;
-    if ("max"sv == name)
-      return true;
-    return false;
-  };
-
-  functions.noValueFunc_ = [&optionNotSetOrNever, &option, &error](bool primary, Tokenizer::iterator foundAt, StringView name) noexcept -> bool {
-    if (primary) {
-      option = YesNoAlwaysNever::Yes;
-      return true;
-    }
-
-    if (optionNotSetOrNever())
-      return false;
-
-    if (error)
-      return false;
-
-    if ("error"sv != name)
-      return false;
-
-    error = true;
-    return true;
-  };
-
-  functions.literalValueFunc_ = [&optionNotSetOrNever, &option, &csContext](bool primary, Tokenizer::iterator foundAt, StringView name, StringView value) noexcept -> bool {
-    if (primary) {
-      option = YesNoAlwaysNeverTraits::toEnum(value);
-      return static_cast<bool>(option);
-    }
-
-    if (optionNotSetOrNever())
-      return false;
-
-    if ("context"sv == name) {
-      if (csContext.has_value())
-        return false;
-      csContext = CompileState::Deprecate::ContextTraits::toEnum(value);
-      if (!csContext)
-        return false;
-      return true;
-    }
-    return false;
-  };
-
-  functions.quoteValueFunc_ = [&optionNotSetOrNever, &min, &max](bool primary, Tokenizer::iterator foundAt, StringView name, StringView value) noexcept -> bool {
-    if (primary)
-      return false;
-
-    if (optionNotSetOrNever())
-      return false;
-
-#define VERSIONING_VALIDATION_CHECK 1
-#define VERSIONING_VALIDATION_CHECK 2
-
-    if ("min"sv == name) {
-      if (min.has_value())
-        return false;
-      min = SemanticVersion::convert(value);
-      if (!min)
-        return false;
-      return true;
-    }
-    if ("max"sv == name) {
-      if (max.has_value())
-        return false;
-      max = SemanticVersion::convert(value);
-      if (!max)
-        return false;
-      return true;
-    }
-    return false;
-  };
-
-
-  functions.extractedValueFunc_ = [&optionNotSetOrNever, &min, &max](bool primary, Tokenizer::iterator foundAt, StringView name, ParserTypes::Extraction& value) noexcept -> bool {
-    if (primary)
-      return false;
-
-    if (optionNotSetOrNever())
-      return false;
-    
-
-    if ("min"sv == name) {
-      if (min.has_value())
-        return false;
-#define RESOLVE_DEPRECATE_MIN_NOW 1
-#define RESOLVE_DEPRECATE_MIN_NOW 2
-
-      return true;
-    }
-    if ("max"sv == name) {
-      if (max.has_value())
-        return false;
-
-#define RESOLVE_DEPRECATE_MAX_NOW 1
-#define RESOLVE_DEPRECATE_MAX_NOW 2
-
-      return true;
-    }
-    return false;
-  };
-
-
-  auto directive{ parseDirective(context, iter, functions) };
+  DirectiveArguments arguments;
+  auto directive{ parseDirective(context, iter, deprecateSchema, arguments) };
   assert(directive);
   if (directive->success_) {
+    auto primary{ arguments.primary() };
+    assert(primary);
+    auto option{ DirectiveValueKind::None == primary->kind_ ? YesNoAlwaysNever::Yes : primary->as<YesNoAlwaysNever>() };
+
     bool singleLineState{ false };
     auto tempState{ CompileState::fork(context.state()) };
-    switch (*option) {
+    switch (option) {
       case YesNoAlwaysNever::Yes:     singleLineState = true; break;
       case YesNoAlwaysNever::No:      singleLineState = true; break;
       case YesNoAlwaysNever::Always:  break;
       case YesNoAlwaysNever::Never:   break;
     }
-    if (!optionNotSetOrNever()) {
+    if (isDeprecateEnabled(arguments)) {
       tempState->deprecate_.emplace();
       tempState->deprecate_->origin_ = (*directive->literalIter_)->origin_;
-      if (csContext)
-        tempState->deprecate_->context_ = *csContext;
-      if (error.has_value())
-        tempState->deprecate_->forceError_ = *error;
-      tempState->deprecate_->min_ = min;
-      tempState->deprecate_->max_ = max;
+      if (auto csContext{ arguments.find("context"sv) }; csContext)
+        tempState->deprecate_->context_ = csContext->as<CompileState::Deprecate::Context>();
+      if (arguments.find("error"sv))
+        tempState->deprecate_->forceError_ = true;
+
+#define VERSIONING_VALIDATION_CHECK 1
+#define VERSIONING_VALIDATION_CHECK 2
+
+      auto applyVersion{ [&arguments](StringView name, std::optional<SemanticVersion>& version) noexcept {
+        auto found{ arguments.find(name) };
+        if (!found)
+          return;
+        if (DirectiveValueKind::Quote == found->kind_) {
+          version = SemanticVersion::convert(found->value_);
+          return;
+        }
+        if ("min"sv == name) {
+#define RESOLVE_DEPRECATE_MIN_NOW 1
+#define RESOLVE_DEPRECATE_MIN_NOW 2
+          return;
+        }
+#define RESOLVE_DEPRECATE_MAX_NOW 1
+#define RESOLVE_DEPRECATE_MAX_NOW 2
+      } };
+
+      applyVersion("min"sv, tempState->deprecate_->min_);
+      applyVersion("max"sv, tempState->deprecate_->max_);
     }
     else
       tempState->deprecate_.reset();
@@ -1213,39 +1260,20 @@ bool Parser::consumeDeprecateDirective(Context& context, Tokenizer::iterator ite
 //-----------------------------------------------------------------------------
 bool Parser::consumeExportDirective(Context& context, Tokenizer::iterator iter) noexcept
 {
-  std::optional<YesNoAlwaysNever> option{};
-  std::optional<PushPop> pushOption{};
-
-  ParseDirectiveFunctions functions;
-
-  functions.legalName_ = [](bool primary, StringView name) noexcept -> bool {
-    return primary;
-  };
-
-  functions.noValueFunc_ = [&option](bool primary, Tokenizer::iterator foundAt, StringView name) noexcept -> bool {
-    if (!primary)
-      return false;
-    option = YesNoAlwaysNever::Yes;
-    return true;
-  };
-
-  functions.literalValueFunc_ = [&option, &pushOption](bool primary, Tokenizer::iterator foundAt, StringView name, StringView value) noexcept -> bool {
-    if (!primary)
-      return false;
-    option = YesNoAlwaysNeverTraits::toEnum(value);
-    pushOption = PushPopTraits::toEnum(value);
-    return static_cast<bool>(option) || static_cast<bool>(pushOption);
-  };
-
-  auto directive{ parseDirective(context, iter, functions) };
+  DirectiveArguments arguments;
+  auto directive{ parseDirective(context, iter, exportSchema, arguments) };
   assert(directive);
   if (directive->success_) {
+    auto primary{ arguments.primary() };
+    assert(primary);
+
     bool success{ true };
     bool singleLineState{ false };
     auto tempState{ CompileState::fork(context.state()) };
-    if (option) {
+    if ((DirectiveValueKind::None == primary->kind_) || (0 == primary->domain_)) {
+      auto option{ DirectiveValueKind::None == primary->kind_ ? YesNoAlwaysNever::Yes : primary->as<YesNoAlwaysNever>() };
       bool yes{};
-      switch (*option) {
+      switch (option) {
         case YesNoAlwaysNever::Yes:     yes = singleLineState = true; break;
         case YesNoAlwaysNever::No:      yes = false;  singleLineState = true; break;
         case YesNoAlwaysNever::Always:  yes = true; break;
@@ -1254,7 +1282,7 @@ bool Parser::consumeExportDirective(Context& context, Tokenizer::iterator iter)
       tempState->export_.export_ = yes;
     }
     else {
-      switch (*pushOption) {
+      switch (primary->as<PushPop>()) {
         case PushPop::Push: tempState->pushExport(); break;
         case PushPop::Pop: {
           if (!tempState->popExport()) {
@@ -1280,50 +1308,17 @@ bool Parser::consumeExportDirective(Context& context, Tokenizer::iterator iter)
 //-----------------------------------------------------------------------------
 bool Parser::consumeVariablesDirective(Context& context, Tokenizer::iterator iter) noexcept
 {
-  enum class VariablesDefault {
-    Mutable,
-    Immutable,
-    Final,
-    Varies
-  };
-
-  struct VariablesDefaultDeclare final : public zs::EnumDeclare<VariablesDefault, 4>
-  {
-    constexpr const Entries operator()() const noexcept
-    {
-      return { {
-        {VariablesDefault::Mutable, "mutable"},
-        {VariablesDefault::Immutable, "immutable"},
-        {VariablesDefault::Final, "final"},
-        {VariablesDefault::Varies, "varies"}
-      } };
-    }
-  };
-
-  using VariablesDefaultTraits = zs::EnumTraits<VariablesDefault, VariablesDefaultDeclare>;
-
-  std::optional<VariablesDefault> _default{};
-  std::optional<PushPop> pushOption{};
-
-  ParseDirectiveFunctions functions;
-
-  functions.legalName_ = [](bool primary, StringView name) noexcept -> bool {
-    return primary;
-  };
-
-  functions.literalValueFunc_ = [&_default, &pushOption](bool primary, Tokenizer::iterator foundAt, StringView name, StringView value) noexcept -> bool {
-    _default = VariablesDefaultTraits::toEnum(value);
-    pushOption = PushPopTraits::toEnum(value);
-    return static_cast<bool>(_default) || static_cast<bool>(pushOption);
-  };
-
-  auto directive{ parseDirective(context, iter, functions) };
+  DirectiveArguments arguments;
+  auto directive{ parseDirective(context, iter, variablesSchema, arguments) };
   assert(directive);
   if (directive->success_) {
+    auto primary{ arguments.primary() };
+    assert(primary);
+
     bool success{ true };
     auto tempState{ CompileState::fork(context.state()) };
-    if (_default) {
-      switch (*_default) {
+    if (0 == primary->domain_) {
+      switch (primary->as<VariablesDefault>()) {
         case VariablesDefault::Mutable:     tempState->variableDefaults_.mutable_ = true; break;
         case VariablesDefault::Immutable:   tempState->variableDefaults_.mutable_ = false; break;
         case VariablesDefault::Varies:      tempState->variableDefaults_.varies_ = true; break;
@@ -1331,7 +1326,7 @@ bool Parser::consumeVariablesDirective(Context& context, Tokenizer::iterator ite
       }
     }
     else {
-      switch (*pushOption) {
+      switch (primary->as<PushPop>()) {
         case PushPop::Push: tempState->pushVariableDefaults(); break;
         case PushPop::Pop: {
           if (!tempState->popVariableDefaults()) {
@@ -1354,50 +1349,17 @@ bool Parser::consumeVariablesDirective(Context& context, Tokenizer::iterator ite
 //-----------------------------------------------------------------------------
 bool Parser::consumeTypesDirective(Context& context, Tokenizer::iterator iter) noexcept
 {
-  enum class TypesDefault {
-    Mutable,
-    Immutable,
-    Constant,
-    Inconstant
-  };
-
-  struct TypesDefaultDeclare final : public zs::EnumDeclare<TypesDefault, 4>
-  {
-    constexpr const Entries operator()() const noexcept
-    {
-      return { {
-        {TypesDefault::Mutable, "mutable"},
-        {TypesDefault::Immutable, "immutable"},
-        {TypesDefault::Constant, "constant"},
-        {TypesDefault::Inconstant, "inconstant"}
-      } };
-    }
-  };
-
-  using TypesDefaultTraits = zs::EnumTraits<TypesDefault, TypesDefaultDeclare>;
-
-  std::optional<TypesDefault> _default{};
-  std::optional<PushPop> pushOption{};
-
-  ParseDirectiveFunctions functions;
-
-  functions.legalName_ = [](bool primary, StringView name) noexcept -> bool {
-    return primary;
-  };
-
-  functions.literalValueFunc_ = [&_default, &pushOption](bool primary, Tokenizer::iterator foundAt, StringView name, StringView value) noexcept -> bool {
-    _default = TypesDefaultTraits::toEnum(value);
-    pushOption = PushPopTraits::toEnum(value);
-    return static_cast<bool>(_default) || static_cast<bool>(pushOption);
-  };
-
-  auto directive{ parseDirective(context, iter, functions) };
+  DirectiveArguments arguments;
+  auto directive{ parseDirective(context, iter, typesSchema, arguments) };
   assert(directive);
   if (directive->success_) {
+    auto primary{ arguments.primary() };
+    assert(primary);
+
     bool success{ true };
     auto tempState{ CompileState::fork(context.state()) };
-    if (_default) {
-      switch (*_default) {
+    if (0 == primary->domain_) {
+      switch (primary->as<TypesDefault>()) {
         case TypesDefault::Mutable:     tempState->typeDefaults_.mutable_ = true; break;
         case TypesDefault::Immutable:   tempState->typeDefaults_.mutable_ = false; break;
         case TypesDefault::Constant:    tempState->typeDefaults_.constant_ = true; break;
@@ -1405,7 +1367,7 @@ bool Parser::consumeTypesDirective(Context& context, Tokenizer::iterator iter) n
       }
     }
     else {
-      switch (*pushOption) {
+      switch (primary->as<PushPop>()) {
         case PushPop::Push: tempState->pushTypeDefaults(); break;
         case PushPop::Pop: {
           if (!tempState->popTypeDefaults()) {
@@ -1428,49 +1390,20 @@ bool Parser::consumeTypesDirective(Context& context, Tokenizer::iterator iter) n
 //-----------------------------------------------------------------------------
 bool Parser::consumeFunctionsDirective(Context& context, Tokenizer::iterator iter) noexcept
 {
-  enum class FunctionsDefault {
-    Constant,
-    Inconstant
-  };
-
-  struct FunctionsDefaultDeclare final : public zs::EnumDeclare<FunctionsDefault, 2>
-  {
-    constexpr const Entries operator()() const noexcept
-    {
-      return { {
-        {FunctionsDefault::Constant, "constant"},
-        {FunctionsDefault::Inconstant, "inconstant"}
-      } };
-    }
-  };
-
-  using FunctionsDefaultTraits = zs::EnumTraits<FunctionsDefault, FunctionsDefaultDeclare>;
-
-  std::optional<FunctionsDefault> _default{};
-  std::optional<PushPop> pushOption{};
-
-  ParseDirectiveFunctions functions;
-
-  functions.legalName_ = [](bool primary, StringView name) noexcept -> bool {
-    return primary;
-  };
-
-  functions.literalValueFunc_ = [& _default, &pushOption](bool primary, Tokenizer::iterator foundAt, StringView name, StringView value) noexcept -> bool {
-    _default = FunctionsDefaultTraits::toEnum(value);
-    pushOption = PushPopTraits::toEnum(value);
-    return static_cast<bool>(_default) || static_cast<bool>(pushOption);
-  };
-
-  auto directive{ parseDirective(context, iter, functions) };
+  DirectiveArguments arguments;
+  auto directive{ parseDirective(context, iter, functionsSchema, arguments) };
   assert(directive);
   if (directive->success_) {
+    auto primary{ arguments.primary() };
+    assert(primary);
+
     bool success{ true };
     auto tempState{ CompileState::fork(context.state()) };
-    if (_default) {
-      tempState->functionDefaults_.constant_ = (*_default) == FunctionsDefault::Constant;
+    if (0 == primary->domain_) {
+      tempState->functionDefaults_.constant_ = primary->as<FunctionsDefault>() == FunctionsDefault::Constant;
     }
     else {
-      switch (*pushOption) {
+      switch (primary->as<PushPop>()) {
         case PushPop::Push: tempState->pushFunctionDefaults(); break;
         case PushPop::Pop: {
           if (!tempState->popFunctionDefaults()) {
@@ -1510,21 +1443,35 @@ void Parser::handleAsset(Context& context, SourceAssetDirective& asset) noexcept
   newAsset.generated_ = asset.generated_;
   newAsset.parentTabStopWidth_ = context->parserPos_.tabStopWidth_;
 
+  // the request is recorded unresolved as replaying resolves it again
+  if (recording_)
+    recording_->entries_.push_back(ParseResult::Entry{ .kind_ = ParseResult::Kind::Asset, .request_ = newAsset });
+
+  auto recording{ std::exchange(recording_, nullptr) };
+  requestAsset(newAsset);
+  recording_ = recording;
+}
+
+//-----------------------------------------------------------------------------
+void Parser::requestAsset(const SourceAsset& request) noexcept
+{
+  SourceAsset newAsset{ request };
+
   std::list<LocateWildCardFilesResult> results;
-  locateWildCardFiles(results, asset.token_->actualOrigin_.filePath_->filePath_, asset.file_);
+  locateWildCardFiles(results, request.token_->actualOrigin_.filePath_->filePath_, request.filePath_, false, &fileSystemCache_);
 
   if (results.size()) {
     for (auto& located : results) {
       newAsset.filePath_ = located.path_;
       newAsset.fullFilePath_ = located.fullPath_;
-      newAsset.renameFilePath_ = asset.rename_;
+      newAsset.renameFilePath_ = request.renameFilePath_;
 
       String& replacingStr{ newAsset.renameFilePath_ };
       bool failure{};
       for (auto& match : located.foundMatches_) {
         auto pos{ replacingStr.find_first_of("?*"sv) };
         if (String::npos == pos) {
-          out(Error::WildCharacterMismatch, asset.token_, StringMap{ { "$wild$", replacingStr } });
+          out(Error::WildCharacterMismatch, request.token_, DiagnosticArguments{ { "$wild$", replacingStr } });
           failure = true;
           break;
         }
@@ -1557,17 +1504,34 @@ void Parser::handleSource(Context& context, SourceAssetDirective& source) noexce
   newSource.generated_ = source.generated_;
   newSource.parentTabStopWidth_ = context->parserPos_.tabStopWidth_;
 
+  if (recording_)
+    recording_->entries_.push_back(ParseResult::Entry{ .kind_ = ParseResult::Kind::Source, .request_ = newSource });
+
+  auto recording{ std::exchange(recording_, nullptr) };
+  requestSource(newSource);
+  recording_ = recording;
+}
+
+//-----------------------------------------------------------------------------
+void Parser::requestSource(const SourceAsset& request) noexcept
+{
+  SourceAsset newSource{ request };
+
   std::list<LocateWildCardFilesResult> results;
-  locateWildCardFiles(results, source.token_->actualOrigin_.filePath_->filePath_, source.file_);
+  locateWildCardFiles(results, request.token_->actualOrigin_.filePath_->filePath_, request.filePath_, false, &fileSystemCache_);
 
   if (results.size()) {
     for (auto& located : results) {
       newSource.filePath_ = located.path_;
       newSource.fullFilePath_ = located.fullPath_;
+      listing(request.token_, "source"sv, newSource.fullFilePath_);
+      prefetch(newSource);
       pendingSources_.push_back(newSource);
     }
   }
   else {
+    listing(request.token_, "source"sv, newSource.fullFilePath_);
+    prefetch(newSource);
     pendingSources_.push_front(newSource);
   }
 }
@@ -0,0 +1,201 @@
+#include "pch.h"
+#include "Sha256.h"
+
+#include <cstring>
+
+using namespace zax;
+
+namespace
+{
+
+constexpr std::array<std::uint32_t, 64> RoundConstants{
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+//-----------------------------------------------------------------------------
+constexpr std::uint32_t rotateRight(std::uint32_t value, int bits) noexcept
+{
+  return (value >> bits) | (value << (32 - bits));
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+Sha256::Sha256() noexcept :
+  state_{ 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 }
+{
+}
+
+//-----------------------------------------------------------------------------
+void Sha256::transform(const std::uint8_t* block) noexcept
+{
+  std::array<std::uint32_t, 64> words;
+  for (size_t index{}; index < 16; ++index) {
+    words[index] =
+      (static_cast<std::uint32_t>(block[index * 4]) << 24) |
+      (static_cast<std::uint32_t>(block[index * 4 + 1]) << 16) |
+      (static_cast<std::uint32_t>(block[index * 4 + 2]) << 8) |
+      static_cast<std::uint32_t>(block[index * 4 + 3]);
+  }
+  for (size_t index{ 16 }; index < words.size(); ++index) {
+    auto s0{ rotateRight(words[index - 15], 7) ^ rotateRight(words[index - 15], 18) ^ (words[index - 15] >> 3) };
+    auto s1{ rotateRight(words[index - 2], 17) ^ rotateRight(words[index - 2], 19) ^ (words[index - 2] >> 10) };
+    words[index] = words[index - 16] + s0 + words[index - 7] + s1;
+  }
+
+  auto [a, b, c, d, e, f, g, h] { state_ };
+  for (size_t index{}; index < words.size(); ++index) {
+    auto s1{ rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25) };
+    auto choose{ (e & f) ^ ((~e) & g) };
+    auto temp1{ h + s1 + choose + RoundConstants[index] + words[index] };
+    auto s0{ rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22) };
+    auto majority{ (a & b) ^ (a & c) ^ (b & c) };
+    auto temp2{ s0 + majority };
+
+    h = g;
+    g = f;
+    f = e;
+    e = d + temp1;
+    d = c;
+    c = b;
+    b = a;
+    a = temp1 + temp2;
+  }
+
+  state_[0] += a;
+  state_[1] += b;
+  state_[2] += c;
+  state_[3] += d;
+  state_[4] += e;
+  state_[5] += f;
+  state_[6] += g;
+  state_[7] += h;
+}
+
+//-----------------------------------------------------------------------------
+void Sha256::update(const void* data, size_t length) noexcept
+{
+  auto bytes{ static_cast<const std::uint8_t*>(data) };
+  length_ += length;
+
+  if (used_ > 0) {
+    auto take{ std::min(length, BlockSize - used_) };
+    std::memcpy(block_.data() + used_, bytes, take);
+    used_ += take;
+    bytes += take;
+    length -= take;
+    if (used_ < BlockSize)
+      return;
+    transform(block_.data());
+    used_ = 0;
+  }
+
+  for (; length >= BlockSize; bytes += BlockSize, length -= BlockSize)
+    transform(bytes);
+
+  if (length > 0) {
+    std::memcpy(block_.data(), bytes, length);
+    used_ = length;
+  }
+}
+
+//-----------------------------------------------------------------------------
+Sha256::Digest Sha256::finish() noexcept
+{
+  auto bits{ length_ * 8 };
+
+  block_[used_++] = 0x80;
+  if (used_ > BlockSize - 8) {
+    std::fill(block_.begin() + used_, block_.end(), std::uint8_t{});
+    transform(block_.data());
+    used_ = 0;
+  }
+  std::fill(block_.begin() + used_, block_.end() - 8, std::uint8_t{});
+  for (size_t index{}; index < 8; ++index)
+    block_[BlockSize - 1 - index] = static_cast<std::uint8_t>(bits >> (index * 8));
+  transform(block_.data());
+
+  Digest result;
+  for (size_t index{}; index < state_.size(); ++index) {
+    result[index * 4] = static_cast<std::uint8_t>(state_[index] >> 24);
+    result[index * 4 + 1] = static_cast<std::uint8_t>(state_[index] >> 16);
+    result[index * 4 + 2] = static_cast<std::uint8_t>(state_[index] >> 8);
+    result[index * 4 + 3] = static_cast<std::uint8_t>(state_[index]);
+  }
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+Sha256::Digest Sha256::hash(const void* data, size_t length) noexcept
+{
+  Sha256 sha;
+  sha.update(data, length);
+  return sha.finish();
+}
+
+//-----------------------------------------------------------------------------
+std::optional<Sha256::Digest> Sha256::hashFile(const Path& path) noexcept
+{
+  std::ifstream file{ path, std::ios::in | std::ios::binary };
+  if (!file.is_open())
+    return {};
+
+  // streamed so an asset of any size hashes in a fixed amount of memory
+  Sha256 sha;
+  std::array<char, 1 << 16> buffer;
+  while (file) {
+    file.read(buffer.data(), buffer.size());
+    if (file.gcount() > 0)
+      sha.update(buffer.data(), static_cast<size_t>(file.gcount()));
+  }
+  if (file.bad())
+    return {};
+  return sha.finish();
+}
+
+//-----------------------------------------------------------------------------
+String Sha256::toHex(const Digest& digest) noexcept
+{
+  constexpr StringView digits{ "0123456789abcdef" };
+  String result;
+  result.reserve(DigestSize * 2);
+  for (auto value : digest) {
+    result += digits[value >> 4];
+    result += digits[value & 0xf];
+  }
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+std::optional<Sha256::Digest> Sha256::fromHex(StringView text) noexcept
+{
+  if (text.size() != DigestSize * 2)
+    return {};
+
+  auto nibble{ [](char ch) noexcept -> int {
+    if ((ch >= '0') && (ch <= '9'))
+      return ch - '0';
+    if ((ch >= 'a') && (ch <= 'f'))
+      return ch - 'a' + 10;
+    if ((ch >= 'A') && (ch <= 'F'))
+      return ch - 'A' + 10;
+    return -1;
+  } };
+
+  Digest result;
+  for (size_t index{}; index < DigestSize; ++index) {
+    auto high{ nibble(text[index * 2]) };
+    auto low{ nibble(text[index * 2 + 1]) };
+    if ((high < 0) || (low < 0))
+      return {};
+    result[index] = static_cast<std::uint8_t>((high << 4) | low);
+  }
+  return result;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "types.h"
+
+namespace zax
+{
+
+// SHA-256 as specified by FIPS 180-4. Anything that names or validates
+// content beyond the current run uses it since std::hash is only required
+// to be stable within a single execution.
+struct Sha256
+{
+  constexpr static size_t DigestSize{ 32 };
+  constexpr static size_t BlockSize{ 64 };
+
+  using Digest = std::array<std::uint8_t, DigestSize>;
+
+  std::array<std::uint32_t, 8> state_;
+  std::array<std::uint8_t, BlockSize> block_{};
+  size_t used_{};
+  std::uint64_t length_{};
+
+  Sha256() noexcept;
+
+  void update(const void* data, size_t length) noexcept;
+  void update(StringView text) noexcept { update(text.data(), text.size()); }
+  [[nodiscard]] Digest finish() noexcept;
+
+  [[nodiscard]] static Digest hash(const void* data, size_t length) noexcept;
+  [[nodiscard]] static Digest hash(StringView text) noexcept { return hash(text.data(), text.size()); }
+  [[nodiscard]] static std::optional<Digest> hashFile(const Path& path) noexcept;
+
+  [[nodiscard]] static String toHex(const Digest& digest) noexcept;
+  [[nodiscard]] static std::optional<Digest> fromHex(StringView text) noexcept;
+
+protected:
+  void transform(const std::uint8_t* block) noexcept;
+};
+
+} // namespace zax
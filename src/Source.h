@@ -3,6 +3,7 @@
 
 #include "types.h"
 #include "helpers.h"
+#include "ContextPool.h"
 
 namespace zax
 {
@@ -43,7 +44,11 @@ struct Source : public SourceTypes
   FilePathPtr realPath_;
   FilePathPtr effectivePath_;
 
+  std::optional<FileIdentity> identity_;
+  std::optional<FileContentKey> contentKey_;
+
   TokenizerPtr tokenizer_;
+  ParseResultPtr parseResult_;   // recorded while parsed or replayed instead of parsing
 };
 
 } // namespace zax
@@ -0,0 +1,48 @@
+#include "pch.h"
+#include "SourceCache.h"
+
+using namespace zax;
+
+//-----------------------------------------------------------------------------
+bool SourceCache::contains(const String& fullFilePath) noexcept
+{
+  std::scoped_lock lock{ mutex_ };
+  return entries_.contains(fullFilePath);
+}
+
+//-----------------------------------------------------------------------------
+SourceCache::Contents SourceCache::find(const String& fullFilePath) noexcept
+{
+  auto current{ fileStamp(fullFilePath) };
+
+  std::scoped_lock lock{ mutex_ };
+  auto found{ entries_.find(fullFilePath) };
+  if (entries_.end() == found)
+    return {};
+
+  if ((!current) || (*current != found->second.stamp_)) {
+    totalBytes_ -= found->second.contents_.second;
+    entries_.erase(found);
+    return {};
+  }
+  ++hits_;
+  return found->second.contents_;
+}
+
+//-----------------------------------------------------------------------------
+void SourceCache::store(const String& fullFilePath, const FileStamp& stamp, const Contents& contents) noexcept
+{
+  if ((!contents.first) || (stamp.size_ != contents.second))
+    return;
+
+  std::scoped_lock lock{ mutex_ };
+  if (auto found{ entries_.find(fullFilePath) }; entries_.end() != found) {
+    totalBytes_ -= found->second.contents_.second;
+    entries_.erase(found);
+  }
+  if (totalBytes_ + contents.second > MaxBytes)
+    return;
+
+  totalBytes_ += contents.second;
+  entries_.emplace(fullFilePath, Entry{ stamp, contents });
+}
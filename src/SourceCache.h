@@ -0,0 +1,42 @@
+#pragma once
+
+#include "types.h"
+#include "helpers.h"
+
+namespace zax
+{
+
+// Keeps the bytes of every loaded source across parses in a long lived
+// process. An entry is only handed out again while the file on disk still
+// has the size and modification time it had before it was read. The bytes
+// are shared with the tokenizers using them rather than copied.
+struct SourceCache
+{
+  using Contents = std::pair<std::shared_ptr<const std::byte[]>, size_t>;
+
+  constexpr static size_t MaxBytes{ 512 * 1024 * 1024 };
+
+  struct Entry
+  {
+    FileStamp stamp_;
+    Contents contents_;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<String, Entry> entries_;
+  size_t totalBytes_{};
+  size_t hits_{};
+
+  SourceCache() noexcept = default;
+  SourceCache(const SourceCache&) noexcept = delete;
+  SourceCache(SourceCache&&) noexcept = delete;
+
+  SourceCache& operator=(const SourceCache&) noexcept = delete;
+  SourceCache& operator=(SourceCache&&) noexcept = delete;
+
+  [[nodiscard]] bool contains(const String& fullFilePath) noexcept;
+  [[nodiscard]] Contents find(const String& fullFilePath) noexcept;
+  void store(const String& fullFilePath, const FileStamp& stamp, const Contents& contents) noexcept;
+};
+
+} // namespace zax
@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "SourceDependencies.h"
+
+using namespace zax;
+
+//-----------------------------------------------------------------------------
+void SourceDependencies::add(const String& fullFilePath, const String& requestedBy, bool asset) noexcept
+{
+  requestedBy_[fullFilePath].insert(requestedBy);
+  if (asset)
+    assets_.insert(fullFilePath);
+}
+
+//-----------------------------------------------------------------------------
+void SourceDependencies::merge(const SourceDependencies& other) noexcept
+{
+  for (auto& [file, requesters] : other.requestedBy_)
+    requestedBy_[file].insert(requesters.begin(), requesters.end());
+  assets_.insert(other.assets_.begin(), other.assets_.end());
+  probedFiles_.insert(other.probedFiles_.begin(), other.probedFiles_.end());
+  listedDirectories_.insert(other.listedDirectories_.begin(), other.listedDirectories_.end());
+  outputs_.insert(other.outputs_.begin(), other.outputs_.end());
+}
+
+//-----------------------------------------------------------------------------
+void SourceDependencies::replace(const SourceDependencies& fresh, const FileSet& roots) noexcept
+{
+  std::map<String, FileSet> requests;
+  for (auto& [file, requesters] : requestedBy_) {
+    for (auto& requester : requesters)
+      requests[requester].insert(file);
+  }
+
+  // everything the roots pulled in last time is forgotten unless another
+  // source requested it too
+  FileSet reached;
+  std::vector<String> pending{ roots.begin(), roots.end() };
+  while (!pending.empty()) {
+    auto file{ std::move(pending.back()) };
+    pending.pop_back();
+    if (!reached.insert(file).second)
+      continue;
+    if (auto found{ requests.find(file) }; requests.end() != found)
+      pending.insert(pending.end(), found->second.begin(), found->second.end());
+  }
+
+  for (auto iter{ requestedBy_.begin() }; requestedBy_.end() != iter; ) {
+    auto& requesters{ iter->second };
+    std::erase_if(requesters, [&](const String& requester) noexcept { return reached.contains(requester); });
+    if (roots.contains(iter->first))
+      requesters.erase(String{});
+
+    if (!requesters.empty()) {
+      ++iter;
+      continue;
+    }
+    assets_.erase(iter->first);
+    iter = requestedBy_.erase(iter);
+  }
+
+  merge(fresh);
+}
+
+//-----------------------------------------------------------------------------
+SourceDependencies::FileSet SourceDependencies::files() const noexcept
+{
+  FileSet result;
+  for (auto& [file, requesters] : requestedBy_)
+    result.insert(file);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+SourceDependencies::FileSet SourceDependencies::roots() const noexcept
+{
+  FileSet result;
+  for (auto& [file, requesters] : requestedBy_) {
+    if (requesters.contains(String{}))
+      result.insert(file);
+  }
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+SourceDependencies::FileSet SourceDependencies::affected(const FileSet& changed) const noexcept
+{
+  FileSet result;
+  FileSet visited;
+  std::vector<String> pending{ changed.begin(), changed.end() };
+  while (!pending.empty()) {
+    auto file{ std::move(pending.back()) };
+    pending.pop_back();
+    if (!visited.insert(file).second)
+      continue;
+
+    auto found{ requestedBy_.find(file) };
+    if (requestedBy_.end() == found)
+      continue;
+
+    for (auto& requester : found->second) {
+      if (requester.empty())
+        result.insert(file);
+      else
+        pending.push_back(requester);
+    }
+  }
+  return result;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "types.h"
+
+namespace zax
+{
+
+// Remembers which file requested every source and asset a parse loaded so
+// a changed file can be traced back to the command line sources that have
+// to be parsed again. Command line sources are requested by the empty path.
+// The files probed while resolving requests (found or not), the directories
+// listed to match wild cards and the files written are kept alongside so a
+// build tool can be told everything a run depended on.
+struct SourceDependencies
+{
+  using FileSet = std::set<String>;
+
+  std::map<String, FileSet> requestedBy_;
+  FileSet assets_;
+  FileSet probedFiles_;
+  FileSet listedDirectories_;
+  FileSet outputs_;
+
+  void add(const String& fullFilePath, const String& requestedBy, bool asset = false) noexcept;
+  void merge(const SourceDependencies& other) noexcept;
+  void replace(const SourceDependencies& fresh, const FileSet& roots) noexcept;
+
+  [[nodiscard]] bool empty() const noexcept { return requestedBy_.empty(); }
+  [[nodiscard]] FileSet files() const noexcept;
+  [[nodiscard]] FileSet roots() const noexcept;
+  [[nodiscard]] FileSet affected(const FileSet& changed) const noexcept;
+};
+
+} // namespace zax
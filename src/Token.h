@@ -425,7 +425,7 @@ struct Token : public TokenTypes
   CompileStateConstPtr compileState_;
   TokenPtr comment_;
 
-  mutable bool aliasSearched_{};
+  mutable uint32_t aliasGeneration_{};    // parser alias generation alias_ was resolved at (0 = never)
   mutable TokenConstPtr alias_;
 
   std::optional<Operator> lookupOperator() const noexcept;
@@ -31,7 +31,7 @@ bool TokenizerTypes::ParserPos::sameLocation(const ParserPos& rhs) const noexcep
 //-----------------------------------------------------------------------------
 Tokenizer::Tokenizer(
   const SourceTypes::FilePathPtr& filePath,
-  std::pair< std::unique_ptr<std::byte[]>, size_t>&& rawContents,
+  std::pair<std::shared_ptr<const std::byte[]>, size_t>&& rawContents,
   const OperatorLutConstPtr& operatorLut,
   decltype(getState_) && getState
 ) noexcept :
@@ -50,10 +50,10 @@ Tokenizer::Tokenizer(
   static_assert(sizeof(std::byte) == sizeof(char));
   parserPos_.pos_ = StringView{ reinterpret_cast<const char *>(raw_), rawContents_.second };
 
-  errorCallback_ = [](ErrorTypes::Error error, const TokenConstPtr& token, const StringMap& mapping) noexcept {
+  errorCallback_ = [](ErrorTypes::Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept {
     output(error, token, mapping);
   };
-  warningCallback_ = [](WarningTypes::Warning warning, const TokenConstPtr& token, const StringMap& mapping) noexcept {
+  warningCallback_ = [](WarningTypes::Warning warning, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept {
     output(warning, token, mapping);
   };
 }
@@ -1067,6 +1067,12 @@ bool Tokenizer::empty() const noexcept
   return parsedTokens_.empty();
 }
 
+//-----------------------------------------------------------------------------
+StringView Tokenizer::atom(String&& value) noexcept
+{
+  return *(atoms_.insert(std::move(value)).first);
+}
+
 //-----------------------------------------------------------------------------
 void Tokenizer::clear() noexcept
 {
@@ -1213,13 +1219,13 @@ void Tokenizer::ensurePosExists(index_type pos) const noexcept
 }
 
 //-----------------------------------------------------------------------------
-void Tokenizer::out(ErrorTypes::Error error, const TokenConstPtr& token, const StringMap& mapping) noexcept
+void Tokenizer::out(ErrorTypes::Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept
 {
   errorCallback_(error, token, mapping);
 }
 
 //-----------------------------------------------------------------------------
-void Tokenizer::out(WarningTypes::Warning warning, const TokenConstPtr& token, const StringMap& mapping) noexcept
+void Tokenizer::out(WarningTypes::Warning warning, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept
 {
   warningCallback_(warning, token, mapping);
 }
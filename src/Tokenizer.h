@@ -8,6 +8,7 @@
 #include "Source.h"
 #include "Errors.h"
 #include "Warnings.h"
+#include "DiagnosticArguments.h"
 
 namespace zax {
 
@@ -88,7 +89,7 @@ public:
 
   SourceTypes::FilePathPtr filePath_;
   SourceTypes::FilePathPtr actualFilePath_;
-  std::pair< std::unique_ptr<std::byte[]>, size_t> rawContents_;
+  std::pair<std::shared_ptr<const std::byte[]>, size_t> rawContents_;
   const std::byte* raw_{};
   OperatorLutConstPtr operatorLut_;
 
@@ -96,15 +97,17 @@ public:
   bool skipComments_{};
   TokenPtr pendingComment_;
 
+  StringSet atoms_;
+
   std::function<CompileStateConstPtr()> getState_;
-  std::function<void(ErrorTypes::Error, const TokenConstPtr&, const StringMap&)> errorCallback_;
-  std::function<void(WarningTypes::Warning, const TokenConstPtr&, const StringMap&)> warningCallback_;
+  std::function<void(ErrorTypes::Error, const TokenConstPtr&, const DiagnosticArguments&)> errorCallback_;
+  std::function<void(WarningTypes::Warning, const TokenConstPtr&, const DiagnosticArguments&)> warningCallback_;
 
 public:
 
   Tokenizer(
     const SourceTypes::FilePathPtr &filePath,
-    std::pair< std::unique_ptr<std::byte[]>, size_t>&& rawContents,
+    std::pair<std::shared_ptr<const std::byte[]>, size_t>&& rawContents,
     const OperatorLutConstPtr& operatorLut,
     decltype(getState_)&& getState
   ) noexcept;
@@ -459,6 +462,10 @@ public:
   [[nodiscard]] bool empty() const noexcept;
   [[nodiscard]] size_type size() const noexcept;  // size is a lazy projection and does not represent "true" size
 
+  // atoms are spellings which do not exist contiguously in the raw buffer
+  // but still need a view which lives as long as the tokenizer
+  [[nodiscard]] StringView atom(String&& value) noexcept;
+
   void clear() noexcept;
 
   [[nodiscard]] bool hasAhead(iterator pos, index_type count) noexcept { assert(&(pos.list()) == this); return pos.hasAhead(count); }
@@ -489,11 +496,10 @@ private:
   void ensurePosExists(index_type pos) noexcept;
   void ensurePosExists(index_type pos) const noexcept;
 
-  void out(ErrorTypes::Error error, const TokenConstPtr& token, const StringMap& mapping = {}) noexcept;
-  void out(WarningTypes::Warning warning, const TokenConstPtr& token, const StringMap& mapping = {}) noexcept;
+  void out(ErrorTypes::Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping = {}) noexcept;
+  void out(WarningTypes::Warning warning, const TokenConstPtr& token, const DiagnosticArguments& mapping = {}) noexcept;
 };
 
-
 inline bool hasAhead(Tokenizer::iterator pos, index_type count) noexcept { return pos.hasAhead(count); }
 inline bool hasBehind(Tokenizer::iterator pos, index_type count) noexcept { return pos.hasBehind(count); }
 
@@ -1,12 +1,62 @@
 
 #include "pch.h"
 #include "helpers.h"
+#include "FileSystemCache.h"
 
 #include <fstream>
 #include <filesystem>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else //_WIN32
+#include <sys/stat.h>
+#endif //_WIN32
+
 using namespace zax;
 
+namespace
+{
+
+//-----------------------------------------------------------------------------
+Path absolutePath(FileSystemCache* cache, const Path& path, std::error_code& ec) noexcept
+{
+  return cache ? cache->absolute(path, ec) : std::filesystem::absolute(path, ec);
+}
+
+//-----------------------------------------------------------------------------
+Path proximatePath(FileSystemCache* cache, const Path& path, const Path& base, std::error_code& ec) noexcept
+{
+  return cache ? cache->proximate(path, base, ec) : std::filesystem::proximate(path, base, ec);
+}
+
+//-----------------------------------------------------------------------------
+Path currentPath(FileSystemCache* cache, std::error_code& ec) noexcept
+{
+  return cache ? cache->currentPath(ec) : std::filesystem::current_path(ec);
+}
+
+//-----------------------------------------------------------------------------
+bool isRegularFile(FileSystemCache* cache, const Path& path, std::error_code& ec) noexcept
+{
+  return cache ? cache->isRegularFile(path, ec) : std::filesystem::is_regular_file(path, ec);
+}
+
+//-----------------------------------------------------------------------------
+std::vector<Path> directoryEntries(FileSystemCache* cache, const Path& path, std::error_code& ec) noexcept
+{
+  if (cache)
+    return cache->directory(path, ec);
+
+  std::vector<Path> entries;
+  for (auto& entry : std::filesystem::directory_iterator(path, ec))
+    entries.push_back(entry.path());
+  return entries;
+}
+
+} // namespace
+
 //-----------------------------------------------------------------------------
 Puid zax::puid() noexcept {
   static std::atomic<Puid> singleton{ 1 };
@@ -47,6 +97,59 @@ std::pair<std::unique_ptr<std::byte[]>, size_t> zax::readBinaryFile(const String
   return { std::move(dest), SafeInt<size_t>(size) };
 }
 
+//-----------------------------------------------------------------------------
+std::optional<FileIdentity> zax::fileIdentity(const StringView fileName) noexcept
+{
+#ifdef _WIN32
+  auto handle{ CreateFileW(
+    Path{ fileName }.c_str(),
+    0,
+    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+    nullptr,
+    OPEN_EXISTING,
+    FILE_FLAG_BACKUP_SEMANTICS,
+    nullptr) };
+  if (INVALID_HANDLE_VALUE == handle)
+    return {};
+
+  BY_HANDLE_FILE_INFORMATION info{};
+  auto success{ GetFileInformationByHandle(handle, &info) };
+  CloseHandle(handle);
+  if (!success)
+    return {};
+
+  return FileIdentity{ info.dwVolumeSerialNumber, (static_cast<std::uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow };
+#else //_WIN32
+  struct stat info {};
+  if (0 != ::stat(String{ fileName }.c_str(), &info))
+    return {};
+  return FileIdentity{ static_cast<std::uint64_t>(info.st_dev), static_cast<std::uint64_t>(info.st_ino) };
+#endif //_WIN32
+}
+
+//-----------------------------------------------------------------------------
+std::optional<FileStamp> zax::fileStamp(const StringView fileName) noexcept
+{
+  std::error_code ec;
+  Path path{ fileName };
+  FileStamp result;
+  result.size_ = std::filesystem::file_size(path, ec);
+  if (ec)
+    return {};
+  auto time{ std::filesystem::last_write_time(path, ec) };
+  if (ec)
+    return {};
+  result.modified_ = static_cast<std::int64_t>(time.time_since_epoch().count());
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+FileContentKey zax::fileContentKey(const std::shared_ptr<const std::byte[]>& contents, size_t length) noexcept
+{
+  static_assert(sizeof(std::byte) == sizeof(char));
+  return FileContentKey{ std::hash<StringView>{}(StringView{ reinterpret_cast<const char*>(contents.get()), length }), length, contents };
+}
+
 //-----------------------------------------------------------------------------
 bool zax::writeBinaryFile(
   const StringView fileName,
@@ -81,7 +184,8 @@ abandon:
 String zax::makeIncludeFile(
   const StringView inCurrentFile,
   const StringView inNewFile,
-  String& outFullFilePath) noexcept
+  String& outFullFilePath,
+  FileSystemCache* cache) noexcept
 {
   String currentFile{ inCurrentFile };
   String newFile{ inNewFile };
@@ -96,31 +200,31 @@ String zax::makeIncludeFile(
 
   Path newFilePath{ newFile };
   if (newFilePath.has_root_path()) {
-    outFullFilePath = std::filesystem::absolute(newFilePath, ec).string();
+    outFullFilePath = absolutePath(cache, newFilePath, ec).string();
     if (ec)
       return outFullFilePath;
   }
 
-  auto absFilePath = std::filesystem::absolute(currentFile, ec);
+  auto absFilePath = absolutePath(cache, currentFile, ec);
   if (ec)
     return outFullFilePath;
   absFilePath.remove_filename();
 
   auto newPath = absFilePath / newFilePath;
-  auto fullPath{ std::filesystem::absolute(newPath, ec) };
+  auto fullPath{ absolutePath(cache, newPath, ec) };
   if (ec)
     return outFullFilePath;
 
 
-  auto relPath = std::filesystem::proximate(fullPath, absFilePath, ec);
+  auto relPath = proximatePath(cache, fullPath, absFilePath, ec);
   if (ec)
     return outFullFilePath;
 
-  auto currentPath = std::filesystem::current_path(ec);
+  auto workingPath = currentPath(cache, ec);
   if (ec)
     return outFullFilePath;
 
-  auto newRelPath = std::filesystem::proximate(newPath, currentPath, ec);
+  auto newRelPath = proximatePath(cache, newPath, workingPath, ec);
   if (ec)
     return outFullFilePath;
 
@@ -144,14 +248,15 @@ String zax::locateFile(
   const StringView currentFile,
   const StringView newFile,
   String& outFullFilePath,
-  bool useAbsolutePath) noexcept
+  bool useAbsolutePath,
+  FileSystemCache* cache) noexcept
 {
   outFullFilePath = {};
   std::error_code ec{};
   Path currentFilePath{ currentFile };
   Path parentCurrentFile{ currentFilePath.parent_path() };
   if (useAbsolutePath) {
-    parentCurrentFile = std::filesystem::absolute(parentCurrentFile, ec);
+    parentCurrentFile = absolutePath(cache, parentCurrentFile, ec);
     if (ec)
       return outFullFilePath;
   }
@@ -159,14 +264,14 @@ String zax::locateFile(
   while (true) {
     String fullPath;
     auto usePath{ parentCurrentFile / currentFilePath.filename() };
-    auto result{ makeIncludeFile(usePath.string(), newFile, fullPath) };
-    if (std::filesystem::is_regular_file(Path{ result }, ec)) {
+    auto result{ makeIncludeFile(usePath.string(), newFile, fullPath, cache) };
+    if (isRegularFile(cache, Path{ result }, ec)) {
       outFullFilePath = fullPath;
       return result;
     }
     if (!parentCurrentFile.has_relative_path()) {
       if (!useAbsolutePath)
-        return locateFile(currentFile, newFile, outFullFilePath, true);
+        return locateFile(currentFile, newFile, outFullFilePath, true, cache);
       break;
     }
 
@@ -175,26 +280,90 @@ String zax::locateFile(
   return {};
 }
 
+//-----------------------------------------------------------------------------
+GlobPattern::GlobPattern(const StringView pattern) noexcept
+{
+  elements_.reserve(pattern.size());
+  for (auto ch : pattern) {
+    switch (ch) {
+      case '?':   elements_.push_back(Element{ Kind::Any });  break;
+      case '*':   elements_.push_back(Element{ Kind::Star }); break;
+      default:    elements_.push_back(Element{ Kind::Literal, ch }); break;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool GlobPattern::match(const StringView value, StringList* outCaptures) const noexcept
+{
+  auto patternSize{ elements_.size() };
+  auto valueSize{ value.size() };
+  auto width{ valueSize + 1 };
+
+  // matches[i * width + j] is set when the pattern from element i onwards
+  // matches the value from character j onwards; filled back to front so every
+  // cell is visited once
+  std::vector<bool> matches((patternSize + 1) * width);
+  matches[patternSize * width + valueSize] = true;
+
+  for (auto i{ patternSize }; i-- > 0;) {
+    auto& element{ elements_[i] };
+    for (auto j{ valueSize + 1 }; j-- > 0;) {
+      bool result{};
+      switch (element.kind_) {
+        case Kind::Literal: result = (j < valueSize) && (element.literal_ == value[j]) && matches[(i + 1) * width + j + 1]; break;
+        case Kind::Any:     result = (j < valueSize) && matches[(i + 1) * width + j + 1]; break;
+        case Kind::Star:    result = matches[(i + 1) * width + j] || ((j < valueSize) && matches[i * width + j + 1]); break;
+      }
+      matches[i * width + j] = result;
+    }
+  }
+
+  if (!matches[0])
+    return false;
+  if (!outCaptures)
+    return true;
+
+  // walk forward taking the shortest capture for each star that still leaves
+  // a match for the remainder of the pattern
+  size_t j{};
+  for (size_t i{}; i < patternSize; ++i) {
+    switch (elements_[i].kind_) {
+      case Kind::Literal: ++j; break;
+      case Kind::Any:     outCaptures->emplace_back(value.substr(j, 1)); ++j; break;
+      case Kind::Star: {
+        size_t length{};
+        while (!matches[(i + 1) * width + j + length])
+          ++length;
+        outCaptures->emplace_back(value.substr(j, length));
+        j += length;
+        break;
+      }
+    }
+  }
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 void zax::locateWildCardFiles(
   std::list<LocateWildCardFilesResult>& outFoundFilePaths,
   const StringView currentFile,
   const StringView newFileWithWildCards,
-  bool useAbsolutePath) noexcept
+  bool useAbsolutePath,
+  FileSystemCache* cache) noexcept
 {
   using PathList = std::list<Path>;
   using ResultList = std::list<LocateWildCardFilesResult>;
 
-  struct HasWild {
-    static bool hasWild(const StringView str) noexcept {
-      return (!((StringView::npos == str.find("*")) &&
-                (StringView::npos == str.find("?"))));
-    }
+  struct Component {
+    Path path_;
+    std::optional<GlobPattern> glob_;
   };
+  using ComponentList = std::vector<Component>;
 
-  if (!HasWild::hasWild(newFileWithWildCards)) {
+  if (!GlobPattern::hasWild(newFileWithWildCards)) {
     String outFullFilePath;
-    String result{ locateFile(currentFile, newFileWithWildCards, outFullFilePath) };
+    String result{ locateFile(currentFile, newFileWithWildCards, outFullFilePath, false, cache) };
     if (!result.empty())
       outFoundFilePaths.emplace_back(result, outFullFilePath, StringList{});
     return;
@@ -204,7 +373,7 @@ void zax::locateWildCardFiles(
   Path currentFilePath{ currentFile };
   Path parentCurrentFile{ currentFilePath.parent_path() };
   if (useAbsolutePath) {
-    parentCurrentFile = std::filesystem::absolute(parentCurrentFile, ec);
+    parentCurrentFile = absolutePath(cache, parentCurrentFile, ec);
     if (ec)
       return;
   }
@@ -212,145 +381,74 @@ void zax::locateWildCardFiles(
   while (true) {
     String fullPath;
     auto usePath{ parentCurrentFile / currentFilePath.filename() };
-    auto result{ makeIncludeFile(usePath.string(), newFileWithWildCards, fullPath) };
+    auto result{ makeIncludeFile(usePath.string(), newFileWithWildCards, fullPath, cache) };
 
     // break out all wild cards into components
     Path basePath{ result };
     PathList exploreComponents;
     while (true) {
       Path parent{ basePath.parent_path() };
-      Path relative{ std::filesystem::proximate(basePath, parent, ec) };
+      Path relative{ proximatePath(cache, basePath, parent, ec) };
       exploreComponents.push_front(relative);
       basePath = parent;
-      if (!HasWild::hasWild(basePath.string()))
+      if (!GlobPattern::hasWild(basePath.string()))
         break;
     }
 
+    // compile each wild component once for every directory it is matched in
+    ComponentList components;
+    for (auto& component : exploreComponents) {
+      auto componentStr{ component.string() };
+      if (GlobPattern::hasWild(componentStr))
+        components.push_back(Component{ component, GlobPattern{ componentStr } });
+      else
+        components.push_back(Component{ component, {} });
+    }
+
     struct WildMatcher {
       static void wildMatch(
+        FileSystemCache* cache,
         ResultList& outFoundFiles,
-        Path basePath,
-        PathList exploreComponents,
+        const Path& basePath,
+        const ComponentList& components,
+        size_t index,
         const StringList& foundMatches) noexcept {
         std::error_code ec{};
 
-        if (exploreComponents.empty()) {
-          if (std::filesystem::is_regular_file(basePath, ec))
+        if (index >= components.size()) {
+          if (isRegularFile(cache, basePath, ec))
             outFoundFiles.emplace_back(basePath.string(), String{}, foundMatches);
           return;
         }
 
-        Path matchEntry{ exploreComponents.front() };
-        exploreComponents.pop_front();
+        auto& component{ components[index] };
+        if (!component.glob_)
+          return wildMatch(cache, outFoundFiles, basePath / component.path_, components, index + 1, foundMatches);
 
-        if (!HasWild::hasWild(matchEntry.string())) {
-          basePath /= matchEntry;
-          return wildMatch(outFoundFiles, basePath, exploreComponents, foundMatches);
-        }
-
-        // wild card matching is required
-
-        PathList entries;
-        for (auto& p : std::filesystem::directory_iterator(basePath, ec)) {
-          auto foundPath{ p.path() };
-          auto usePath{ std::filesystem::proximate(foundPath, basePath, ec) };
-          if (usePath.empty())
+        // wild card matching is required, the directory is listed once and
+        // every entry is matched against the compiled pattern
+        for (auto& foundPath : directoryEntries(cache, basePath, ec)) {
+          auto entry{ proximatePath(cache, foundPath, basePath, ec) };
+          if (entry.empty())
             continue;
-          entries.push_back(usePath);
-        }
 
-        struct HumbleMatcher {
-          static bool humbleMatch(
-            ResultList& outFoundFiles,
-            const PathList& exploreComponents,
-            StringList foundMatches,
-            const Path& basePath,
-            const Path& matchEntry,
-            const Path& entry,
-            std::remove_const_t<decltype(String::npos)> greediness) {
-
-            String wildStr{ matchEntry.string() };
-            auto posQuestion{ wildStr.find("?") };
-            auto posStar{ wildStr.find("*") };
-            auto posFirst{ String::npos == posQuestion ? posStar : ( String::npos == posStar ? posQuestion : std::min(posStar, posQuestion) ) };
-            if (String::npos == posFirst) {
-              if (0 != matchEntry.compare(entry))
-                return false;
-              // no more wild card, direct match check
-              auto useBasePath{ basePath / entry };
-              wildMatch(outFoundFiles, useBasePath, exploreComponents, foundMatches);
-              return true;
-            }
-
-            String entryStr{ entry.string() };
-
-            StringView wp{ wildStr };
-            StringView es{ entryStr };
-
-            StringView prefixWp{ wp.substr(0, posFirst) };
-            if (es.length() < prefixWp.length())
-              return false;
-
-            // prefixes must match or not a match
-            if (prefixWp.size() > 0) {
-              if (0 != Path{ prefixWp }.compare(Path{ es.substr(0, prefixWp.length()) }))
-                return false;
-            }
-
-            auto rehumble{ [&](decltype(String::npos) useGreed, bool increaseGreed) noexcept -> bool {
-              // impossible match?
-              if (es.length() < posFirst + useGreed)
-                return false;
-              if (wp.length() < posFirst + 1)
-                return false;
-
-              StringView borrowStr{ useGreed > 0 ? es.substr(posFirst, useGreed) : StringView{} };
-              StringView postfixWp{ wp.substr(posFirst + 1) }; // account for the extracted wild character
-              StringView postfixEs{ es.substr(posFirst + useGreed) }; // account for the borrowed string
-
-              foundMatches.emplace_back(borrowStr);
-
-              String useMatchStr;
-              useMatchStr.reserve(prefixWp.size() + borrowStr.size() + postfixWp.size());
-              String useEsStr;
-              useEsStr.reserve(prefixWp.size() + borrowStr.size() + postfixEs.size());
-
-              useMatchStr += prefixWp;
-              useMatchStr += borrowStr;
-              useMatchStr += postfixWp;
-
-              useEsStr += prefixWp;
-              useEsStr += borrowStr;
-              useEsStr += postfixEs;
-              if (humbleMatch(outFoundFiles, exploreComponents, foundMatches, basePath, Path{ useMatchStr }, Path{ useEsStr }, 0))
-                return true;
-              if (!increaseGreed)
-                return false;
-              foundMatches.pop_back();
-              return humbleMatch(outFoundFiles, exploreComponents, foundMatches, basePath, matchEntry, entry, useGreed + 1);
-            } };
-
-            if (posFirst == posQuestion)
-              return rehumble(1, false);
-            return rehumble(greediness, true);
-          }
-        };
-
-        for (auto& checkEntry : entries) {
-          HumbleMatcher::humbleMatch(outFoundFiles, exploreComponents, foundMatches, basePath, matchEntry, checkEntry , 0);
+          StringList matches{ foundMatches };
+          if (!component.glob_->match(entry.string(), &matches))
+            continue;
+          wildMatch(cache, outFoundFiles, basePath / entry, components, index + 1, matches);
         }
       }
     };
 
     ResultList foundResults;
-    WildMatcher::wildMatch(foundResults, basePath, exploreComponents, StringList{});
+    WildMatcher::wildMatch(cache, foundResults, basePath, components, 0, StringList{});
 
     if (foundResults.size() > 0) {
       for (auto& pathResult : foundResults) {
         Path path{ pathResult.path_ };
 
-        assert(std::filesystem::is_regular_file(path, ec));
-        auto absPath = std::filesystem::absolute(path, ec);
+        assert(isRegularFile(cache, path, ec));
+        auto absPath = absolutePath(cache, path, ec);
 
         outFoundFilePaths.emplace_back(pathResult.path_, absPath.string(), pathResult.foundMatches_);
       }
@@ -359,7 +457,7 @@ void zax::locateWildCardFiles(
 
     if (!parentCurrentFile.has_relative_path()) {
       if (!useAbsolutePath) {
-        locateWildCardFiles(outFoundFilePaths, currentFile, newFileWithWildCards, true);
+        locateWildCardFiles(outFoundFilePaths, currentFile, newFileWithWildCards, true, cache);
         return;
       }
       break;
@@ -11,6 +11,54 @@ StringView makeStringView(const char* start, const char* end) noexcept;
 
 std::pair< std::unique_ptr<std::byte[]>, size_t> readBinaryFile(const StringView fileName) noexcept;
 
+// identifies a file independent of how its path is spelled, i.e. the
+// (st_dev, st_ino) pair or the volume serial and file index on Windows
+struct FileIdentity
+{
+  std::uint64_t device_{};
+  std::uint64_t index_{};
+
+  bool operator==(const FileIdentity& rhs) const noexcept = default;
+
+  struct Hash { size_t operator()(const FileIdentity& value) const noexcept { return std::hash<std::uint64_t>{}(value.index_ ^ (value.device_ * 0x9E3779B97F4A7C15ull)); } };
+};
+
+std::optional<FileIdentity> fileIdentity(const StringView fileName) noexcept;
+
+// the size and modification time of a file, taken before its bytes are read
+// so an edit racing the read can never be mistaken for the bytes it replaced
+struct FileStamp
+{
+  std::uintmax_t size_{};
+  std::int64_t modified_{};
+
+  bool operator==(const FileStamp& rhs) const noexcept = default;
+};
+
+std::optional<FileStamp> fileStamp(const StringView fileName) noexcept;
+
+// a matching hash is not proof of matching content so equal keys also
+// compare the bytes they keep a share of
+struct FileContentKey
+{
+  size_t hash_{};
+  size_t size_{};
+  std::shared_ptr<const std::byte[]> contents_;
+
+  bool operator==(const FileContentKey& rhs) const noexcept
+  {
+    if ((hash_ != rhs.hash_) || (size_ != rhs.size_))
+      return false;
+    if (contents_ == rhs.contents_)
+      return true;
+    return (contents_) && (rhs.contents_) && (0 == std::memcmp(contents_.get(), rhs.contents_.get(), size_));
+  }
+
+  struct Hash { size_t operator()(const FileContentKey& value) const noexcept { return value.hash_ ^ value.size_; } };
+};
+
+FileContentKey fileContentKey(const std::shared_ptr<const std::byte[]>& contents, size_t length) noexcept;
+
 bool writeBinaryFile(
   const StringView fileName,
   const std::byte* source,
@@ -40,7 +88,8 @@ inline bool writeBinaryFile(
 String makeIncludeFile(
   const StringView currentFile,
   const StringView newFile,
-  String& outFullFilePath) noexcept;
+  String& outFullFilePath,
+  FileSystemCache* cache = nullptr) noexcept;
 
 String fileAndPathFromFilePath(
   const StringView filePath,
@@ -50,7 +99,8 @@ String locateFile(
   const StringView currentFile,
   const StringView newFile,
   String& outFullFilePath,
-  bool useAbsolutePath = false) noexcept;
+  bool useAbsolutePath = false,
+  FileSystemCache* cache = nullptr) noexcept;
 
 struct LocateWildCardFilesResult
 {
@@ -75,11 +125,40 @@ struct LocateWildCardFilesResult
   LocateWildCardFilesResult& operator=(LocateWildCardFilesResult&&) noexcept = default;
 };
 
+// A wild card pattern for a single path component, compiled once and matched
+// in O(pattern * value) time without backtracking. '?' matches exactly one
+// character and '*' any run of characters. Every wild card captures the text
+// it matched; when several captures are possible the earliest wild cards take
+// the shortest text.
+struct GlobPattern
+{
+  enum class Kind
+  {
+    Literal,
+    Any,
+    Star
+  };
+
+  struct Element
+  {
+    Kind kind_{};
+    char literal_{};
+  };
+
+  std::vector<Element> elements_;
+
+  GlobPattern(const StringView pattern) noexcept;
+
+  [[nodiscard]] static bool hasWild(const StringView value) noexcept { return StringView::npos != value.find_first_of("*?"); }
+  [[nodiscard]] bool match(const StringView value, StringList* outCaptures = nullptr) const noexcept;
+};
+
 void locateWildCardFiles(
   std::list<LocateWildCardFilesResult>& outFoundFilePaths,
   const StringView currentFile,
   const StringView newFileWithWildCards,
-  bool useAbsolutePath = false) noexcept;
+  bool useAbsolutePath = false,
+  FileSystemCache* cache = nullptr) noexcept;
 
 std::map<size_t, StringView> stringSplitView(
   const StringView input,
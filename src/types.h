@@ -31,42 +31,32 @@ using optional = std::optional<T>;
 
 using index_type = zs::index_type;
 
-struct Alive
-{
-#ifdef _DEBUG
-  constexpr static uint32_t AliveValue{ 0xABCDB0DB };
-  constexpr static uint32_t DeadValue{ 0xDEADBEEF };
-  uint32_t value_{ AliveValue };
-
-  ~Alive() noexcept { value_ = DeadValue; }
-
-  void check() const noexcept { assert(AliveValue == value_); }
-#else
-  void check() const noexcept {}
-#endif //_DEBUG
-  void operator()() const noexcept { check(); }
-};
-
 ZAX_DECLARE_STRUCT_PTR(Alias);
 ZAX_DECLARE_STRUCT_PTR(AliasTypes);
+ZAX_DECLARE_STRUCT_PTR(CancellationToken);
 ZAX_DECLARE_STRUCT_PTR(CodeBlock);
 ZAX_DECLARE_STRUCT_PTR(Parser);
 ZAX_DECLARE_STRUCT_PTR(ParserTypes);
+ZAX_DECLARE_STRUCT_PTR(PrefetchedFile);
 ZAX_DECLARE_STRUCT_PTR(CompileState);
 ZAX_DECLARE_STRUCT_PTR(CompilerException);
 ZAX_DECLARE_STRUCT_PTR(Config);
-ZAX_DECLARE_STRUCT_PTR(Context);
+struct Context;   // pooled, see ContextPool.h for ContextPtr
 ZAX_DECLARE_STRUCT_PTR(ContextTypes);
 ZAX_DECLARE_STRUCT_PTR(EntryCommon);
 ZAX_DECLARE_STRUCT_PTR(EntryCommonTypes);
 ZAX_DECLARE_STRUCT_PTR(ErrorTypes);
+ZAX_DECLARE_STRUCT_PTR(FilePrefetcher);
+ZAX_DECLARE_STRUCT_PTR(FileSystemCache);
 ZAX_DECLARE_STRUCT_PTR(FunctionType);
 ZAX_DECLARE_STRUCT_PTR(FunctionTypeTypes);
 ZAX_DECLARE_STRUCT_PTR(Module);
 ZAX_DECLARE_STRUCT_PTR(OperatorLutTypes);
 ZAX_DECLARE_STRUCT_PTR(OperatorLut);
+ZAX_DECLARE_STRUCT_PTR(ParseResult);
 ZAX_DECLARE_STRUCT_PTR(SourceTypes);
 ZAX_DECLARE_STRUCT_PTR(Source);
+ZAX_DECLARE_STRUCT_PTR(SourceCache);
 ZAX_DECLARE_STRUCT_PTR(TemplateArguments);
 ZAX_DECLARE_STRUCT_PTR(TemplateArgumentsTypes);
 ZAX_DECLARE_STRUCT_PTR(TokenTypes);
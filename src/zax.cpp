@@ -2,8 +2,19 @@
 #include "pch.h"
 #include "types.h"
 #include "version.h"
+#include "BuildStamp.h"
+#include "CancellationToken.h"
 #include "Config.h"
 #include "CompilerException.h"
+#include "CompileServer.h"
+#include "DiagnosticSink.h"
+#include "DiagnosticWriter.h"
+#include "FileWatcher.h"
+#include "helpers.h"
+#include "MetadataWriter.h"
+#include "ModuleInterface.h"
+#include "SourceCache.h"
+#include "SourceDependencies.h"
 #include "zax.h"
 
 using namespace zax;
@@ -20,10 +31,10 @@ namespace
 struct Singleton
 {
   bool quiet_{};
-  int errorNumber_{};
-  int totalFatals_{};
-  int totalErrors_{};
-  int totalWarnings_{};
+  std::atomic<int> errorNumber_{};
+  std::atomic<int> totalFatals_{};
+  std::atomic<int> totalErrors_{};
+  std::atomic<int> totalWarnings_{};
 
   constexpr static inline int DefaultMaxErrors{ 20 };
   constexpr static inline std::optional<int> DefaultMaxWarnings{};
@@ -31,13 +42,63 @@ struct Singleton
   int maxErrors_{ DefaultMaxErrors };
   std::optional<int> maxWarnings_{ DefaultMaxWarnings };
 
+  DiagnosticSink sink_{ std::cout };
+  std::unique_ptr<DiagnosticWriter> writer_;
+  CancellationTokenPtr cancellation_{ std::make_shared<CancellationToken>() };
+
+  ~Singleton() noexcept { finish(); }
+
+  void reset() noexcept
+  {
+    quiet_ = false;
+    errorNumber_ = 0;
+    totalFatals_ = 0;
+    totalErrors_ = 0;
+    totalWarnings_ = 0;
+    maxErrors_ = DefaultMaxErrors;
+    maxWarnings_ = DefaultMaxWarnings;
+    writer_.reset();
+    cancellation_->reset();
+  }
+
+  void restart() noexcept
+  {
+    errorNumber_ = 0;
+    totalFatals_ = 0;
+    totalErrors_ = 0;
+    totalWarnings_ = 0;
+    cancellation_->reset();
+  }
+
+  void finish() noexcept
+  {
+    if (writer_)
+      sink_.write(writer_->footer());
+    writer_.reset();
+    sink_.flush();
+  }
+
+  void structured(Config::DiagnosticsFormat format) noexcept
+  {
+    if (Config::DiagnosticsFormat::Text == format)
+      return;
+    writer_ = std::make_unique<DiagnosticWriter>(format);
+    sink_.write(writer_->header());
+  }
+
   void write(const StringStream& ss, bool forceOutput = {}) noexcept
   {
-    if ((!quiet_) || (forceOutput))
-      std::cout << ss.str();
+    // machine readable output is not interleaved with chatter
+    if (((!quiet_) && (!writer_)) || (forceOutput))
+      sink_.write(ss.str());
+  }
+  void write(String&& text) noexcept
+  {
+    if (!quiet_)
+      sink_.write(std::move(text));
   }
   int error() noexcept { return errorNumber_; }
-  void error(int errorNumber) noexcept { if (0 == errorNumber_) errorNumber_ = errorNumber; }
+  void error(int errorNumber) noexcept { int expected{}; errorNumber_.compare_exchange_strong(expected, errorNumber); }
 };
 
 //-----------------------------------------------------------------------------
@@ -80,8 +141,32 @@ void showHelp() noexcept
   ss << "\n";
   ss << "  --listing <file>          listing file\n";
   ss << "\n";
+  ss << "  --parse-cache <dir>       keep the parse result of every source in a\n";
+  ss << "                            directory and replay unchanged sources\n";
+  ss << "\n";
+  ss << "  --module-interface <file> write the compiled interface of the exported\n";
+  ss << "                            sources for importers to map\n";
+  ss << "\n";
+  ss << "  --depfile <file>          write a Makefile depfile of every file read,\n";
+  ss << "                            probed or listed\n";
+  ss << "\n";
+  ss << "  --stamp <file>            record the content of every input and skip\n";
+  ss << "                            the next run if nothing changed\n";
+  ss << "\n";
+  ss << "  --watch                   keep running and recompile the sources\n";
+  ss << "                            affected whenever a loaded file changes\n";
+  ss << "\n";
+  ss << "  --dedupe-sources          parse sources with identical content only\n";
+  ss << "                            once even when they are different files\n";
+  ss << "\n";
   ss << "  --tab <size>              specifies default input file tab size\n";
   ss << "\n";
+  ss << "  --jobs <count>            parse up to this many input files at once\n";
+  ss << "                            (0=one per hardware thread, default=1)\n";
+  ss << "\n";
+  ss << "  --asset-workers <count>   copy up to this many assets at once\n";
+  ss << "                            (0=one per hardware thread, default=" << Config{}.assetWorkers_ << ")\n";
+  ss << "\n";
   ss << "  --max-errors <size>       specifies the maximum errors before aborting\n";
   ss << "                            (default=" << Singleton::DefaultMaxErrors <<  ")\n";
   ss << "\n";
@@ -90,6 +175,19 @@ void showHelp() noexcept
     ss << "                            (default=" << (*Singleton::DefaultMaxWarnings) << ")\n";
   }
   ss << "\n";
+  ss << "  --diagnostics-format <...> specify how diagnostics are written, choose from:\n";
+  ss << "                            text (default)\n";
+  ss << "                            jsonl\n";
+  ss << "                            sarif\n";
+  ss << "\n";
+  ss << "  --server <socket>         keep running and compile the requests sent to\n";
+  ss << "                            a Unix domain socket with warm caches\n";
+  ss << "                            (must be the first option)\n";
+  ss << "\n";
+  ss << "  --connect <socket> ...    forward the remaining options to a compile\n";
+  ss << "                            server and report its output and exit code\n";
+  ss << "                            (must be the first option)\n";
+  ss << "\n";
 #ifdef ZAX_INCLUDE_TESTS
   ss << "  --test                    run unit tests\n";
   ss << "\n";
@@ -113,13 +211,21 @@ void showHelp() noexcept
 //-----------------------------------------------------------------------------
 void showError(const std::string& message) noexcept
 {
+  if (singleton().writer_) {
+    ++singleton().totalErrors_;
+    singleton().error(-3);
+    Diagnostic diagnostic{ .type_ = CompilerException::ErrorType::Error, .text_ = message };
+    singleton().writer_->write(diagnostic, [](String&& text) noexcept { singleton().sink_.write(std::move(text)); });
+    return;
+  }
+
   StringStream ss;
-  std::cout << "\n";
-  std::cout << "[ERROR] " << message << "\n";
-  std::cout << "\n";
+  ss << "\n";
+  ss << "[ERROR] " << message << "\n";
+  ss << "\n";
   ++singleton().totalErrors_;
   singleton().error(-3);
-  singleton().write(ss);
+  singleton().write(ss, true);
 }
 
 //-----------------------------------------------------------------------------
@@ -128,40 +234,75 @@ void showIllegalOption(const std::string& arg) noexcept
   showError("Command line argument issue: "s + arg);
 }
 
-} // namespace
-
 //-----------------------------------------------------------------------------
-void zax::output(const CompilerException& exception) noexcept
+bool countDiagnostic(CompilerException::ErrorType type) noexcept
 {
-  switch (exception.type_) {
+  switch (type) {
     case CompilerException::ErrorType::Informational:   break;
     case CompilerException::ErrorType::Warning: {
-      ++singleton().totalWarnings_;
+      auto totalWarnings{ ++singleton().totalWarnings_ };
 
       if (singleton().maxWarnings_) {
-        if (singleton().totalWarnings_ > (*singleton().maxWarnings_))
-          return;
+        if (totalWarnings > (*singleton().maxWarnings_)) {
+          singleton().cancellation_->cancel(CancellationToken::Reason::TooManyWarnings);
+          return false;
+        }
       }
       break;
     }
     case CompilerException::ErrorType::Error: {
-      ++singleton().totalErrors_;
+      auto totalErrors{ ++singleton().totalErrors_ };
       singleton().error(-1);
-      if (singleton().totalErrors_ > singleton().maxErrors_)
-        return;
+      if (totalErrors > singleton().maxErrors_) {
+        singleton().cancellation_->cancel(CancellationToken::Reason::TooManyErrors);
+        return false;
+      }
       break;
     }
     case CompilerException::ErrorType::Fatal: {
       ++singleton().totalErrors_;
       ++singleton().totalFatals_;
       singleton().error(-2);
+      singleton().cancellation_->cancel(CancellationToken::Reason::Fatal);
       break;
     }
   }
+  return true;
+}
 
-  StringStream ss;
-  ss << exception.what();
-  singleton().write(ss);
+} // namespace
+
+//-----------------------------------------------------------------------------
+void zax::output(const CompilerException& exception) noexcept
+{
+  if (singleton().writer_) {
+    // the message is already rendered so it is passed through as is
+    output(Diagnostic{
+      .type_ = exception.type_,
+      .fileName_ = exception.fileName_,
+      .line_ = exception.line_,
+      .column_ = exception.column_,
+      .iana_ = exception.iana_,
+      .text_ = exception.message_ });
+    return;
+  }
+
+  if (countDiagnostic(exception.type_))
+    singleton().write(String{ exception.what() } + '\n');
+}
+
+//-----------------------------------------------------------------------------
+void zax::output(const Diagnostic& diagnostic) noexcept
+{
+  // dropped diagnostics are counted but never rendered
+  if (!countDiagnostic(diagnostic.type_))
+    return;
+
+  if (singleton().writer_) {
+    singleton().writer_->write(diagnostic, [](String&& text) noexcept { singleton().sink_.write(std::move(text)); });
+    return;
+  }
+  singleton().write(diagnostic.render() + '\n');
 }
 
 //-----------------------------------------------------------------------------
@@ -176,18 +317,28 @@ int zax::totalWarnings() noexcept
   return singleton().totalWarnings_;
 }
 
+//-----------------------------------------------------------------------------
+int zax::maxErrors() noexcept
+{
+  return singleton().maxErrors_;
+}
+
+//-----------------------------------------------------------------------------
+std::optional<int> zax::maxWarnings() noexcept
+{
+  return singleton().maxWarnings_;
+}
+
 //-----------------------------------------------------------------------------
 bool zax::shouldAbort() noexcept
 {
-  if (singleton().totalFatals_ > 0)
-    return true;
-  if (singleton().totalErrors_ > singleton().maxErrors_)
-    return true;
-  if (!singleton().maxWarnings_)
-    return false;
-  if (singleton().totalWarnings_ > *(singleton().maxWarnings_))
-    return true;
-  return false;
+  return singleton().cancellation_->cancelled();
+}
+
+//-----------------------------------------------------------------------------
+CancellationTokenPtr zax::cancellation() noexcept
+{
+  return singleton().cancellation_;
 }
 
 //-----------------------------------------------------------------------------
@@ -214,11 +365,150 @@ public:
   }
 };
 
+namespace
+{
+
 //-----------------------------------------------------------------------------
-int main(int argn, char const* argv[])
+SourceDependencies compile(const Config& config) noexcept(false)
+{
+  Parser parser{ config };
+  parser.parse();
+
+  if (!config.moduleInterfacePath_.empty()) {
+    if (!ModuleInterface::write(parser, config.moduleInterfacePath_))
+      showError("unable to write module interface: "s + config.moduleInterfacePath_);
+  }
+
+  AssetCopier::Statistics assets{ parser.assetCopier_.statistics_ };
+  for (auto& worker : parser.sourceParsers_)
+    assets.add(worker->assetCopier_.statistics_);
+  auto avoidedSourceLoads{ parser.avoidedSourceLoads_ };
+  auto duplicateSources{ parser.duplicateSources_ };
+  for (auto& worker : parser.sourceParsers_) {
+    avoidedSourceLoads += worker->avoidedSourceLoads_;
+    duplicateSources += worker->duplicateSources_;
+  }
+  if ((avoidedSourceLoads > 0) || (duplicateSources > 0)) {
+    StringStream ss;
+    ss << "sources: " << parser.processedSources_.size() << " parsed, ";
+    ss << avoidedSourceLoads << " repeated loads avoided, ";
+    ss << duplicateSources << " duplicates skipped\n";
+    singleton().write(ss);
+  }
+
+  if (!assets.empty()) {
+    StringStream ss;
+    ss << "assets: " << assets.copiedFiles_ << " copied (" << assets.copiedBytes_ << " bytes), ";
+    ss << assets.linkedFiles_ << " linked, ";
+    ss << assets.skippedFiles_ << " unchanged (" << assets.skippedBytes_ << " bytes)\n";
+    singleton().write(ss);
+  }
+
+  if (!config.metaData_.outputPath_.empty()) {
+    for (auto& failed : MetadataWriter{ config.metaData_ }.write(parser))
+      showError("unable to write metadata: "s + failed);
+
+    auto& metaData{ config.metaData_ };
+    for (auto [enabled, extension] : { std::pair{ metaData.json_, "json"sv }, std::pair{ metaData.bson_, "bson"sv }, std::pair{ metaData.cbor_, "cbor"sv }, std::pair{ metaData.msgPack_, "msgpack"sv }, std::pair{ metaData.ubjson_, "ubjson"sv } }) {
+      if (enabled)
+        parser.dependencies_.outputs_.insert(MetadataWriter::filePath(metaData, extension));
+    }
+  }
+  return parser.dependencies_;
+}
+
+//-----------------------------------------------------------------------------
+void record(const Config& config, const SourceDependencies& dependencies, bool stamp) noexcept
+{
+  if (!config.dependencyFilePath_.empty()) {
+    StringView target{ config.dependencyFilePath_ };
+    if (!config.stampFilePath_.empty())
+      target = config.stampFilePath_;
+    else if (!config.outputPath_.empty())
+      target = config.outputPath_;
+
+    if (!BuildStamp::writeDependencyFile(config.dependencyFilePath_, target, dependencies))
+      showError("unable to write depfile: "s + config.dependencyFilePath_);
+  }
+
+  if ((!stamp) || (config.stampFilePath_.empty()))
+    return;
+
+  // a failed run leaves no stamp so the next run reports the failure again
+  if (totalErrors() > 0) {
+    std::error_code ec;
+    std::filesystem::remove(Path{ config.stampFilePath_ }, ec);
+    return;
+  }
+  if (!BuildStamp::make(config, dependencies).save(config.stampFilePath_))
+    showError("unable to write stamp: "s + config.stampFilePath_);
+}
+
+//-----------------------------------------------------------------------------
+void watch(const Config& config, SourceDependencies dependencies) noexcept
+{
+  FileWatcher watcher;
+  if (!watcher.available()) {
+    showError("watching files is not supported on this platform");
+    return;
+  }
+
+  // command line sources stay watched even while they fail to load
+  auto commandLine{ dependencies.roots() };
+
+  // rounds name the command line sources the way they were given
+  std::map<String, String> spellings;
+  for (auto& file : config.inputFilePaths_) {
+    String fullFilePath;
+    if (makeIncludeFile("ignored.bin", file, fullFilePath).empty())
+      fullFilePath = file;
+    spellings.emplace(fullFilePath, file);
+  }
+
+  while (true) {
+    (void)watcher.watch(dependencies.files());
+
+    auto roots{ dependencies.affected(watcher.wait()) };
+    if (roots.empty())
+      continue;
+
+    singleton().restart();
+    {
+      StringStream ss;
+      ss << "recompiling " << roots.size() << " source" << (roots.size() == 1 ? "" : "s") << "\n";
+      singleton().write(ss);
+    }
+
+    Config round{ config };
+    round.inputFilePaths_.clear();
+    for (auto& root : roots) {
+      auto found{ spellings.find(root) };
+      round.inputFilePaths_.push_back(spellings.end() != found ? found->second : root);
+    }
+
+    SourceDependencies fresh;
+    try {
+      fresh = compile(round);
+    }
+    catch (const CompilerException& e) {
+      zax::output(e);
+    }
+    dependencies.replace(fresh, roots);
+    for (auto& root : commandLine)
+      dependencies.add(root, {});
+
+    // a stamp proves itself against the files so it is only written once
+    record(config, dependencies, false);
+    singleton().sink_.flush();
+  }
+}
+
+//-----------------------------------------------------------------------------
+int runCommandLine(int argn, char const* argv[], const SourceCachePtr& sourceCache)
 {
   constexpr const StringView prefix{ "--" };
   Config config;
+  config.sourceCache_ = sourceCache;
 
   try {
     std::string lastOption;
@@ -277,18 +567,42 @@ int main(int argn, char const* argv[])
           goto resetOption;
         }
 
+        if (0 == lastOption.compare("watch")) {
+          config.watch_ = true;
+          goto resetOption;
+        }
+
+        if (0 == lastOption.compare("dedupe-sources")) {
+          config.deduplicateSourcesByContent_ = true;
+          goto resetOption;
+        }
+
         if (0 == lastOption.compare("in"))
           continue;
         if (0 == lastOption.compare("out"))
           continue;
         if (0 == lastOption.compare("listing"))
           continue;
+        if (0 == lastOption.compare("parse-cache"))
+          continue;
+        if (0 == lastOption.compare("module-interface"))
+          continue;
+        if (0 == lastOption.compare("depfile"))
+          continue;
+        if (0 == lastOption.compare("stamp"))
+          continue;
         if (0 == lastOption.compare("tab"))
           continue;
+        if (0 == lastOption.compare("jobs"))
+          continue;
+        if (0 == lastOption.compare("asset-workers"))
+          continue;
         if (0 == lastOption.compare("max-errors"))
           continue;
         if (0 == lastOption.compare("max-warnings"))
           continue;
+        if (0 == lastOption.compare("diagnostics-format"))
+          continue;
         if (0 == lastOption.compare("metadata"))
           continue;
         if (0 == lastOption.compare("metadata-types"))
@@ -318,6 +632,30 @@ int main(int argn, char const* argv[])
           config.listingFilePath_ = arg;
           goto resetOption;
         }
+        if (0 == lastOption.compare("parse-cache")) {
+          if (config.parseCachePath_.size() > 0)
+            IllegalOption::throwError(arg);
+          config.parseCachePath_ = arg;
+          goto resetOption;
+        }
+        if (0 == lastOption.compare("module-interface")) {
+          if (config.moduleInterfacePath_.size() > 0)
+            IllegalOption::throwError(arg);
+          config.moduleInterfacePath_ = arg;
+          goto resetOption;
+        }
+        if (0 == lastOption.compare("depfile")) {
+          if (config.dependencyFilePath_.size() > 0)
+            IllegalOption::throwError(arg);
+          config.dependencyFilePath_ = arg;
+          goto resetOption;
+        }
+        if (0 == lastOption.compare("stamp")) {
+          if (config.stampFilePath_.size() > 0)
+            IllegalOption::throwError(arg);
+          config.stampFilePath_ = arg;
+          goto resetOption;
+        }
         if (0 == lastOption.compare("tab")) {
           size_t processed{};
           try {
@@ -336,6 +674,36 @@ int main(int argn, char const* argv[])
           }
           goto resetOption;
         }
+        if ((0 == lastOption.compare("jobs")) ||
+            (0 == lastOption.compare("asset-workers"))) {
+          size_t processed{};
+          try {
+            auto converted = std::stoll(arg, &processed);
+            if (converted < 0)
+              IllegalOption::throwError(lastOption);
+            if (processed < arg.length())
+              IllegalOption::throwError(lastOption);
+            if (0 == converted)
+              converted = std::max(std::thread::hardware_concurrency(), 1U);
+            auto& workers{ (0 == lastOption.compare("jobs")) ? config.sourceWorkers_ : config.assetWorkers_ };
+            workers = SafeInt<int>(converted);
+          }
+          catch (const std::invalid_argument&) {
+            IllegalOption::throwError(lastOption);
+          }
+          catch (const std::out_of_range&) {
+            IllegalOption::throwError(lastOption);
+          }
+          goto resetOption;
+        }
+        if (0 == lastOption.compare("diagnostics-format")) {
+          auto format{ Config::DiagnosticsFormatTraits::toEnum(arg) };
+          if ((!format) || (Config::DiagnosticsFormat::Text != config.diagnosticsFormat_))
+            IllegalOption::throwError(lastOption);
+          config.diagnosticsFormat_ = *format;
+          singleton().structured(config.diagnosticsFormat_);
+          goto resetOption;
+        }
         if (0 == lastOption.compare("metadata")) {
           if (config.metaData_.outputPath_.size() > 0)
             IllegalOption::throwError(arg);
@@ -439,12 +807,27 @@ int main(int argn, char const* argv[])
         }
       };
 
+      verifyMetaDataAllow();
+
+      if ((config.watch_) && (!config.sourceCache_))
+        config.sourceCache_ = std::make_shared<SourceCache>();
+
+      if ((!config.watch_) && (!config.stampFilePath_.empty())) {
+        if (auto stamp{ BuildStamp::load(config.stampFilePath_) }; (stamp) && (stamp->upToDate(config)))
+          return singleton().error();
+      }
+
+      SourceDependencies dependencies;
       try {
-        //compile();
+        dependencies = compile(config);
       }
       catch (const CompilerException& e) {
         zax::output(e);
       }
+      record(config, dependencies, true);
+
+      if (config.watch_)
+        watch(config, std::move(dependencies));
     }
   }
   catch (const IllegalOption& option) {
@@ -452,3 +835,45 @@ int main(int argn, char const* argv[])
   }
   return singleton().error();
 }
+
+//-----------------------------------------------------------------------------
+int run(int argn, char const* argv[], const SourceCachePtr& sourceCache = {})
+{
+  singleton().reset();
+  auto result{ runCommandLine(argn, argv, sourceCache) };
+  singleton().finish();
+  return result;
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+int main(int argn, char const* argv[])
+{
+  if ((argn > 2) && ("--server"sv == argv[1])) {
+    CompileServer server{ argv[2] };
+    if (!server.listen()) {
+      showError("unable to listen on the compile server socket "s + argv[2]);
+      return singleton().error();
+    }
+
+    auto sourceCache{ std::make_shared<SourceCache>() };
+    server.serve([&](const StringList& arguments) -> int {
+      std::vector<char const*> forwarded{ argv[0] };
+      for (auto& argument : arguments)
+        forwarded.push_back(argument.c_str());
+      return run(static_cast<int>(forwarded.size()), forwarded.data(), sourceCache);
+    });
+    return 0;
+  }
+
+  if ((argn > 2) && ("--connect"sv == argv[1])) {
+    StringList arguments{ argv + 3, argv + argn };
+    if (auto result{ CompileServer::forward(argv[2], arguments, std::cout) }; result)
+      return *result;
+    showError("unable to reach the compile server at "s + argv[2]);
+    return singleton().error();
+  }
+
+  return run(argn, argv);
+}
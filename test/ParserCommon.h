@@ -0,0 +1,269 @@
+#pragma once
+
+#include <filesystem>
+#include <variant>
+#include <iterator>
+
+#include "common.h"
+
+#include "../src/Parser.h"
+#include "../src/CompileState.h"
+
+namespace zaxTest
+{
+
+using Error = zax::ErrorTypes::Error;
+using Warning = zax::WarningTypes::Warning;
+using Panic = zax::PanicTypes::Panic;
+using Informational = zax::InformationalTypes::Informational;
+using DiagnosticArguments = zax::DiagnosticArguments;
+using String = zax::String;
+using Path = zax::Path;
+using Callbacks = zax::ParserTypes::Callbacks;
+using TokenConstPtr = zax::TokenConstPtr;
+using CompileState = zax::CompileState;
+using CompileStateConstPtr = zax::CompileStateConstPtr;
+using Parser = zax::Parser;
+using ParserPtr = zax::ParserPtr;
+using Config = zax::Config;
+
+// Shared by the parser suites: records the diagnostics a test expects and
+// checks each one reported against them in order.
+struct ParserCommon
+{
+  struct ExpectedFailures
+  {
+    std::variant<Error, Warning, Informational> type_;
+    bool isFatal_{};
+    String fileName_;
+    int line_{};
+    int column_{};
+    DiagnosticArguments mapping_;
+    bool forcedError_{};
+
+    ExpectedFailures(bool fatal, Error error, StringView fileName, int line, int column, const DiagnosticArguments& mapping) noexcept(false) :
+      type_{ error },
+      isFatal_{ fatal },
+      fileName_{ fileName },
+      line_{ line },
+      column_{ column },
+      mapping_{ mapping }
+    {}
+    ExpectedFailures(Warning warning, StringView fileName, int line, int column, const DiagnosticArguments& mapping, bool forcedError = false) noexcept(false) :
+      type_{ warning },
+      fileName_{ fileName },
+      line_{ line },
+      column_{ column },
+      mapping_{ mapping },
+      forcedError_(forcedError)
+    {}
+
+  };
+
+  std::list<ExpectedFailures> failures_;
+  std::optional<Callbacks> callbacks_;
+
+  std::list<TokenConstPtr> faultTokens_;
+
+  //-------------------------------------------------------------------------
+  void reset() noexcept
+  {
+    TEST(failures_.empty());
+    failures_.clear();
+    callbacks_.reset();
+    faultTokens_.clear();
+  }
+
+  //-------------------------------------------------------------------------
+  Callbacks* callbacks() noexcept(false)
+  {
+    callbacks_.emplace();
+    callbacks(*callbacks_);
+    return &(*callbacks_);
+  }
+
+  //-------------------------------------------------------------------------
+  void callbacks(Callbacks& output) noexcept(false)
+  {
+    output.cancellation_ = std::make_shared<zax::CancellationToken>();
+    output.fatal_ = [&](Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept(false) {
+      TEST(failures_.size() > 0);
+      auto& front{ failures_.front() };
+      auto ptr{ std::get_if<Error>(&(front.type_)) };
+      TEST(ptr);
+      TEST(*ptr == error);
+      TEST(!!token);
+      TEST(Path{ token->origin_.filePath_->filePath_ } == Path{ front.fileName_ });
+      TEST(token->origin_.location_.line_ == front.line_);
+      TEST(token->origin_.location_.column_ == front.column_);
+      TEST(!front.isFatal_);
+      TEST(mapping.size() == front.mapping_.size());
+      TEST(mapping == front.mapping_);
+
+      faultTokens_.push_back(token);
+      failures_.pop_front();
+    };
+    output.error_ = [&](Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept(false) {
+      TEST(failures_.size() > 0);
+      auto& front{ failures_.front() };
+      auto ptr{ std::get_if<Error>(&(front.type_)) };
+      TEST(ptr);
+      TEST(*ptr == error);
+      TEST(!!token);
+      TEST(Path{ token->origin_.filePath_->filePath_ } == Path{ front.fileName_ });
+      TEST(token->origin_.location_.line_ == front.line_);
+      TEST(token->origin_.location_.column_ == front.column_);
+      TEST(!front.isFatal_);
+      TEST(mapping.size() == front.mapping_.size());
+      TEST(mapping == front.mapping_);
+
+      faultTokens_.push_back(token);
+      failures_.pop_front();
+    };
+    output.warning_ = [&](Warning warning, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept(false) {
+      TEST(failures_.size() > 0);
+      auto& front{ failures_.front() };
+      auto ptr{ std::get_if<Warning>(&(front.type_)) };
+      TEST(ptr);
+      TEST(*ptr == warning);
+      TEST(!!token);
+      TEST(Path{ token->origin_.filePath_->filePath_ } == Path{ front.fileName_ });
+      TEST(token->origin_.location_.line_ == front.line_);
+      TEST(token->origin_.location_.column_ == front.column_);
+      TEST(!front.isFatal_);
+      TEST(mapping.size() == front.mapping_.size());
+      TEST(mapping == front.mapping_);
+      TEST(token->compileState_->isWarningAnError(warning) == front.forcedError_);
+
+      faultTokens_.push_back(token);
+      failures_.pop_front();
+    };
+    output.info_ = [&](Informational info, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept(false) {
+      TEST(failures_.size() > 0);
+      auto& front{ failures_.front() };
+      auto ptr{ std::get_if<Informational>(&(front.type_)) };
+      TEST(ptr);
+      TEST(*ptr == info);
+      TEST(!!token);
+      TEST(Path{ token->origin_.filePath_->filePath_ } == Path{ front.fileName_ });
+      TEST(token->origin_.location_.line_ == front.line_);
+      TEST(token->origin_.location_.column_ == front.column_);
+      TEST(!front.isFatal_);
+      TEST(mapping.size() == front.mapping_.size());
+      TEST(mapping == front.mapping_);
+
+      faultTokens_.push_back(token);
+      failures_.pop_front();
+    };
+  }
+
+  //-------------------------------------------------------------------------
+  void fatal(Error error, StringView fileName, int line, int column, const DiagnosticArguments& mapping = {}) noexcept(false)
+  {
+    failures_.emplace_back(true, error, fileName, line, column, mapping);
+  }
+
+  //-------------------------------------------------------------------------
+  void expect(Error error, StringView fileName, int line, int column, const DiagnosticArguments& mapping = {}) noexcept(false)
+  {
+    failures_.emplace_back(false, error, fileName, line, column, mapping);
+  }
+
+  //-------------------------------------------------------------------------
+  void expect(Warning warning, StringView fileName, int line, int column, const DiagnosticArguments& mapping = {}) noexcept(false)
+  {
+    failures_.emplace_back(warning, fileName, line, column, mapping);
+  }
+
+  //-------------------------------------------------------------------------
+  void error(Warning warning, StringView fileName, int line, int column, const DiagnosticArguments& mapping = {}) noexcept(false)
+  {
+    failures_.emplace_back(warning, fileName, line, column, mapping, true);
+  }
+
+  //-------------------------------------------------------------------------
+  void expect(const CompileState& state, const Panic which) noexcept(false)
+  {
+    TEST(state.panics_.at(which).enabled_);
+  }
+
+  //-------------------------------------------------------------------------
+  void disabled(const CompileState& state, const Panic which) noexcept(false)
+  {
+    TEST(!state.panics_.at(which).enabled_);
+  }
+
+  //-------------------------------------------------------------------------
+  void expect(const TokenConstPtr& token, const Panic which) noexcept(false)
+  {
+    TEST(static_cast<bool>(token));
+    TEST(static_cast<bool>(token->compileState_));
+    expect(*(token->compileState_), which);
+  }
+
+  //-------------------------------------------------------------------------
+  void disabled(const TokenConstPtr& token, const Panic which) noexcept(false)
+  {
+    TEST(static_cast<bool>(token));
+    TEST(static_cast<bool>(token->compileState_));
+    disabled(*(token->compileState_), which);
+  }
+
+  //-------------------------------------------------------------------------
+  void expect(size_t index, const Panic which) noexcept(false)
+  {
+    TEST(index < faultTokens_.size());
+    auto iter{ faultTokens_.begin() };
+    std::advance(iter, index);
+    expect(*iter, which);
+  }
+
+  //-------------------------------------------------------------------------
+  void disabled(size_t index, const Panic which) noexcept(false)
+  {
+    TEST(index < faultTokens_.size());
+    auto iter{ faultTokens_.begin() };
+    std::advance(iter, index);
+    disabled(*iter, which);
+  }
+
+  //-------------------------------------------------------------------------
+  TokenConstPtr faultToken(size_t index) noexcept(false)
+  {
+    TEST(index < faultTokens_.size());
+    auto iter{ faultTokens_.begin() };
+    std::advance(iter, index);
+    return *iter;
+  }
+
+  //-------------------------------------------------------------------------
+  CompileStateConstPtr faultTokenState(size_t index) noexcept(false)
+  {
+    auto token{ faultToken(index) };
+    TEST(static_cast<bool>(token));
+    TEST(static_cast<bool>(token->compileState_));
+    return token->compileState_;
+  }
+
+  //-------------------------------------------------------------------------
+  ParserPtr testCommon(
+    const std::string_view filePath,
+    const std::string_view content) noexcept(false)
+  {
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path{ filePath }.parent_path(), ec);
+
+    TEST(zax::writeBinaryFile(filePath, content));
+
+    Config config;
+    config.inputFilePaths_.emplace_back(filePath);
+    auto parser{ std::make_shared<Parser>(config, callbacks()) };
+
+    parser->parse();
+
+    output(__FILE__ "::" __FUNCTION__);
+    return parser;
+  }
+};
+
+} // namespace zaxTest
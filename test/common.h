@@ -23,6 +23,10 @@ void testTokenizer() noexcept(false);
 void testTokenList() noexcept(false);
 void testParserLineDirectives() noexcept(false);
 void testParserAlias() noexcept(false);
+void testCancellation() noexcept(false);
+void testBuildStamp() noexcept(false);
+void testModuleInterface() noexcept(false);
+void testMetadataWriter() noexcept(false);
 
 void output(StringView testName) noexcept;
 
@@ -0,0 +1,128 @@
+#include <pch.h>
+
+#include "common.h"
+#include "ParserCommon.h"
+
+#include "../src/BuildStamp.h"
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+
+namespace zaxTest
+{
+
+struct ParserBuildStamp : public ParserCommon
+{
+  //-------------------------------------------------------------------------
+  void testBuildStamp() noexcept(false)
+  {
+    using BuildStamp = zax::BuildStamp;
+
+    const std::string_view example1{ "ignored/testing/parser/build-stamp/a.zax" };
+    const std::string_view example2{ "ignored/testing/parser/build-stamp/lib/b.zax" };
+    const std::string_view example3{ "ignored/testing/parser/build-stamp/c.txt" };
+    const std::string_view added{ "ignored/testing/parser/build-stamp/lib/d.zax" };
+    const std::string_view missing{ "ignored/testing/parser/build-stamp/missing.zax" };
+    const std::string_view outputPath{ "ignored/testing/parser/build-stamp/output/" };
+    const std::string_view dependencyFilePath{ "ignored/testing/parser/build-stamp/output/a.d" };
+    const std::string_view stampFilePath{ "ignored/testing/parser/build-stamp/output/a.stamp" };
+
+    std::error_code ec;
+    std::filesystem::remove_all(std::filesystem::path{ example1 }.parent_path(), ec);
+    std::filesystem::create_directories(std::filesystem::path{ example2 }.parent_path(), ec);
+
+    const std::string_view content1{
+      "[[source='lib/*.zax']]\n"
+      "[[source='missing.zax',required=no]]\n"
+      "[[asset='c.txt']]\n"
+    };
+
+    TEST(zax::writeBinaryFile(example1, content1));
+    TEST(zax::writeBinaryFile(example2, "// included\n"));
+    TEST(zax::writeBinaryFile(example3, "ASSET"));
+
+    Config config;
+    config.inputFilePaths_.emplace_back(example1);
+    config.outputPath_ = outputPath;
+    config.dependencyFilePath_ = dependencyFilePath;
+    config.stampFilePath_ = stampFilePath;
+    auto parser{ std::make_shared<Parser>(config, callbacks()) };
+    parser->parse();
+    TEST(2 == parser->processedSources_.size());
+
+    // the glob, the failed probe and the copy are all tracked
+    auto& dependencies{ parser->dependencies_ };
+    auto endsWith{ [](const auto& files, StringView suffix) noexcept {
+      return std::any_of(files.begin(), files.end(), [&](const String& file) noexcept { return StringView{ zax::stringReplace(file, "\\", "/") }.ends_with(suffix); });
+    } };
+    TEST(endsWith(dependencies.listedDirectories_, "build-stamp/lib"));
+    TEST(endsWith(dependencies.probedFiles_, "build-stamp/missing.zax"));
+    TEST(endsWith(dependencies.outputs_, "build-stamp/output/c.txt"));
+
+    TEST(BuildStamp::writeDependencyFile(dependencyFilePath, stampFilePath, dependencies));
+    {
+      auto [contents, length] { zax::readBinaryFile(dependencyFilePath) };
+      TEST(nullptr != contents);
+      StringView depfile{ reinterpret_cast<const char*>(contents.get()), length };
+      TEST(depfile.starts_with(String{ stampFilePath } + ":"));
+      TEST(StringView::npos != depfile.find("build-stamp/lib/b.zax \\\n"));
+      TEST(StringView::npos != depfile.find("build-stamp/c.txt \\\n"));
+      TEST(StringView::npos != depfile.find("build-stamp/lib/b.zax:\n"));
+      TEST(StringView::npos == depfile.find("missing.zax"));
+      TEST(StringView::npos == depfile.find("output/c.txt"));
+    }
+
+    TEST(BuildStamp::make(config, dependencies).save(stampFilePath));
+    auto upToDate{ [&](const Config& useConfig) noexcept(false) {
+      auto stamp{ BuildStamp::load(stampFilePath) };
+      TEST(stamp.has_value());
+      return stamp->upToDate(useConfig);
+    } };
+    TEST(upToDate(config));
+
+    Config changed{ config };
+    changed.tabStopWidth_ = 4;
+    TEST(!upToDate(changed));
+
+    // a file appearing where a wild card or a probe looked
+    TEST(zax::writeBinaryFile(added, "// added\n"));
+    TEST(!upToDate(config));
+    std::filesystem::remove(std::filesystem::path{ added }, ec);
+    TEST(upToDate(config));
+
+    TEST(zax::writeBinaryFile(missing, "// found\n"));
+    TEST(!upToDate(config));
+    std::filesystem::remove(std::filesystem::path{ missing }, ec);
+    TEST(upToDate(config));
+
+    // content is compared rather than timestamps
+    TEST(zax::writeBinaryFile(example2, "// included\n"));
+    TEST(upToDate(config));
+    TEST(zax::writeBinaryFile(example2, "// changed\n"));
+    TEST(!upToDate(config));
+    TEST(zax::writeBinaryFile(example2, "// included\n"));
+
+    std::filesystem::remove(std::filesystem::path{ outputPath } / "c.txt", ec);
+    TEST(!upToDate(config));
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void runAll() noexcept(false)
+  {
+    auto runner{ [&](auto&& func) noexcept(false) { reset(); func(); } };
+
+    runner([&]() { testBuildStamp(); });
+
+    reset();
+  }
+};
+
+//---------------------------------------------------------------------------
+void testBuildStamp() noexcept(false)
+{
+  ParserBuildStamp{}.runAll();
+}
+
+} // namespace zaxTest
@@ -0,0 +1,139 @@
+#include <pch.h>
+
+#include "common.h"
+#include "ParserCommon.h"
+
+#include "../src/CancellationToken.h"
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+
+namespace zaxTest
+{
+
+struct ParserCancellation : public ParserCommon
+{
+  //-------------------------------------------------------------------------
+  void testCancellation() noexcept(false)
+  {
+    using Reason = zax::CancellationToken::Reason;
+
+    const std::string_view example1{ "ignored/testing/parser/cancellation/a.zax" };
+    const std::string_view example2{ "ignored/testing/parser/cancellation/b.zax" };
+
+    const std::string_view content{
+      "[[asset='bogus_first.txt']]\n"
+      "[[asset='bogus_second.txt']]\n"
+    };
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path{ example1 }.parent_path(), ec);
+    TEST(zax::writeBinaryFile(example1, content));
+    TEST(zax::writeBinaryFile(example2, content));
+
+    auto cancelOnError{ [&](Callbacks* useCallbacks) noexcept {
+      auto original{ useCallbacks->error_ };
+      auto token{ useCallbacks->cancellation_ };
+      useCallbacks->error_ = [original, token](Error error, const TokenConstPtr& at, const DiagnosticArguments& mapping) noexcept(false) {
+        original(error, at, mapping);
+        token->cancel(Reason::TooManyErrors);
+      };
+      return useCallbacks;
+    } };
+
+    // a cancelled token stops before anything is loaded
+    {
+      Config config;
+      config.inputFilePaths_.emplace_back(example1);
+      auto parser{ std::make_shared<Parser>(config, callbacks()) };
+      TEST(parser->callbacks_.cancellation_->cancel(Reason::Requested));
+      TEST(!parser->callbacks_.cancellation_->cancel(Reason::Fatal));
+      TEST(Reason::Requested == parser->callbacks_.cancellation_->reason());
+      parser->parse();
+      TEST(parser->processedSources_.empty());
+      reset();
+    }
+
+    // the statement after the one that cancelled is never parsed
+    {
+      Config config;
+      config.inputFilePaths_.emplace_back(example1);
+      auto parser{ std::make_shared<Parser>(config, cancelOnError(callbacks())) };
+
+      expect(Error::AssetNotFound, example1, 1, 3, DiagnosticArguments{ { "$file$", "bogus_first.txt" } });
+
+      parser->parse();
+      TEST(parser->callbacks_.cancellation_->cancelled());
+      TEST(Reason::TooManyErrors == parser->callbacks_.cancellation_->reason());
+      TEST(parser->processedSources_.empty());
+      reset();
+    }
+
+    // worker parsers share the token so the replay stops at the same place
+    {
+      Config config;
+      config.sourceWorkers_ = 2;
+      config.inputFilePaths_.emplace_back(example1);
+      config.inputFilePaths_.emplace_back(example2);
+      auto parser{ std::make_shared<Parser>(config, cancelOnError(callbacks())) };
+
+      expect(Error::AssetNotFound, example1, 1, 3, DiagnosticArguments{ { "$file$", "bogus_first.txt" } });
+
+      parser->parse();
+      TEST(parser->callbacks_.cancellation_->cancelled());
+      for (auto& worker : parser->sourceParsers_)
+        TEST(worker->callbacks_.cancellation_ == parser->callbacks_.cancellation_);
+      reset();
+    }
+
+    // a worker's fatal cancels at once yet is still reported in serial order
+    {
+      const std::string_view missing{ "ignored/testing/parser/cancellation/missing.zax" };
+      std::filesystem::remove(std::filesystem::path{ missing }, ec);
+
+      Config config;
+      config.sourceWorkers_ = 2;
+      config.inputFilePaths_.emplace_back(example1);
+      config.inputFilePaths_.emplace_back(missing);
+      auto useCallbacks{ callbacks() };
+      auto original{ useCallbacks->fatal_ };
+      auto token{ useCallbacks->cancellation_ };
+      useCallbacks->fatal_ = [original, token](Error error, const TokenConstPtr& at, const DiagnosticArguments& mapping) noexcept(false) {
+        original(error, at, mapping);
+        token->cancel(Reason::Fatal);
+      };
+      auto parser{ std::make_shared<Parser>(config, useCallbacks) };
+
+      expect(Error::SourceNotFound, "[[internal]]", 0, 0, DiagnosticArguments{ { "$file$", String{ missing } } });
+
+      parser->parse();
+      TEST(Reason::Fatal == parser->callbacks_.cancellation_->reason());
+      TEST(parser->processedSources_.empty());
+      TEST(2 == parser->sourceParsers_.size());
+      auto& entries{ parser->sourceParsers_.back()->bufferedDiagnostics_->entries_ };
+      auto buffered{ std::any_of(entries.begin(), entries.end(), [](const auto& entry) noexcept { return zax::ParserTypes::BufferedDiagnostic::Kind::Fatal == entry.kind_; }) };
+      TEST(buffered);
+      reset();
+    }
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void runAll() noexcept(false)
+  {
+    auto runner{ [&](auto&& func) noexcept(false) { reset(); func(); } };
+
+    runner([&]() { testCancellation(); });
+
+    reset();
+  }
+};
+
+//---------------------------------------------------------------------------
+void testCancellation() noexcept(false)
+{
+  ParserCancellation{}.runAll();
+}
+
+} // namespace zaxTest
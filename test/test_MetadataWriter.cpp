@@ -0,0 +1,95 @@
+#include <pch.h>
+
+#include "common.h"
+#include "ParserCommon.h"
+
+#include "../src/MetadataWriter.h"
+#include "../src/version.h"
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+
+namespace zaxTest
+{
+
+struct ParserMetadataWriter : public ParserCommon
+{
+  //-------------------------------------------------------------------------
+  void testMetadataWriter() noexcept(false)
+  {
+    const std::string_view example1{ "ignored/testing/parser/metadata/a.zax" };
+    const std::string_view prefix{ "ignored/testing/parser/metadata/output/meta" };
+
+    std::error_code ec;
+    std::filesystem::remove_all(std::filesystem::path{ prefix }.parent_path(), ec);
+    std::filesystem::create_directories(std::filesystem::path{ example1 }.parent_path(), ec);
+
+    const std::string_view content1{
+      "[[export=always]]\n"
+      "[[deprecate=always,min='1.2.3',max='4.5.6-alpha']]\n"
+    };
+
+    TEST(zax::writeBinaryFile(example1, content1));
+
+    Config config;
+    config.inputFilePaths_.emplace_back(example1);
+    config.metaData_.outputPath_ = prefix;
+    config.metaData_.json_ = true;
+    config.metaData_.bson_ = true;
+    config.metaData_.cbor_ = true;
+    config.metaData_.msgPack_ = true;
+    config.metaData_.ubjson_ = true;
+    auto parser{ std::make_shared<Parser>(config, callbacks()) };
+    parser->parse();
+
+    zax::MetadataWriter writer{ config.metaData_ };
+    TEST(writer.write(*parser).empty());
+
+    auto read{ [&](std::string_view extension) noexcept(false) {
+      auto [contents, length] { zax::readBinaryFile(zax::MetadataWriter::filePath(config.metaData_, extension)) };
+      TEST(nullptr != contents);
+      return std::vector<uint8_t>{ reinterpret_cast<const uint8_t*>(contents.get()), reinterpret_cast<const uint8_t*>(contents.get()) + length };
+    } };
+
+    auto jsonBytes{ read("json") };
+    auto document = nlohmann::json::parse(jsonBytes.begin(), jsonBytes.end());
+
+    TEST(document["compiler"]["name"].get<std::string>() == zax::Version::name());
+    TEST(document["sources"].size() == 1);
+    auto& source{ document["sources"][0] };
+    TEST(zax::stringReplace(source["file"].get<std::string>(), "\\", "/") == example1);
+    TEST(source["exported"].get<bool>());
+    TEST(source["deprecated"]["context"].get<std::string>() == "import");
+    TEST(source["deprecated"]["min"].get<std::string>() == "1.2.3");
+    TEST(source["deprecated"]["max"].get<std::string>() == "4.5.6-alpha");
+    TEST(source["deprecated"]["line"].get<int>() == 2);
+    TEST(source["types"].is_array());
+    TEST(source["aliases"]["keywords"].is_object());
+
+    // every format decodes to the same document
+    TEST(nlohmann::json::from_bson(read("bson")) == document);
+    TEST(nlohmann::json::from_cbor(read("cbor")) == document);
+    TEST(nlohmann::json::from_msgpack(read("msgpack")) == document);
+    TEST(nlohmann::json::from_ubjson(read("ubjson")) == document);
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void runAll() noexcept(false)
+  {
+    auto runner{ [&](auto&& func) noexcept(false) { reset(); func(); } };
+
+    runner([&]() { testMetadataWriter(); });
+
+    reset();
+  }
+};
+
+//---------------------------------------------------------------------------
+void testMetadataWriter() noexcept(false)
+{
+  ParserMetadataWriter{}.runAll();
+}
+
+} // namespace zaxTest
@@ -0,0 +1,108 @@
+#include <pch.h>
+
+#include "common.h"
+#include "ParserCommon.h"
+
+#include "../src/Module.h"
+#include "../src/ModuleInterface.h"
+#include "../src/version.h"
+
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+
+namespace zaxTest
+{
+
+struct ParserModuleInterface : public ParserCommon
+{
+  //-------------------------------------------------------------------------
+  void testModuleInterface() noexcept(false)
+  {
+    using ModuleInterface = zax::ModuleInterface;
+
+    const std::string_view example1{ "ignored/testing/parser/module-interface/a.zax" };
+    const std::string_view example2{ "ignored/testing/parser/module-interface/b.zax" };
+    const std::string_view interfacePath{ "ignored/testing/parser/module-interface/a.zmi" };
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path{ example1 }.parent_path(), ec);
+    std::filesystem::remove(std::filesystem::path{ interfacePath }, ec);
+
+    const std::string_view content1{
+      "[[source='b.zax']]\n"
+      "[[export=always]]\n"
+      "[[deprecate=always,min='1.2.3',max='4.5.6-alpha']]\n"
+      "const :: alias keyword constant\n"
+    };
+    const std::string_view content2{
+      "// not exported\n"
+    };
+
+    TEST(zax::writeBinaryFile(example1, content1));
+    TEST(zax::writeBinaryFile(example2, content2));
+
+    Config config;
+    config.inputFilePaths_.emplace_back(example1);
+    auto parser{ std::make_shared<Parser>(config, callbacks()) };
+    parser->parse();
+    TEST(2 == parser->processedSources_.size());
+    TEST(ModuleInterface::write(*parser, interfacePath));
+
+    auto moduleInterface{ ModuleInterface::open(interfacePath) };
+    TEST(!!moduleInterface);
+    TEST(moduleInterface->compiler() == zax::Version::version());
+
+    // only the exported source is part of the interface
+    TEST(1 == moduleInterface->totalSources());
+    auto source{ moduleInterface->source(0) };
+    TEST(zax::stringReplace(String{ moduleInterface->text(source.file_) }, "\\", "/") == example1);
+
+    auto deprecate{ moduleInterface->deprecate(source) };
+    TEST(deprecate.has_value());
+    TEST(zax::CompileState::Deprecate::Context::Import == deprecate->context_);
+    TEST(deprecate->min_.has_value());
+    TEST(*deprecate->min_ == zax::SemanticVersion{ "1.2.3" });
+    TEST(deprecate->max_.has_value());
+    TEST(deprecate->max_->preRelease_ == "alpha");
+    TEST(*deprecate->max_ == zax::SemanticVersion{ "4.5.6-alpha" });
+    TEST(3 == deprecate->origin_.location_.line_);
+
+    auto alias{ moduleInterface->find(ModuleInterface::Kind::OperatorAlias, "const") };
+    TEST(alias.has_value());
+    TEST(moduleInterface->text(alias->value_) == "constant");
+    TEST(0 == alias->source_);
+    TEST(!moduleInterface->find(ModuleInterface::Kind::KeywordAlias, "const"));
+    TEST(!moduleInterface->find(ModuleInterface::Kind::OperatorAlias, "constant"));
+
+    // importing maps the interface once per module name
+    auto imported{ parser->import("a", interfacePath) };
+    TEST(!!imported);
+    TEST(!!imported->interface_);
+    TEST(imported == parser->import("a", interfacePath));
+    TEST(!parser->import("missing", "ignored/testing/parser/module-interface/missing.zmi"));
+
+    // a truncated interface is refused up front
+    TEST(zax::writeBinaryFile(interfacePath, "ZMIF"));
+    TEST(!ModuleInterface::open(interfacePath));
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void runAll() noexcept(false)
+  {
+    auto runner{ [&](auto&& func) noexcept(false) { reset(); func(); } };
+
+    runner([&]() { testModuleInterface(); });
+
+    reset();
+  }
+};
+
+//---------------------------------------------------------------------------
+void testModuleInterface() noexcept(false)
+{
+  ParserModuleInterface{}.runAll();
+}
+
+} // namespace zaxTest
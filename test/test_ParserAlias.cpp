@@ -15,7 +15,7 @@ using Error = zax::ErrorTypes::Error;
 using Warning = zax::WarningTypes::Warning;
 using Panic = zax::PanicTypes::Panic;
 using Informational = zax::InformationalTypes::Informational;
-using StringMap = zax::StringMap;
+using DiagnosticArguments = zax::DiagnosticArguments;
 using String = zax::String;
 using StringView = zax::StringView;
 using Callbacks = zax::ParserTypes::Callbacks;
@@ -53,10 +53,10 @@ struct ParserAliasCommon
     String fileName_;
     int line_{};
     int column_{};
-    StringMap mapping_;
+    DiagnosticArguments mapping_;
     bool forcedError_{};
 
-    ExpectedFailures(bool fatal, Error error, StringView fileName, int line, int column, const StringMap& mapping) noexcept(false) :
+    ExpectedFailures(bool fatal, Error error, StringView fileName, int line, int column, const DiagnosticArguments& mapping) noexcept(false) :
       type_{ error },
       isFatal_{ fatal },
       fileName_{ fileName },
@@ -64,7 +64,7 @@ struct ParserAliasCommon
       column_{ column },
       mapping_{ mapping }
     {}
-    ExpectedFailures(Warning warning, StringView fileName, int line, int column, const StringMap& mapping, bool forcedError = false) noexcept(false) :
+    ExpectedFailures(Warning warning, StringView fileName, int line, int column, const DiagnosticArguments& mapping, bool forcedError = false) noexcept(false) :
       type_{ warning },
       fileName_{ fileName },
       line_{ line },
@@ -100,10 +100,8 @@ struct ParserAliasCommon
   //-------------------------------------------------------------------------
   void callbacks(Callbacks& output) noexcept(false)
   {
-    output.shouldAbort_ = []() noexcept -> bool {
-      return false;
-    };
-    output.fatal_ = [&](Error error, const TokenConstPtr& token, const StringMap& mapping) noexcept(false) {
+    output.cancellation_ = std::make_shared<zax::CancellationToken>();
+    output.fatal_ = [&](Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept(false) {
       TEST(failures_.size() > 0);
       auto& front{ failures_.front() };
       auto ptr{ std::get_if<Error>(&(front.type_)) };
@@ -120,7 +118,7 @@ struct ParserAliasCommon
       faultTokens_.push_back(token);
       failures_.pop_front();
     };
-    output.error_ = [&](Error error, const TokenConstPtr& token, const StringMap& mapping) noexcept(false) {
+    output.error_ = [&](Error error, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept(false) {
       TEST(failures_.size() > 0);
       auto& front{ failures_.front() };
       auto ptr{ std::get_if<Error>(&(front.type_)) };
@@ -137,7 +135,7 @@ struct ParserAliasCommon
       faultTokens_.push_back(token);
       failures_.pop_front();
     };
-    output.warning_ = [&](Warning warning, const TokenConstPtr& token, const StringMap& mapping) noexcept(false) {
+    output.warning_ = [&](Warning warning, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept(false) {
       TEST(failures_.size() > 0);
       auto& front{ failures_.front() };
       auto ptr{ std::get_if<Warning>(&(front.type_)) };
@@ -155,7 +153,7 @@ struct ParserAliasCommon
       faultTokens_.push_back(token);
       failures_.pop_front();
     };
-    output.info_ = [&](Informational info, const TokenConstPtr& token, const StringMap& mapping) noexcept(false) {
+    output.info_ = [&](Informational info, const TokenConstPtr& token, const DiagnosticArguments& mapping) noexcept(false) {
       TEST(failures_.size() > 0);
       auto& front{ failures_.front() };
       auto ptr{ std::get_if<Informational>(&(front.type_)) };
@@ -175,25 +173,25 @@ struct ParserAliasCommon
   }
 
   //-------------------------------------------------------------------------
-  void fatal(Error error, StringView fileName, int line, int column, const StringMap& mapping = {}) noexcept(false)
+  void fatal(Error error, StringView fileName, int line, int column, const DiagnosticArguments& mapping = {}) noexcept(false)
   {
     failures_.emplace_back(true, error, fileName, line, column, mapping);
   }
 
   //-------------------------------------------------------------------------
-  void expect(Error error, StringView fileName, int line, int column, const StringMap& mapping = {}) noexcept(false)
+  void expect(Error error, StringView fileName, int line, int column, const DiagnosticArguments& mapping = {}) noexcept(false)
   {
     failures_.emplace_back(false, error, fileName, line, column, mapping);
   }
 
   //-------------------------------------------------------------------------
-  void expect(Warning warning, StringView fileName, int line, int column, const StringMap& mapping = {}) noexcept(false)
+  void expect(Warning warning, StringView fileName, int line, int column, const DiagnosticArguments& mapping = {}) noexcept(false)
   {
     failures_.emplace_back(warning, fileName, line, column, mapping);
   }
 
   //-------------------------------------------------------------------------
-  void error(Warning warning, StringView fileName, int line, int column, const StringMap& mapping = {}) noexcept(false)
+  void error(Warning warning, StringView fileName, int line, int column, const DiagnosticArguments& mapping = {}) noexcept(false)
   {
     failures_.emplace_back(warning, fileName, line, column, mapping, true);
   }
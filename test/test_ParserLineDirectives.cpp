@@ -6,10 +6,12 @@
 #include <iterator>
 
 #include "common.h"
+#include "ParserCommon.h"
 
 #include "../src/Parser.h"
 #include "../src/CompileState.h"
 #include "../src/Context.h"
+#include "../src/ListingWriter.h"
 
 using Parser = zax::Parser;
 using ParserPtr = zax::ParserPtr;
@@ -20,7 +22,7 @@ using Error = zax::ErrorTypes::Error;
 using Warning = zax::WarningTypes::Warning;
 using Panic = zax::PanicTypes::Panic;
 using Informational = zax::InformationalTypes::Informational;
-using StringMap = zax::StringMap;
+using DiagnosticArguments = zax::DiagnosticArguments;
 using StringList = zax::StringList;
 using String = zax::String;
 using StringView = zax::StringView;
@@ -43,249 +45,6 @@ using namespace std::string_view_literals;
 namespace zaxTest
 {
 
-struct ParserCommon
-{
-  struct ExpectedFailures
-  {
-    std::variant<Error, Warning, Informational> type_;
-    bool isFatal_{};
-    String fileName_;
-    int line_{};
-    int column_{};
-    StringMap mapping_;
-    bool forcedError_{};
-
-    ExpectedFailures(bool fatal, Error error, StringView fileName, int line, int column, const StringMap& mapping) noexcept(false) :
-      type_{ error },
-      isFatal_{ fatal },
-      fileName_{ fileName },
-      line_{ line },
-      column_{ column },
-      mapping_{ mapping }
-    {}
-    ExpectedFailures(Warning warning, StringView fileName, int line, int column, const StringMap& mapping, bool forcedError = false) noexcept(false) :
-      type_{ warning },
-      fileName_{ fileName },
-      line_{ line },
-      column_{ column },
-      mapping_{ mapping },
-      forcedError_(forcedError)
-    {}
-
-  };
-
-  std::list<ExpectedFailures> failures_;
-  std::optional<Callbacks> callbacks_;
-
-  std::list<TokenConstPtr> faultTokens_;
-
-  //-------------------------------------------------------------------------
-  void reset() noexcept
-  {
-    TEST(failures_.empty());
-    failures_.clear();
-    callbacks_.reset();
-    faultTokens_.clear();
-  }
-
-  //-------------------------------------------------------------------------
-  Callbacks* callbacks() noexcept(false)
-  {
-    callbacks_.emplace();
-    callbacks(*callbacks_);
-    return &(*callbacks_);
-  }
-
-  //-------------------------------------------------------------------------
-  void callbacks(Callbacks& output) noexcept(false)
-  {
-    output.shouldAbort_ = []() noexcept -> bool {
-      return false;
-    };
-    output.fatal_ = [&](Error error, const TokenConstPtr& token, const StringMap& mapping) noexcept(false) {
-      TEST(failures_.size() > 0);
-      auto& front{ failures_.front() };
-      auto ptr{ std::get_if<Error>(&(front.type_)) };
-      TEST(ptr);
-      TEST(*ptr == error);
-      TEST(!!token);
-      TEST(Path{ token->origin_.filePath_->filePath_ } == Path{ front.fileName_ });
-      TEST(token->origin_.location_.line_ == front.line_);
-      TEST(token->origin_.location_.column_ == front.column_);
-      TEST(!front.isFatal_);
-      TEST(mapping.size() == front.mapping_.size());
-      TEST(mapping == front.mapping_);
-
-      faultTokens_.push_back(token);
-      failures_.pop_front();
-    };
-    output.error_ = [&](Error error, const TokenConstPtr& token, const StringMap& mapping) noexcept(false) {
-      TEST(failures_.size() > 0);
-      auto& front{ failures_.front() };
-      auto ptr{ std::get_if<Error>(&(front.type_)) };
-      TEST(ptr);
-      TEST(*ptr == error);
-      TEST(!!token);
-      TEST(Path{ token->origin_.filePath_->filePath_ } == Path{ front.fileName_ });
-      TEST(token->origin_.location_.line_ == front.line_);
-      TEST(token->origin_.location_.column_ == front.column_);
-      TEST(!front.isFatal_);
-      TEST(mapping.size() == front.mapping_.size());
-      TEST(mapping == front.mapping_);
-
-      faultTokens_.push_back(token);
-      failures_.pop_front();
-    };
-    output.warning_ = [&](Warning warning, const TokenConstPtr& token, const StringMap& mapping) noexcept(false) {
-      TEST(failures_.size() > 0);
-      auto& front{ failures_.front() };
-      auto ptr{ std::get_if<Warning>(&(front.type_)) };
-      TEST(ptr);
-      TEST(*ptr == warning);
-      TEST(!!token);
-      TEST(Path{ token->origin_.filePath_->filePath_ } == Path{ front.fileName_ });
-      TEST(token->origin_.location_.line_ == front.line_);
-      TEST(token->origin_.location_.column_ == front.column_);
-      TEST(!front.isFatal_);
-      TEST(mapping.size() == front.mapping_.size());
-      TEST(mapping == front.mapping_);
-      TEST(token->compileState_->isWarningAnError(warning) == front.forcedError_);
-
-      faultTokens_.push_back(token);
-      failures_.pop_front();
-    };
-    output.info_ = [&](Informational info, const TokenConstPtr& token, const StringMap& mapping) noexcept(false) {
-      TEST(failures_.size() > 0);
-      auto& front{ failures_.front() };
-      auto ptr{ std::get_if<Informational>(&(front.type_)) };
-      TEST(ptr);
-      TEST(*ptr == info);
-      TEST(!!token);
-      TEST(Path{ token->origin_.filePath_->filePath_ } == Path{ front.fileName_ });
-      TEST(token->origin_.location_.line_ == front.line_);
-      TEST(token->origin_.location_.column_ == front.column_);
-      TEST(!front.isFatal_);
-      TEST(mapping.size() == front.mapping_.size());
-      TEST(mapping == front.mapping_);
-
-      faultTokens_.push_back(token);
-      failures_.pop_front();
-    };
-  }
-
-  //-------------------------------------------------------------------------
-  void fatal(Error error, StringView fileName, int line, int column, const StringMap& mapping = {}) noexcept(false)
-  {
-    failures_.emplace_back(true, error, fileName, line, column, mapping);
-  }
-
-  //-------------------------------------------------------------------------
-  void expect(Error error, StringView fileName, int line, int column, const StringMap& mapping = {}) noexcept(false)
-  {
-    failures_.emplace_back(false, error, fileName, line, column, mapping);
-  }
-
-  //-------------------------------------------------------------------------
-  void expect(Warning warning, StringView fileName, int line, int column, const StringMap& mapping = {}) noexcept(false)
-  {
-    failures_.emplace_back(warning, fileName, line, column, mapping);
-  }
-
-  //-------------------------------------------------------------------------
-  void error(Warning warning, StringView fileName, int line, int column, const StringMap& mapping = {}) noexcept(false)
-  {
-    failures_.emplace_back(warning, fileName, line, column, mapping, true);
-  }
-
-  //-------------------------------------------------------------------------
-  void expect(const CompileState& state, const Panic which) noexcept(false)
-  {
-    TEST(state.panics_.at(which).enabled_);
-  }
-
-  //-------------------------------------------------------------------------
-  void disabled(const CompileState& state, const Panic which) noexcept(false)
-  {
-    TEST(!state.panics_.at(which).enabled_);
-  }
-
-  //-------------------------------------------------------------------------
-  void expect(const TokenConstPtr& token, const Panic which) noexcept(false)
-  {
-    TEST(static_cast<bool>(token));
-    TEST(static_cast<bool>(token->compileState_));
-    expect(*(token->compileState_), which);
-  }
-
-  //-------------------------------------------------------------------------
-  void disabled(const TokenConstPtr& token, const Panic which) noexcept(false)
-  {
-    TEST(static_cast<bool>(token));
-    TEST(static_cast<bool>(token->compileState_));
-    disabled(*(token->compileState_), which);
-  }
-
-  //-------------------------------------------------------------------------
-  void expect(size_t index, const Panic which) noexcept(false)
-  {
-    TEST(index < faultTokens_.size());
-    auto iter{ faultTokens_.begin() };
-    std::advance(iter, index);
-    expect(*iter, which);
-  }
-
-  //-------------------------------------------------------------------------
-  void disabled(size_t index, const Panic which) noexcept(false)
-  {
-    TEST(index < faultTokens_.size());
-    auto iter{ faultTokens_.begin() };
-    std::advance(iter, index);
-    disabled(*iter, which);
-  }
-
-  //-------------------------------------------------------------------------
-  TokenConstPtr faultToken(size_t index) noexcept(false)
-  {
-    TEST(index < faultTokens_.size());
-    auto iter{ faultTokens_.begin() };
-    std::advance(iter, index);
-    return *iter;
-  }
-
-  //-------------------------------------------------------------------------
-  CompileStateConstPtr faultTokenState(size_t index) noexcept(false)
-  {
-    auto token{ faultToken(index) };
-    TEST(static_cast<bool>(token));
-    TEST(static_cast<bool>(token->compileState_));
-    return token->compileState_;
-  }
-
-  //-------------------------------------------------------------------------
-  ParserPtr testCommon(
-    const std::string_view filePath,
-    const std::string_view content) noexcept(false)
-  {
-    std::error_code ec;
-    std::filesystem::create_directories(std::filesystem::path{ filePath }.parent_path(), ec);
-
-    TEST(zax::writeBinaryFile(filePath, content));
-
-    Config config;
-    config.inputFilePaths_.emplace_back(filePath);
-    auto parser{ std::make_shared<Parser>(config, callbacks()) };
-
-    parser->parse();
-
-    output(__FILE__ "::" __FUNCTION__);
-    return parser;
-  }
-};
-
-//---------------------------------------------------------------------------
-//---------------------------------------------------------------------------
-//---------------------------------------------------------------------------
-//---------------------------------------------------------------------------
 struct ParserSourceAssetDirectives : public ParserCommon
 {
   //-------------------------------------------------------------------------
@@ -466,7 +225,7 @@ struct ParserSourceAssetDirectives : public ParserCommon
     config.inputFilePaths_.emplace_back(example1);
     auto parser{ std::make_shared<Parser>(config, callbacks()) };
 
-    expect(Error::AssetNotFound, example1, 2, 3, StringMap{ { "$file$", "bogus_asset.txt" } });
+    expect(Error::AssetNotFound, example1, 2, 3, DiagnosticArguments{ { "$file$", "bogus_asset.txt" } });
     expect(Warning::StatementSeparatorOperatorRedundant, example1, 3, 3);
 
     parser->parse();
@@ -571,10 +330,10 @@ struct ParserSourceAssetDirectives : public ParserCommon
     config.inputFilePaths_.emplace_back(example1);
     auto parser{ std::make_shared<Parser>(config, callbacks()) };
 
-    expect(Error::WildCharacterMismatch, example1, 2, 3, StringMap{ { "$wild$", "ignored/output/dbop/many_food.txt" } });
-    expect(Error::WildCharacterMismatch, example1, 2, 3, StringMap{ { "$wild$", "ignored/output/dbop/many_food.txt" } });
-    expect(Error::WildCharacterMismatch, example1, 2, 3, StringMap{ { "$wild$", "ignored/output/dcop/many_food.txt" } });
-    expect(Error::WildCharacterMismatch, example1, 2, 3, StringMap{ { "$wild$", "ignored/output/dcop/many_food.txt" } });
+    expect(Error::WildCharacterMismatch, example1, 2, 3, DiagnosticArguments{ { "$wild$", "ignored/output/dbop/many_food.txt" } });
+    expect(Error::WildCharacterMismatch, example1, 2, 3, DiagnosticArguments{ { "$wild$", "ignored/output/dbop/many_food.txt" } });
+    expect(Error::WildCharacterMismatch, example1, 2, 3, DiagnosticArguments{ { "$wild$", "ignored/output/dcop/many_food.txt" } });
+    expect(Error::WildCharacterMismatch, example1, 2, 3, DiagnosticArguments{ { "$wild$", "ignored/output/dcop/many_food.txt" } });
     expect(Warning::StatementSeparatorOperatorRedundant, example1, 3, 3);
 
     parser->parse();
@@ -589,6 +348,368 @@ struct ParserSourceAssetDirectives : public ParserCommon
     output(__FILE__ "::" __FUNCTION__);
   }
 
+  //-------------------------------------------------------------------------
+  void testDirectiveAssetManifest() noexcept(false)
+  {
+    const std::string_view example1{ "ignored/testing/parser/directive/manifest/a.zax" };
+    const std::string_view example2{ "ignored/testing/parser/directive/manifest/a-asset.txt" };
+    const std::string_view outputPath{ "ignored/testing/parser/directive/manifest/output/" };
+    const std::string_view copied{ "ignored/testing/parser/directive/manifest/output/copied.txt" };
+
+    std::error_code ec;
+    std::filesystem::remove_all(std::filesystem::path{ outputPath }, ec);
+    std::filesystem::create_directories(std::filesystem::path{ example1 }.parent_path(), ec);
+
+    TEST(zax::writeBinaryFile(example1, "[[asset='a-asset.txt', rename='copied.txt']]\n"));
+    TEST(zax::writeBinaryFile(example2, "HELLO"));
+
+    auto build{ [&]() noexcept(false) {
+      Config config;
+      config.inputFilePaths_.emplace_back(example1);
+      config.outputPath_ = outputPath;
+      auto parser{ std::make_shared<Parser>(config, callbacks()) };
+      parser->parse();
+      return parser->assetCopier_.statistics_;
+    } };
+
+    auto contents{ [&]() noexcept(false) {
+      auto [data, length] { zax::readBinaryFile(copied) };
+      TEST(nullptr != data);
+      return String{ reinterpret_cast<const char*>(data.get()), length };
+    } };
+
+    auto first{ build() };
+    TEST(first.copiedFiles_ == 1);
+    TEST(first.copiedBytes_ == 5);
+    TEST(first.skippedFiles_ == 0);
+    TEST(contents() == "HELLO");
+    TEST(std::filesystem::is_regular_file(Path{ outputPath } / zax::AssetCopier::ManifestFileName, ec));
+
+    auto second{ build() };
+    TEST(second.copiedFiles_ == 0);
+    TEST(second.skippedFiles_ == 1);
+    TEST(second.skippedBytes_ == 5);
+
+    TEST(zax::writeBinaryFile(example2, "WORLD!"));
+
+    auto third{ build() };
+    TEST(third.copiedFiles_ == 1);
+    TEST(third.copiedBytes_ == 6);
+    TEST(contents() == "WORLD!");
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testDirectiveAssetStore() noexcept(false)
+  {
+    const std::string_view example1{ "ignored/testing/parser/directive/store/a.zax" };
+    const std::string_view example2{ "ignored/testing/parser/directive/store/font.bin" };
+    const std::string_view example3{ "ignored/testing/parser/directive/store/same-font.bin" };
+    const std::string_view outputPath{ "ignored/testing/parser/directive/store/output/" };
+    const std::string_view copied1{ "ignored/testing/parser/directive/store/output/fonts/one.bin" };
+    const std::string_view copied2{ "ignored/testing/parser/directive/store/output/fonts/two.bin" };
+
+    std::error_code ec;
+    std::filesystem::remove_all(std::filesystem::path{ outputPath }, ec);
+    std::filesystem::create_directories(std::filesystem::path{ example1 }.parent_path(), ec);
+
+    const std::string_view content1{
+      "[[asset='font.bin', rename='fonts/one.bin']]\n"
+      "[[asset='same-font.bin', rename='fonts/two.bin']]\n"
+    };
+
+    TEST(zax::writeBinaryFile(example1, content1));
+    TEST(zax::writeBinaryFile(example2, "GLYPHS"));
+    TEST(zax::writeBinaryFile(example3, "GLYPHS"));
+
+    Config config;
+    config.inputFilePaths_.emplace_back(example1);
+    config.outputPath_ = outputPath;
+    config.assetStore_ = true;
+    config.assetWorkers_ = 1;   // parallel jobs may both publish the shared object
+    auto parser{ std::make_shared<Parser>(config, callbacks()) };
+    parser->parse();
+
+    auto& statistics{ parser->assetCopier_.statistics_ };
+    TEST(statistics.copiedFiles_ == 1);
+    TEST(statistics.linkedFiles_ == 2);
+
+    auto identity1{ zax::fileIdentity(copied1) };
+    auto identity2{ zax::fileIdentity(copied2) };
+    TEST(identity1.has_value());
+    TEST(identity1 == identity2);
+
+    // an object of the right size but the wrong bytes is replaced, not linked
+    std::filesystem::remove_all(std::filesystem::path{ copied1 }.parent_path(), ec);
+    std::filesystem::remove(std::filesystem::path{ outputPath } / zax::AssetCopier::ManifestFileName, ec);
+    size_t objects{};
+    for (auto& entry : std::filesystem::directory_iterator(std::filesystem::path{ outputPath } / zax::AssetCopier::StoreDirectoryName, ec)) {
+      TEST(zax::writeBinaryFile(entry.path().string(), "BROKEN"));
+      ++objects;
+    }
+    TEST(1 == objects);
+
+    auto parser2{ std::make_shared<Parser>(config, callbacks()) };
+    parser2->parse();
+
+    auto& statistics2{ parser2->assetCopier_.statistics_ };
+    TEST(statistics2.copiedFiles_ == 1);
+    TEST(statistics2.linkedFiles_ == 2);
+    for (auto copied : { copied1, copied2 }) {
+      auto [contents, length] { zax::readBinaryFile(copied) };
+      TEST(StringView(reinterpret_cast<const char*>(contents.get()), length) == "GLYPHS");
+    }
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testListing() noexcept(false)
+  {
+    const std::string_view example1{ "ignored/testing/parser/listing/a.zax" };
+    const std::string_view example2{ "ignored/testing/parser/listing/b.zax" };
+    const std::string_view listingPath{ "ignored/testing/parser/listing/output/a.lst" };
+
+    std::error_code ec;
+    std::filesystem::remove_all(std::filesystem::path{ listingPath }.parent_path(), ec);
+    std::filesystem::create_directories(std::filesystem::path{ example1 }.parent_path(), ec);
+
+    const std::string_view content1{
+      "// first\r\n"
+      "[[warning=never,statement-separator-operator-redundant]]\n"
+      "[[source='b.zax']]\n"
+      "[[line=100]]\n"
+      "// last"
+    };
+    const std::string_view content2{
+      "// included\n"
+    };
+
+    TEST(zax::writeBinaryFile(example1, content1));
+    TEST(zax::writeBinaryFile(example2, content2));
+
+    Config config;
+    config.inputFilePaths_.emplace_back(example1);
+    config.listingFilePath_ = listingPath;
+    auto parser{ std::make_shared<Parser>(config, callbacks()) };
+    parser->parse();
+
+    // parsing closes the listing itself
+    TEST(!!parser->listing_);
+    TEST(!parser->listing_->output_.stream_.is_open());
+
+    auto [contents, length] { zax::readBinaryFile(listingPath) };
+    TEST(nullptr != contents);
+    StringView listing{ reinterpret_cast<const char*>(contents.get()), length };
+
+    // each fragment must appear after the one before it
+    const std::vector<String> expected{
+      "; source "s + String{ example1 } + "\n",
+      "      1  // first\n",
+      "      2  [[warning=never,statement-separator-operator-redundant]]\n",
+      "         ; warning never statement-separator-operator-redundant\n",
+      "      3  [[source='b.zax']]\n",
+      "         ; source ",
+      "b.zax\n",
+      "; source ",
+      "      1  // included\n",
+      "; resume "s + String{ example1 } + "\n",
+      "      4  [[line=100]]\n",
+      "         ; line 100\n",
+      "      5  // last\n"
+    };
+    size_t pos{};
+    for (auto& fragment : expected) {
+      auto found{ listing.find(fragment, pos) };
+      TEST(StringView::npos != found);
+      if (StringView::npos == found)
+        break;
+      pos = found + fragment.size();
+    }
+    TEST(listing.size() == pos);
+
+    // sources left unfinished are flushed in the order they were entered
+    {
+      const std::string_view partialPath{ "ignored/testing/parser/listing/output/partial.lst" };
+      TEST(2 == parser->processedSources_.size());
+      auto& includedSource{ *parser->processedSources_.front() };
+      auto& includerSource{ *parser->processedSources_.back() };
+      {
+        zax::ListingWriter partial{ String{ partialPath } };
+        partial.enter(includedSource);
+        partial.enter(includerSource);
+        TEST(partial.close());
+      }
+      auto [partialContents, partialLength] { zax::readBinaryFile(partialPath) };
+      TEST(nullptr != partialContents);
+      StringView partial{ reinterpret_cast<const char*>(partialContents.get()), partialLength };
+      auto included{ partial.find("      1  // included\n") };
+      auto last{ partial.find("      5  // last\n") };
+      TEST(StringView::npos != included);
+      TEST(StringView::npos != last);
+      TEST(included < last);
+    }
+
+    // a listing that cannot be written is reported
+    {
+      Config unwritable;
+      unwritable.inputFilePaths_.emplace_back(example2);
+      unwritable.listingFilePath_ = String{ example1 } + "/a.lst";
+      auto failing{ std::make_shared<Parser>(unwritable, callbacks()) };
+      expect(Error::OutputFailure, "[[internal]]", 0, 0, DiagnosticArguments{ { "$file$", unwritable.listingFilePath_ } });
+      failing->parse();
+    }
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testSourceDependencies() noexcept(false)
+  {
+    const std::string_view example1{ "ignored/testing/parser/dependencies/a.zax" };
+    const std::string_view example2{ "ignored/testing/parser/dependencies/b.zax" };
+    const std::string_view example3{ "ignored/testing/parser/dependencies/c.txt" };
+    const std::string_view outputPath{ "ignored/testing/parser/dependencies/output/" };
+
+    std::error_code ec;
+    std::filesystem::remove_all(std::filesystem::path{ outputPath }, ec);
+    std::filesystem::create_directories(std::filesystem::path{ example1 }.parent_path(), ec);
+
+    TEST(zax::writeBinaryFile(example1, "[[source='b.zax']]\n"));
+    TEST(zax::writeBinaryFile(example2, "[[asset='c.txt']]\n"));
+    TEST(zax::writeBinaryFile(example3, "ASSET"));
+
+    Config config;
+    config.inputFilePaths_.emplace_back(example1);
+    config.outputPath_ = outputPath;
+    auto parser{ std::make_shared<Parser>(config, callbacks()) };
+    parser->parse();
+
+    auto& dependencies{ parser->dependencies_ };
+    auto fullPath{ [&](StringView ending) noexcept -> String {
+      for (auto& [file, requesters] : dependencies.requestedBy_) {
+        if (StringView{ file }.ends_with(ending))
+          return file;
+      }
+      return {};
+    } };
+
+    auto file1{ fullPath("/a.zax") };
+    auto file2{ fullPath("/b.zax") };
+    auto file3{ fullPath("/c.txt") };
+    TEST(!file1.empty());
+    TEST(!file2.empty());
+    TEST(!file3.empty());
+    TEST(3 == dependencies.requestedBy_.size());
+
+    TEST(zax::SourceDependencies::FileSet{ file1 } == dependencies.roots());
+    TEST(dependencies.requestedBy_[file2] == zax::SourceDependencies::FileSet{ file1 });
+    TEST(dependencies.requestedBy_[file3] == zax::SourceDependencies::FileSet{ file2 });
+    TEST(zax::SourceDependencies::FileSet{ file3 } == dependencies.assets_);
+
+    TEST(zax::SourceDependencies::FileSet{ file1 } == dependencies.affected({ file3 }));
+    TEST(zax::SourceDependencies::FileSet{ file1 } == dependencies.affected({ file2 }));
+    TEST(dependencies.affected({ "unrelated.zax" }).empty());
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testParseResultCache() noexcept(false)
+  {
+    const std::string_view example1{ "ignored/testing/parser/parse-cache/a.zax" };
+    const std::string_view example2{ "ignored/testing/parser/parse-cache/b.zax" };
+    const std::string_view example3{ "ignored/testing/parser/parse-cache/c.txt" };
+    const std::string_view cachePath{ "ignored/testing/parser/parse-cache/cache" };
+    const std::string_view outputPath{ "ignored/testing/parser/parse-cache/output/" };
+
+    std::error_code ec;
+    std::filesystem::remove_all(std::filesystem::path{ cachePath }, ec);
+    std::filesystem::remove_all(std::filesystem::path{ outputPath }, ec);
+    std::filesystem::create_directories(std::filesystem::path{ example1 }.parent_path(), ec);
+
+    const std::string_view content1{
+      "\n"
+      "[[\\\n"
+      "source='b.zax']];\n"
+      "[[asset='c.txt']]\n"
+    };
+    const std::string_view content2{
+      "\n"
+      "\\;\n"
+      "[[warning=never,statement-separator-operator-redundant]]\n"
+    };
+
+    TEST(zax::writeBinaryFile(example1, content1));
+    TEST(zax::writeBinaryFile(example2, content2));
+    TEST(zax::writeBinaryFile(example3, "ASSET"));
+
+    auto build{ [&]() noexcept(false) {
+      Config config;
+      config.inputFilePaths_.emplace_back(example1);
+      config.outputPath_ = outputPath;
+      config.parseCachePath_ = cachePath;
+      auto parser{ std::make_shared<Parser>(config, callbacks()) };
+
+      expect(Warning::NewlineAfterContinuation, example2, 2, 2);
+      expect(Warning::StatementSeparatorOperatorRedundant, example2, 2, 2);
+
+      parser->parse();
+      TEST(failures_.empty());
+      TEST(!!parser->parseCache_);
+      TEST(2 == parser->processedSources_.size());
+      return parser;
+    } };
+
+    auto first{ build() };
+    TEST(0 == first->parseCache_->hits_);
+    TEST(2 == first->parseCache_->stored_);
+
+    std::filesystem::remove_all(std::filesystem::path{ outputPath }, ec);
+
+    auto second{ build() };
+    TEST(2 == second->parseCache_->hits_);
+    TEST(0 == second->parseCache_->stored_);
+    TEST(first->dependencies_.requestedBy_ == second->dependencies_.requestedBy_);
+    TEST(std::filesystem::is_regular_file(Path{ outputPath } / "c.txt", ec));
+
+    // the state the included source ended with is replayed as well
+    for (auto& source : second->processedSources_) {
+      auto state{ source->context_->state() };
+      TEST(!!state);
+      bool included{ StringView{ source->realPath_->filePath_ }.ends_with("b.zax") };
+      TEST(included != state->warnings_.at(Warning::StatementSeparatorOperatorRedundant).enabled_);
+    }
+
+    // only the edited source is parsed again; the warning directive replayed
+    // from the included source still silences the includer's trailing ';'
+    TEST(zax::writeBinaryFile(example1, String{ content1 } + "// edited\n"));
+
+    auto third{ build() };
+    TEST(1 == third->parseCache_->hits_);
+    TEST(1 == third->parseCache_->stored_);
+
+    TEST(zax::writeBinaryFile(example2, String{ content2 } + "// edited\n"));
+
+    auto fourth{ build() };
+    TEST(1 == fourth->parseCache_->hits_);
+    TEST(1 == fourth->parseCache_->stored_);
+
+    // a listing needs every line so it never replays
+    Config config;
+    config.inputFilePaths_.emplace_back(example1);
+    config.parseCachePath_ = cachePath;
+    config.listingFilePath_ = "ignored/testing/parser/parse-cache/output/a.lst";
+    auto parser{ std::make_shared<Parser>(config, callbacks()) };
+    expect(Warning::NewlineAfterContinuation, example2, 2, 2);
+    expect(Warning::StatementSeparatorOperatorRedundant, example2, 2, 2);
+    parser->parse();
+    TEST(!parser->parseCache_);
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
   //-------------------------------------------------------------------------
   void testDirectiveAssetIllegalOutName() noexcept(false)
   {
@@ -613,7 +734,7 @@ struct ParserSourceAssetDirectives : public ParserCommon
       config.inputFilePaths_.emplace_back(example1);
       auto parser{ std::make_shared<Parser>(config, callbacks()) };
 
-      expect(Error::OutputFailure, example1, 2, 3, StringMap{ {"$file$", prefix + "ignored/output/" + letter + "-asset.txt" } });
+      expect(Error::OutputFailure, example1, 2, 3, DiagnosticArguments{ {"$file$", prefix + "ignored/output/" + letter + "-asset.txt" } });
       expect(Warning::StatementSeparatorOperatorRedundant, example1, 3, 3);
 
       parser->parse();
@@ -651,7 +772,7 @@ struct ParserSourceAssetDirectives : public ParserCommon
     config.inputFilePaths_.emplace_back(example1);
     auto parser{ std::make_shared<Parser>(config, callbacks()) };
 
-    expect(Error::OutputFailure, example1, 2, 3, StringMap{ {"$file$"s, "ignored/output/n"s + illegalChars + "asset.txt"s} });
+    expect(Error::OutputFailure, example1, 2, 3, DiagnosticArguments{ {"$file$"s, "ignored/output/n"s + illegalChars + "asset.txt"s} });
     expect(Warning::StatementSeparatorOperatorRedundant, example1, 3, 3);
 
     parser->parse();
@@ -709,7 +830,7 @@ struct ParserSourceAssetDirectives : public ParserCommon
   {
     const std::string_view example{ "ignored/testing/parser/directive/source/o4.zax" };
 
-    expect(Error::SourceNotFound, example, 2, 3, StringMap{ { "$file$", "bogus.zax" } });
+    expect(Error::SourceNotFound, example, 2, 3, DiagnosticArguments{ { "$file$", "bogus.zax" } });
     expect(Warning::StatementSeparatorOperatorRedundant, example, 3, 3);
 
     testCommon(example,
@@ -769,6 +890,142 @@ struct ParserSourceAssetDirectives : public ParserCommon
     output(__FILE__ "::" __FUNCTION__);
   }
 
+  //-------------------------------------------------------------------------
+  void testDirectiveIncludeSpelledTwice() noexcept(false)
+  {
+    const std::string_view example1{ "ignored/testing/parser/directive/identity/a.zax" };
+    const std::string_view example2{ "ignored/testing/parser/directive/identity/b.zax" };
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path{ example1 }.parent_path() / "sub", ec);
+
+    const std::string_view content1{
+      "\n"
+      "[[source='b.zax']]\n"
+      "[[source='sub/../b.zax']];\n"
+    };
+
+    const std::string_view content2{
+      "\n"
+      "\\;\n"
+    };
+
+    TEST(zax::writeBinaryFile(example1, content1));
+    TEST(zax::writeBinaryFile(example2, content2));
+
+    Config config;
+    config.inputFilePaths_.emplace_back(example1);
+    auto parser{ std::make_shared<Parser>(config, callbacks()) };
+
+    expect(Warning::NewlineAfterContinuation, example2, 2, 2);
+    expect(Warning::StatementSeparatorOperatorRedundant, example2, 2, 2);
+    expect(Warning::StatementSeparatorOperatorRedundant, example1, 3, 33 - 8 + 1);
+
+    parser->parse();
+
+    TEST(parser->avoidedSourceLoads_ == 1);
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testDirectiveIncludeCopied() noexcept(false)
+  {
+    const std::string_view example1{ "ignored/testing/parser/directive/identity/c.zax" };
+    const std::string_view example2{ "ignored/testing/parser/directive/identity/d.zax" };
+    const std::string_view example3{ "ignored/testing/parser/directive/identity/e.zax" };
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path{ example1 }.parent_path(), ec);
+
+    const std::string_view content1{
+      "\n"
+      "[[source='d.zax']]\n"
+      "[[source='e.zax']];\n"
+    };
+
+    const std::string_view content2{
+      "\n"
+      "\\;\n"
+    };
+
+    TEST(zax::writeBinaryFile(example1, content1));
+    TEST(zax::writeBinaryFile(example2, content2));
+    TEST(zax::writeBinaryFile(example3, content2));
+
+    Config config;
+    config.deduplicateSourcesByContent_ = true;
+    config.inputFilePaths_.emplace_back(example1);
+    auto parser{ std::make_shared<Parser>(config, callbacks()) };
+
+    expect(Warning::NewlineAfterContinuation, example2, 2, 2);
+    expect(Warning::StatementSeparatorOperatorRedundant, example2, 2, 2);
+    expect(Warning::StatementSeparatorOperatorRedundant, example1, 3, 26 - 8 + 1);
+
+    parser->parse();
+
+    TEST(parser->avoidedSourceLoads_ == 0);
+    TEST(parser->duplicateSources_ == 1);
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testDirectiveIncludeParallel(int workers) noexcept(false)
+  {
+    const std::string_view example1{ "ignored/testing/parser/directive/parallel/a.zax" };
+    const std::string_view example2{ "ignored/testing/parser/directive/parallel/b.zax" };
+    const std::string_view example3{ "ignored/testing/parser/directive/parallel/c.zax" };
+    const std::string_view example4{ "ignored/testing/parser/directive/parallel/shared.zax" };
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path{ example1 }.parent_path(), ec);
+
+    const std::string_view content1{
+      "\n"
+      "[[source='shared.zax']];\n"
+    };
+
+    const std::string_view content2{
+      "\n"
+      "[[source='shared.zax']];\n"
+      "\\;\n"
+    };
+
+    const std::string_view content3{
+      "\n"
+      "\\;\n"
+    };
+
+    TEST(zax::writeBinaryFile(example1, content1));
+    TEST(zax::writeBinaryFile(example2, content2));
+    TEST(zax::writeBinaryFile(example3, content3));
+    TEST(zax::writeBinaryFile(example4, content3));
+
+    Config config;
+    config.sourceWorkers_ = workers;
+    config.inputFilePaths_.emplace_back(example1);
+    config.inputFilePaths_.emplace_back(example2);
+    config.inputFilePaths_.emplace_back(example3);
+    config.inputFilePaths_.emplace_back(example1);
+    auto parser{ std::make_shared<Parser>(config, callbacks()) };
+
+    expect(Warning::NewlineAfterContinuation, example4, 2, 2);
+    expect(Warning::StatementSeparatorOperatorRedundant, example4, 2, 2);
+    expect(Warning::StatementSeparatorOperatorRedundant, example1, 2, 31 - 8 + 1);
+    expect(Warning::StatementSeparatorOperatorRedundant, example2, 2, 31 - 8 + 1);
+    expect(Warning::NewlineAfterContinuation, example2, 3, 2);
+    expect(Warning::StatementSeparatorOperatorRedundant, example2, 3, 2);
+    expect(Warning::NewlineAfterContinuation, example3, 2, 2);
+    expect(Warning::StatementSeparatorOperatorRedundant, example3, 2, 2);
+
+    parser->parse();
+
+    TEST(parser->processedSources_.size() == 4);
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
   //-------------------------------------------------------------------------
   void testDirectiveSourceNotUnderstood() noexcept(false)
   {
@@ -978,6 +1235,11 @@ struct ParserSourceAssetDirectives : public ParserCommon
     runner([&]() { testDirectiveAssetNotFound(); });
     runner([&]() { testDirectiveAssetPattern(); });
     runner([&]() { testDirectiveAssetPattern2(); });
+    runner([&]() { testDirectiveAssetManifest(); });
+    runner([&]() { testDirectiveAssetStore(); });
+    runner([&]() { testListing(); });
+    runner([&]() { testSourceDependencies(); });
+    runner([&]() { testParseResultCache(); });
     runner([&]() { testDirectiveAssetIllegalOutName(); });
     runner([&]() { testDirectiveAssetIllegalOutName2(); });
     runner([&]() { testDirectiveAssetIllegalQuote(); });
@@ -986,6 +1248,10 @@ struct ParserSourceAssetDirectives : public ParserCommon
     runner([&]() { testDirectiveSourceMissingError(); });
     runner([&]() { testDirectiveSourceMissingIgnored(); });
     runner([&]() { testDirectiveIncludeTwice(); });
+    runner([&]() { testDirectiveIncludeSpelledTwice(); });
+    runner([&]() { testDirectiveIncludeCopied(); });
+    runner([&]() { testDirectiveIncludeParallel(1); });
+    runner([&]() { testDirectiveIncludeParallel(3); });
     runner([&]() { testDirectiveSourceNotUnderstood(); });
     runner([&]() { testDirectiveSourceNotUnderstood2(); });
     runner([&]() { testDirectiveSourceNotUnderstood3(); });
@@ -1538,7 +1804,7 @@ struct ParserErrorDirective : public ParserCommon
   {
     const std::string_view example{ "ignored/testing/parser/directive/error/2.zax" };
 
-    expect(Error::ErrorDirective, example, 2, 3, StringMap{ {"$message$", "hello"} });
+    expect(Error::ErrorDirective, example, 2, 3, DiagnosticArguments{ {"$message$", "hello"} });
     expect(Warning::StatementSeparatorOperatorRedundant, example, 3, 9);
 
     testCommon(example,
@@ -1552,7 +1818,7 @@ struct ParserErrorDirective : public ParserCommon
   {
     const std::string_view example{ "ignored/testing/parser/directive/error/3.zax" };
 
-    expect(Error::ErrorDirective, example, 2, 3, StringMap{ {"$message$", "x-unknown"} });
+    expect(Error::ErrorDirective, example, 2, 3, DiagnosticArguments{ {"$message$", "x-unknown"} });
     expect(Warning::StatementSeparatorOperatorRedundant, example, 3, 9);
 
     testCommon(example,
@@ -1582,7 +1848,7 @@ struct ParserErrorDirective : public ParserCommon
   {
     const std::string_view example{ "ignored/testing/parser/directive/error/5.zax" };
 
-    expect(Error::Syntax, example, 2, 3, StringMap{ {"$message$", "hello"} });
+    expect(Error::Syntax, example, 2, 3, DiagnosticArguments{ {"$message$", "hello"} });
     expect(Warning::StatementSeparatorOperatorRedundant, example, 3, 9);
 
     testCommon(example,
@@ -1709,7 +1975,7 @@ struct ParserWarningDirective : public ParserCommon
   {
     const std::string_view example{ "ignored/testing/parser/directive/warning/2.zax" };
 
-    expect(Warning::WarningDirective, example, 2, 3, StringMap{ {"$message$", "hello"} });
+    expect(Warning::WarningDirective, example, 2, 3, DiagnosticArguments{ {"$message$", "hello"} });
     expect(Warning::StatementSeparatorOperatorRedundant, example, 3, 9);
 
     testCommon(example,
@@ -1723,7 +1989,7 @@ struct ParserWarningDirective : public ParserCommon
   {
     const std::string_view example{ "ignored/testing/parser/directive/warning/3.zax" };
 
-    expect(Warning::WarningDirective, example, 2, 3, StringMap{ {"$message$", "x-unknown"} });
+    expect(Warning::WarningDirective, example, 2, 3, DiagnosticArguments{ {"$message$", "x-unknown"} });
     expect(Warning::StatementSeparatorOperatorRedundant, example, 3, 9);
 
     testCommon(example,
@@ -1753,7 +2019,7 @@ struct ParserWarningDirective : public ParserCommon
   {
     const std::string_view example{ "ignored/testing/parser/directive/warning/5.zax" };
 
-    expect(Warning::Forever, example, 2, 3, StringMap{ {"$message$", "hello"} });
+    expect(Warning::Forever, example, 2, 3, DiagnosticArguments{ {"$message$", "hello"} });
     expect(Warning::StatementSeparatorOperatorRedundant, example, 3, 9);
 
     testCommon(example,
@@ -2292,7 +2558,7 @@ struct ParserWarningDirective : public ParserCommon
   {
     const std::string_view example{ "ignored/testing/parser/directive/warning/27.zax" };
 
-    expect(Warning::AssetNotFound, example, 2, 3, StringMap{ {"$file$", "foo"}, {"$message$","hello"} });
+    expect(Warning::AssetNotFound, example, 2, 3, DiagnosticArguments{ {"$file$", "foo"}, {"$message$","hello"} });
     expect(Warning::StatementSeparatorOperatorRedundant, example, 3, 9);
 
     testCommon(example,
@@ -1277,10 +1277,10 @@ struct TokenizerInstance
     memcpy(content.first.get(), value.data(), sizeof(char) * value.size());
     tokenizer_.emplace(filePath_, std::move(content), operatorLut_, [state=compileState_]() -> auto { return state; });
 
-    tokenizer_->errorCallback_ = [&](zax::ErrorTypes::Error error, const zax::TokenConstPtr token, const zax::StringMap&) noexcept(false) {
+    tokenizer_->errorCallback_ = [&](zax::ErrorTypes::Error error, const zax::TokenConstPtr token, const zax::DiagnosticArguments&) noexcept(false) {
       handleException(error, token);
     };
-    tokenizer_->warningCallback_ = [&](zax::WarningTypes::Warning warning, const zax::TokenConstPtr token, const zax::StringMap&) noexcept(false) {
+    tokenizer_->warningCallback_ = [&](zax::WarningTypes::Warning warning, const zax::TokenConstPtr token, const zax::DiagnosticArguments&) noexcept(false) {
       handleException(warning, token);
     };
   }
@@ -100,6 +100,10 @@ int runAllTests() noexcept
     testTokenizer();
     testParserLineDirectives();
     testParserAlias();
+    testCancellation();
+    testBuildStamp();
+    testModuleInterface();
+    testMetadataWriter();
   }
   catch (...) {
     std::cout << "ERROR: uncaught exception thrown!\n";
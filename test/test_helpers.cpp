@@ -6,6 +6,16 @@
 #include "common.h"
 
 #include "../src/helpers.h"
+#include "../src/FilePrefetcher.h"
+#include "../src/FileSystemCache.h"
+#include "../src/DiagnosticSink.h"
+#include "../src/CompilerException.h"
+#include "../src/DiagnosticWriter.h"
+#include "../src/CompileServer.h"
+#include "../src/SourceCache.h"
+#include "../src/SourceDependencies.h"
+#include "../src/FileWatcher.h"
+#include "../src/Sha256.h"
 
 using StringView = zax::StringView;
 using StringList = zax::StringList;
@@ -175,6 +185,555 @@ struct HelperBasics
     output(__FILE__ "::" __FUNCTION__);
   }
 
+  //-------------------------------------------------------------------------
+  void testGlobPattern() noexcept(false)
+  {
+    auto captures{ [](StringView pattern, StringView value) noexcept -> std::optional<StringList> {
+      StringList result;
+      if (!zax::GlobPattern{ pattern }.match(value, &result))
+        return {};
+      return result;
+    } };
+
+    TEST(captures("hello.txt", "hello.txt") == StringList{});
+    TEST(!captures("hello.txt", "hello.txT"));
+    TEST(captures("*", "") == StringList{ "" });
+    TEST(captures("?", "a") == StringList{ "a" });
+    TEST(!captures("?", ""));
+    TEST(captures("*_?ruit", "apple_fruit") == (StringList{ "apple", "f" }));
+    TEST(captures("a*b*c", "aXbYbZc") == (StringList{ "X", "YbZ" }));
+    TEST(captures("**", "abc") == (StringList{ "", "abc" }));
+    TEST(captures("*?", "abc") == (StringList{ "ab", "c" }));
+    TEST(!captures("a*a*a*a*a*a*b", std::string(4096, 'a')));
+    TEST(captures("a*a*a*a*a*a*b", std::string(4096, 'a') + "b") == (StringList{ "", "", "", "", "", std::string(4090, 'a') }));
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testWildCardStress() noexcept(false)
+  {
+    // a deep tree of long, nearly matching names is the worst case for a
+    // backtracking matcher
+    constexpr int depth{ 4 };
+    constexpr int width{ 6 };
+    const std::string root{ "ignored/testing/helpers/stress" };
+    const std::string stem(60, 'a');
+
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+
+    std::function<void(const std::string&, int)> build{ [&](const std::string& path, int level) noexcept(false) {
+      if (level == depth) {
+        TEST(zax::writeBinaryFile(path + "/" + stem + "b.txt", "found"));
+        TEST(zax::writeBinaryFile(path + "/" + stem + ".txt", "missed"));
+        return;
+      }
+      for (int index{}; index < width; ++index) {
+        auto child{ path + "/" + stem + std::to_string(index) };
+        std::filesystem::create_directories(child, ec);
+        build(child, level + 1);
+      }
+    } };
+    build(root, 0);
+
+    std::list<zax::LocateWildCardFilesResult> found;
+    zax::locateWildCardFiles(found, root + "/test.txt", "a*a*a*a*a*?/a*a*a*a*a*?/a*a*a*a*a*?/a*a*a*a*a*?/a*a*a*a*a*b.txt");
+
+    TEST(found.size() == width * width * width * width);
+    for (auto& entry : found) {
+      TEST(entry.foundMatches_.size() == depth * 6 + 5);
+      TEST(entry.foundMatches_.back() == stem.substr(5));
+    }
+
+    std::filesystem::remove_all(root, ec);
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testSha256() noexcept(false)
+  {
+    using Sha256 = zax::Sha256;
+
+    TEST(Sha256::toHex(Sha256::hash(""sv)) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    TEST(Sha256::toHex(Sha256::hash("abc"sv)) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    TEST(Sha256::toHex(Sha256::hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"sv)) == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    // fed in uneven pieces across block boundaries
+    const std::string million(1000000, 'a');
+    Sha256 sha;
+    for (size_t offset{}, step{ 1 }; offset < million.size(); offset += step, step = (step * 7) % 131 + 1)
+      sha.update(StringView{ million }.substr(offset, step));
+    TEST(Sha256::toHex(sha.finish()) == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+
+    auto digest{ Sha256::hash("abc"sv) };
+    TEST(Sha256::fromHex(Sha256::toHex(digest)) == digest);
+    TEST(!Sha256::fromHex("abc"));
+    TEST(!Sha256::fromHex(std::string(64, 'g')));
+
+    const std::string_view example{ "ignored/testing/helpers/sha256/file.bin" };
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path{ example }.parent_path(), ec);
+    TEST(zax::writeBinaryFile(example, million));
+    TEST(Sha256::hashFile(std::filesystem::path{ example }) == Sha256::hash(million));
+    TEST(!Sha256::hashFile(std::filesystem::path{ "ignored/testing/helpers/sha256/missing.bin" }));
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testCache() noexcept(false)
+  {
+    const std::string_view example{ "ignored/testing/helpers/cache/a/b/example.txt" };
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path{ example }.parent_path(), ec);
+    std::filesystem::remove("ignored/testing/helpers/cache/a/1.txt", ec);
+
+    zax::FileSystemCache cache;
+
+    std::string fullPath1;
+    auto filePath1{ zax::makeIncludeFile(example, "../1.txt", fullPath1, &cache) };
+    std::string uncachedFullPath1;
+    TEST(filePath1 == zax::makeIncludeFile(example, "../1.txt", uncachedFullPath1));
+    TEST(fullPath1 == uncachedFullPath1);
+
+    std::string fullLocated1;
+    TEST(zax::locateFile(example, "1.txt", fullLocated1, false, &cache).empty());
+
+    TEST(zax::writeBinaryFile(filePath1, "hello1"));
+
+    // the cache still remembers the file as missing until told otherwise
+    TEST(zax::locateFile(example, "1.txt", fullLocated1, false, &cache).empty());
+
+    cache.invalidate(std::filesystem::path{ filePath1 });
+    auto located1{ zax::locateFile(example, "1.txt", fullLocated1, false, &cache) };
+    TEST(!located1.empty());
+    TEST(fullPath1 == fullLocated1);
+
+    std::list<zax::LocateWildCardFilesResult> found;
+    zax::locateWildCardFiles(found, example, "../?.txt", false, &cache);
+    TEST(found.size() == 1);
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testDiagnosticSink() noexcept(false)
+  {
+    constexpr int threads{ 4 };
+    constexpr int messages{ 1000 };
+
+    std::stringstream stream;
+    {
+      zax::DiagnosticSink sink{ stream };
+
+      std::vector<std::thread> producers;
+      for (int thread{}; thread < threads; ++thread) {
+        producers.emplace_back([&, thread]() noexcept {
+          for (int message{}; message < messages; ++message)
+            sink.write(std::to_string(thread) + " " + std::to_string(message) + "\n");
+        });
+      }
+      for (auto& producer : producers)
+        producer.join();
+
+      sink.flush();
+      TEST(sink.written_ == threads * messages);
+    }
+
+    // every message arrives whole and each thread's messages stay in order
+    std::vector<int> next(threads);
+    int total{};
+    for (std::string line; std::getline(stream, line); ++total) {
+      auto space{ line.find(' ') };
+      TEST(std::string::npos != space);
+      auto thread{ std::stoi(line.substr(0, space)) };
+      auto message{ std::stoi(line.substr(space + 1)) };
+      TEST(next[thread] == message);
+      next[thread] = message + 1;
+    }
+    TEST(total == threads * messages);
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testFileContentKey() noexcept(false)
+  {
+    auto bytes{ [](std::string_view text) noexcept {
+      auto result{ std::make_shared<std::byte[]>(text.size()) };
+      std::memcpy(result.get(), text.data(), text.size());
+      return std::shared_ptr<const std::byte[]>{ result };
+    } };
+
+    auto first{ zax::fileContentKey(bytes("same bytes"), 10) };
+    auto copy{ zax::fileContentKey(bytes("same bytes"), 10) };
+    TEST(first == copy);
+    TEST(zax::FileContentKey::Hash{}(first) == zax::FileContentKey::Hash{}(copy));
+
+    // a colliding hash alone never makes two sources the same
+    zax::FileContentKey collision{ first.hash_, first.size_, bytes("other byte") };
+    TEST(!(first == collision));
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testFilePrefetcher() noexcept(false)
+  {
+    const std::string_view directory{ "ignored/testing/helpers/prefetch/" };
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path{ directory }, ec);
+
+    std::vector<std::string> names;
+    std::vector<zax::PrefetchedFilePtr> files;
+    {
+      zax::FilePrefetcher prefetcher;
+      for (int loop{}; loop < 16; ++loop) {
+        names.push_back(std::string{ directory } + std::to_string(loop) + ".zax");
+        TEST(zax::writeBinaryFile(names.back(), "file " + std::to_string(loop)));
+        files.push_back(prefetcher.prefetch(names.back(), 1 == (loop % 2)));
+      }
+      auto missing{ prefetcher.prefetch(std::string{ directory } + "missing.zax", true) };
+
+      // whoever takes first receives the bytes whether or not a reader got there
+      for (size_t loop{}; loop < files.size(); ++loop) {
+        auto [contents, length] { files[loop]->take() };
+        TEST(nullptr != contents);
+        const StringView text{ reinterpret_cast<const char*>(contents.get()), length };
+        TEST(text == "file " + std::to_string(loop));
+        TEST(files[loop]->stamped_.has_value() == (1 == (loop % 2)));
+      }
+      TEST(!missing->take().first);
+      TEST(!missing->stamped_);
+
+      // every byte read ahead was handed over
+      std::scoped_lock lock{ prefetcher.mutex_ };
+      TEST(0 == prefetcher.bytesInFlight_);
+      TEST(prefetcher.threads_.size() <= zax::FilePrefetcher::MaxThreads);
+    }
+
+    // a reader never picks up more while the bytes not yet taken are over the bound
+    {
+      zax::FilePrefetcher prefetcher;
+      prefetcher.reserve(zax::FilePrefetcher::MaxBytesInFlight);
+      auto held{ prefetcher.prefetch(names.front(), false) };
+      std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+      TEST(held->claim());
+      held->read();
+      TEST(!!held->take().first);
+      prefetcher.release(zax::FilePrefetcher::MaxBytesInFlight);
+    }
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testSourceCache() noexcept(false)
+  {
+    const std::string_view example{ "ignored/testing/helpers/cache/prelude.zax" };
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path{ example }.parent_path(), ec);
+    TEST(zax::writeBinaryFile(example, "shared prelude"));
+
+    zax::SourceCache cache;
+    TEST(!cache.find(zax::String{ example }).first);
+
+    auto stamp{ zax::fileStamp(example) };
+    TEST(stamp.has_value());
+    zax::SourceCache::Contents contents{ zax::readBinaryFile(example) };
+    TEST(nullptr != contents.first);
+    cache.store(zax::String{ example }, *stamp, contents);
+
+    // the cached bytes are shared rather than copied
+    auto found{ cache.find(zax::String{ example }) };
+    TEST(contents.first == found.first);
+    const StringView text{ reinterpret_cast<const char*>(found.first.get()), found.second };
+    TEST(text == "shared prelude");
+    TEST(1 == cache.hits_);
+
+    // a changed file is read again rather than served stale
+    TEST(zax::writeBinaryFile(example, "changed prelude!"));
+    TEST(!cache.find(zax::String{ example }).first);
+    TEST(cache.entries_.empty());
+
+    // bytes read after the stamp went stale are never stored
+    auto staleStamp{ zax::fileStamp(example) };
+    TEST(zax::writeBinaryFile(example, "edited during the read"));
+    cache.store(zax::String{ example }, *staleStamp, zax::readBinaryFile(example));
+    TEST(!cache.find(zax::String{ example }).first);
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testCompileServer() noexcept(false)
+  {
+#ifndef _WIN32
+    const std::string_view socketPath{ "ignored/testing/helpers/server/zax.sock" };
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path{ socketPath }.parent_path(), ec);
+
+    // only a stale socket is ever replaced
+    const std::string_view keepPath{ "ignored/testing/helpers/server/keep.txt" };
+    TEST(zax::writeBinaryFile(keepPath, "KEEP"));
+    {
+      zax::CompileServer keep{ keepPath };
+      TEST(std::filesystem::path{ keep.socketPath_ }.is_absolute());
+      TEST(!keep.listen());
+    }
+    auto kept{ std::filesystem::is_regular_file(std::filesystem::path{ keepPath }, ec) };
+    TEST(kept);
+
+    auto server{ std::make_unique<zax::CompileServer>(socketPath) };
+    TEST(server->listen());
+
+    std::thread thread{ [&]() noexcept {
+      server->serve([](const StringList& arguments) noexcept -> int {
+        for (auto& argument : arguments)
+          std::cout << argument << "\n" << std::flush;
+        return static_cast<int>(arguments.size()) - 5;
+      });
+    } };
+
+    std::stringstream first;
+    auto result{ zax::CompileServer::forward(socketPath, StringList{ "--in", "a.zax" }, first) };
+    TEST(result.has_value());
+    TEST(-3 == *result);
+    TEST("--in\na.zax\n" == first.str());
+
+    std::stringstream second;
+    result = zax::CompileServer::forward(socketPath, StringList{}, second);
+    TEST(result.has_value());
+    TEST(-5 == *result);
+    TEST(second.str().empty());
+
+    server->stop();
+    thread.join();
+    TEST(2 == server->served_);
+
+    // the socket goes away with the server
+    server.reset();
+    auto removed{ !std::filesystem::exists(std::filesystem::path{ socketPath }, ec) };
+    TEST(removed);
+
+    std::stringstream unreachable;
+    TEST(!zax::CompileServer::forward("ignored/testing/helpers/server/missing.sock", StringList{}, unreachable).has_value());
+#endif //_WIN32
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testSourceDependencies() noexcept(false)
+  {
+    using FileSet = zax::SourceDependencies::FileSet;
+
+    zax::SourceDependencies dependencies;
+    dependencies.add("a", "");
+    dependencies.add("b", "");
+    dependencies.add("shared", "a");
+    dependencies.add("shared", "b");
+    dependencies.add("only-a", "a");
+    dependencies.add("deep", "only-a");
+    dependencies.add("image", "deep", true);
+
+    TEST(FileSet({ "a", "b" }) == dependencies.roots());
+    TEST(FileSet({ "a", "b", "deep", "image", "only-a", "shared" }) == dependencies.files());
+    TEST(FileSet({ "a", "b" }) == dependencies.affected({ "shared" }));
+    TEST(FileSet({ "a" }) == dependencies.affected({ "image" }));
+    TEST(FileSet({ "b" }) == dependencies.affected({ "b" }));
+    TEST(dependencies.affected({ "missing" }).empty());
+
+    // "a" no longer pulls in "only-a" and its children but now wants "new"
+    zax::SourceDependencies fresh;
+    fresh.add("a", "");
+    fresh.add("shared", "a");
+    fresh.add("new", "a");
+    dependencies.replace(fresh, { "a" });
+
+    TEST(FileSet({ "a", "b" }) == dependencies.roots());
+    TEST(FileSet({ "a", "b", "new", "shared" }) == dependencies.files());
+    TEST(FileSet({ "a", "b" }) == dependencies.requestedBy_["shared"]);
+    TEST(dependencies.assets_.empty());
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testFileWatcher() noexcept(false)
+  {
+#ifndef _WIN32
+    using namespace std::chrono_literals;
+    using FileSet = zax::FileWatcher::FileSet;
+
+    const std::string_view example1{ "ignored/testing/helpers/watch/a.zax" };
+    const std::string_view example2{ "ignored/testing/helpers/watch/b.zax" };
+    const std::string_view example3{ "ignored/testing/helpers/watch/unwatched.zax" };
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path{ example1 }.parent_path(), ec);
+    TEST(zax::writeBinaryFile(example1, "a"));
+    TEST(zax::writeBinaryFile(example2, "b"));
+
+    zax::FileWatcher watcher{ 50ms };
+    TEST(watcher.available());
+    TEST(watcher.watch(FileSet{ zax::String{ example1 }, zax::String{ example2 } }));
+    TEST(watcher.wait(50ms).empty());
+
+    TEST(zax::writeBinaryFile(example3, "ignored"));
+    TEST(watcher.wait(50ms).empty());
+
+    // a burst of saves is reported once
+    TEST(zax::writeBinaryFile(example1, "a1"));
+    TEST(zax::writeBinaryFile(example1, "a2"));
+    TEST(zax::writeBinaryFile(example2, "b1"));
+    TEST(FileSet({ zax::String{ example1 }, zax::String{ example2 } }) == watcher.wait(5s));
+    TEST(watcher.wait(50ms).empty());
+
+    // saving by renaming over the original is still seen
+    TEST(zax::writeBinaryFile(example3, "replacement"));
+    std::filesystem::rename(example3, example2, ec);
+    TEST(!ec);
+    TEST(FileSet({ zax::String{ example2 } }) == watcher.wait(5s));
+
+    TEST(watcher.watch(FileSet{ zax::String{ example1 } }));
+    TEST(zax::writeBinaryFile(example2, "b2"));
+    TEST(watcher.wait(50ms).empty());
+#endif //_WIN32
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testMessageTemplate() noexcept(false)
+  {
+    constexpr zax::MessageTemplate message{ "a file ($file$) was copied to $file$ by $who$" };
+    static_assert(6 == message.total_);
+    static_assert(message.segments_[1].placeholder_);
+    static_assert("$file$"sv == message.segments_[1].text_);
+    static_assert(" by "sv == message.segments_[4].text_);
+
+    TEST(message.render(zax::DiagnosticArguments{ { "$file$", "a.txt" } }) == "a file (a.txt) was copied to a.txt by $who$");
+    TEST(zax::MessageTemplate{ "no placeholders" }.render({}) == "no placeholders");
+    TEST(zax::MessageTemplate{ "$message$" }.render(zax::DiagnosticArguments{ { "$message$", "$file$" }, { "$file$", "x" } }) == "$file$");
+
+    using ErrorTypes = zax::ErrorTypes;
+    zax::DiagnosticArguments arguments{ { "$file$", "bogus.txt" } };
+    zax::Diagnostic diagnostic{
+      zax::CompilerException::ErrorType::Error,
+      "a.zax",
+      2,
+      3,
+      ErrorTypes::ErrorTraits::toString(ErrorTypes::Error::AssetNotFound),
+      &zax::messageTemplate<ErrorTypes::Error, ErrorTypes::ErrorHumanReadableTraits>(ErrorTypes::Error::AssetNotFound),
+      &arguments
+    };
+    zax::CompilerException exception{
+      zax::CompilerException::ErrorType::Error,
+      "a.zax",
+      2,
+      3,
+      zax::String{ ErrorTypes::ErrorTraits::toString(ErrorTypes::Error::AssetNotFound) },
+      zax::stringReplace(ErrorTypes::ErrorHumanReadableTraits::toString(ErrorTypes::Error::AssetNotFound), zax::StringMap{ { "$file$", "bogus.txt" } })
+    };
+    TEST(diagnostic.render() == exception.what());
+
+    // arguments stay inline until a directive names more than fit
+    zax::DiagnosticArguments many{ { "$a$", "1" }, { "$b$", "2" } };
+    TEST(many.spilled_.empty());
+    many["$c$"] = "3";
+    many["$a$"] = "one";
+    TEST(3 == many.size());
+    TEST(!many.spilled_.empty());
+    TEST((zax::DiagnosticArguments{ { "$c$", "3" }, { "$b$", "2" }, { "$a$", "one" } } == many));
+    TEST(!(zax::DiagnosticArguments{ { "$a$", "one" }, { "$b$", "2" } } == many));
+    TEST(zax::MessageTemplate{ "$a$-$b$-$c$" }.render(many) == "one-2-3");
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
+  //-------------------------------------------------------------------------
+  void testDiagnosticWriter() noexcept(false)
+  {
+    using ErrorTypes = zax::ErrorTypes;
+    using Format = zax::Config::DiagnosticsFormat;
+
+    zax::DiagnosticArguments arguments{ { "$file$", "say \"hi\".txt" } };
+    zax::Diagnostic diagnostic{
+      zax::CompilerException::ErrorType::Error,
+      "a.zax",
+      2,
+      3,
+      ErrorTypes::ErrorTraits::toString(ErrorTypes::Error::AssetNotFound),
+      &zax::messageTemplate<ErrorTypes::Error, ErrorTypes::ErrorHumanReadableTraits>(ErrorTypes::Error::AssetNotFound),
+      &arguments,
+      true,
+      "b.zax",
+      5,
+      7
+    };
+    zax::Diagnostic continuation{ .type_ = zax::CompilerException::ErrorType::Informational, .continuation_ = true };
+
+    auto stream{ [&](Format format) noexcept {
+      zax::DiagnosticWriter writer{ format };
+      std::string result{ writer.header() };
+      auto append{ [&](std::string&& text) noexcept { result += text; } };
+      writer.write(diagnostic, append);
+      writer.write(continuation, append);
+      writer.write(diagnostic, append);
+      result += writer.footer();
+      return result;
+    } };
+
+    {
+      std::stringstream lines{ stream(Format::JsonLines) };
+      int total{};
+      for (std::string line; std::getline(lines, line); ++total) {
+        auto record = nlohmann::json::parse(line);
+        TEST(record["severity"] == "error");
+        TEST(record["code"] == std::string{ ErrorTypes::ErrorTraits::toString(ErrorTypes::Error::AssetNotFound) });
+        TEST(record["origin"]["file"] == "a.zax");
+        TEST(record["origin"]["line"] == 2);
+        TEST(record["actualOrigin"]["file"] == "b.zax");
+        TEST(record["actualOrigin"]["column"] == 7);
+        TEST(record["parameters"]["file"] == "say \"hi\".txt");
+        TEST(record["message"].get<std::string>().find("say \"hi\".txt") != std::string::npos);
+      }
+      TEST(2 == total);
+    }
+
+    {
+      auto document = nlohmann::json::parse(stream(Format::Sarif));
+      TEST(document["version"] == "2.1.0");
+      auto& results{ document["runs"][0]["results"] };
+      TEST(2 == results.size());
+      TEST(results[0]["level"] == "error");
+      TEST(results[0]["locations"][0]["physicalLocation"]["region"]["startColumn"] == 3);
+      TEST(results[1]["relatedLocations"][0]["physicalLocation"]["artifactLocation"]["uri"] == "b.zax");
+    }
+
+    {
+      // literal text is never read as a template
+      const std::string literal{ "costs $5 at $file$ " + std::string(4096, 'x') };
+      zax::Diagnostic plain{ .type_ = zax::CompilerException::ErrorType::Error, .text_ = literal };
+      zax::DiagnosticWriter writer{ Format::Sarif };
+      auto document = nlohmann::json::parse(writer.header() + writer.record(plain) + writer.footer());
+      auto& result{ document["runs"][0]["results"][0] };
+      TEST(result["message"]["text"] == literal);
+      TEST(!result.contains("locations"));
+      TEST(!result.contains("ruleId"));
+      TEST(plain.render().ends_with(literal));
+    }
+
+    output(__FILE__ "::" __FUNCTION__);
+  }
+
   //-------------------------------------------------------------------------
   void runAll() noexcept(false)
   {
@@ -182,6 +741,19 @@ struct HelperBasics
 
     runner([&]() { test(); });
     runner([&]() { testWildCard(); });
+    runner([&]() { testGlobPattern(); });
+    runner([&]() { testWildCardStress(); });
+    runner([&]() { testSha256(); });
+    runner([&]() { testCache(); });
+    runner([&]() { testDiagnosticSink(); });
+    runner([&]() { testMessageTemplate(); });
+    runner([&]() { testDiagnosticWriter(); });
+    runner([&]() { testFilePrefetcher(); });
+    runner([&]() { testFileContentKey(); });
+    runner([&]() { testSourceCache(); });
+    runner([&]() { testCompileServer(); });
+    runner([&]() { testSourceDependencies(); });
+    runner([&]() { testFileWatcher(); });
 
     reset();
   }